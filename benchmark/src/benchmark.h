@@ -0,0 +1,58 @@
+#pragma once
+#include <Enik.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace Enik::Benchmark {
+
+using Function = void(*)();
+
+struct Entry {
+	const char* Name;
+	Function Run;
+};
+
+inline std::vector<Entry>& GetEntries() {
+	static std::vector<Entry> entries;
+	return entries;
+}
+
+struct Registrar {
+	Registrar(const char* name, Function function) { GetEntries().push_back({ name, function }); }
+};
+
+// median of the runs in milliseconds, less noisy than the mean
+template <typename F>
+float MeasureMs(uint32_t runs, F&& function) {
+	using Clock = std::chrono::steady_clock;
+
+	std::vector<float> times;
+	times.reserve(runs);
+	for (uint32_t i = 0; i < runs; i++) {
+		const Clock::time_point start = Clock::now();
+		function();
+		times.push_back(std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+	}
+	std::sort(times.begin(), times.end());
+	return times[times.size() / 2];
+}
+
+// keeps the compiler from removing work whose result is unused
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+	[[maybe_unused]] static volatile T sink;
+	sink = value;
+}
+
+}
+
+// logging is compiled out of release builds, results always go to stdout
+#define BENCHMARK_PRINT(...) std::printf(__VA_ARGS__)
+
+#define BENCHMARK(name) \
+	static void name(); \
+	static ::Enik::Benchmark::Registrar name##_registrar(#name, name); \
+	static void name()
@@ -0,0 +1,35 @@
+#include <Enik.h>
+#include "core/entry_point.h"
+
+#include "benchmark.h"
+
+using namespace Enik;
+
+// headless, so scenes and the job system work without a window
+class BenchmarkApp : public Application {
+public:
+	BenchmarkApp(const std::string& filter)
+		: Application("benchmark", true), m_Filter(filter) {
+	}
+
+	virtual void Run() override {
+		for (const Benchmark::Entry& entry : Benchmark::GetEntries()) {
+			if (not m_Filter.empty() and std::string(entry.Name).find(m_Filter) == std::string::npos) {
+				continue;
+			}
+			BENCHMARK_PRINT("\n== %s\n", entry.Name);
+			entry.Run();
+			std::fflush(stdout);
+		}
+	}
+
+private:
+	std::string m_Filter;
+};
+
+
+// benchmark [name filter]
+Enik::Application* Enik::CreateApplication(){
+	const ApplicationCommandLineArgs& args = Application::GetCommandLineArgs();
+	return new BenchmarkApp(args.Count > 1 ? args[1] : "");
+}
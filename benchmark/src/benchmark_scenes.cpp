@@ -0,0 +1,26 @@
+#include "benchmark_scenes.h"
+#include "scene/scene_serializer.h"
+
+namespace Enik::Benchmark {
+
+std::filesystem::path GetDataDirectory() {
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "enik_benchmark";
+	std::filesystem::create_directories(directory);
+	return directory;
+}
+
+void WriteBodyPrefab(const std::filesystem::path& path) {
+	Ref<Scene> scene = CreateRef<Scene>();
+	Entity root = scene->CreateEntity("Body");
+	root.Add<Component::RigidBody>();
+	root.Add<Component::CollisionShape>();
+	for (int i = 0; i < 2; i++) {
+		Entity child = scene->CreateEntity("Part");
+		child.Get<Component::Transform>().LocalPosition = glm::vec3(i == 0 ? -0.5f : 0.5f, 0.5f, 0.0f);
+		child.Add<Component::CollisionShape>();
+		child.Reparent(root);
+	}
+	SceneSerializer(scene).CreatePrefab(path.string(), root);
+}
+
+}
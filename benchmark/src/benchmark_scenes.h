@@ -0,0 +1,15 @@
+#pragma once
+#include <Enik.h>
+
+#include <filesystem>
+
+namespace Enik::Benchmark {
+
+// generated prefabs and scenes go here, paths resolve from the working directory
+// since the benchmark project has no directory of its own
+std::filesystem::path GetDataDirectory();
+
+// a body with two child shapes, so every instance has three entities
+void WriteBodyPrefab(const std::filesystem::path& path);
+
+}
@@ -0,0 +1,62 @@
+#include "benchmark.h"
+#include "benchmark_scenes.h"
+#include "scene/scene_serializer.h"
+
+using namespace Enik;
+
+static constexpr uint32_t INSTANCE_COUNT = 200;
+static constexpr uint32_t STEPS = 120;
+
+// a pile of instances falling onto the ground
+static void WriteScene(const std::filesystem::path& path, const std::filesystem::path& prefab_path) {
+	Ref<Scene> scene = CreateRef<Scene>();
+	Entity ground = scene->CreateEntity("Ground");
+	ground.Get<Component::Transform>().LocalScale = glm::vec3(100.0f, 1.0f, 1.0f);
+	ground.Add<Component::CollisionBody>();
+	ground.Add<Component::CollisionShape>();
+
+	for (uint32_t i = 0; i < INSTANCE_COUNT; i++) {
+		Entity instance = scene->InstantiatePrefab(prefab_path);
+		instance.Get<Component::Transform>().LocalPosition = glm::vec3((float)(i % 20) * 2.0f - 20.0f, 2.0f + (float)(i / 20) * 1.5f, 0.0f);
+	}
+	SceneSerializer(scene).Serialize(path.string());
+}
+
+// loads and steps the scene like a fresh process would, the generator starts random
+static uint64_t RunScene(const std::filesystem::path& path) {
+	UUID::Reseed();
+	Ref<Scene> scene = CreateRef<Scene>();
+	SceneSerializer(scene).Deserialize(path.string());
+
+	scene->OnUpdateRuntime(PHYSICS_UPDATE_RATE);
+	for (uint32_t step = 0; step < STEPS; step++) {
+		scene->OnFixedUpdate();
+	}
+	return scene->GetStateHash();
+}
+
+// two runs of a deterministic scene with prefab instances end with the same hash
+BENCHMARK(DeterministicPrefabHash) {
+	Ref<Project> project = Project::New();
+	project->GetConfig().deterministic = true;
+
+	const std::filesystem::path directory = Benchmark::GetDataDirectory();
+	const std::filesystem::path prefab_path = directory / "body.prefab";
+	const std::filesystem::path scene_path  = directory / "prefabs.escn";
+	Benchmark::WriteBodyPrefab(prefab_path);
+	WriteScene(scene_path, prefab_path);
+
+	uint64_t hashes[2] = {};
+	float ms[2] = {};
+	for (int run = 0; run < 2; run++) {
+		ms[run] = Benchmark::MeasureMs(1, [&]() { hashes[run] = RunScene(scene_path); });
+	}
+
+	project->GetConfig().deterministic = false;
+
+	BENCHMARK_PRINT("%u instances, %u steps\n", INSTANCE_COUNT, STEPS);
+	for (int run = 0; run < 2; run++) {
+		BENCHMARK_PRINT("run %d: %.3f ms, hash %016llx\n", run + 1, ms[run], (unsigned long long)hashes[run]);
+	}
+	BENCHMARK_PRINT("%s\n", hashes[0] == hashes[1] ? "ok" : "MISMATCH");
+}
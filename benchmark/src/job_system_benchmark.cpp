@@ -0,0 +1,69 @@
+#include "benchmark.h"
+
+#include <cmath>
+#include <thread>
+
+using namespace Enik;
+
+static constexpr uint32_t ITEM_COUNT = 1 << 16;
+static constexpr uint32_t BATCH_SIZE = 256;
+static constexpr uint32_t RUNS = 15;
+
+// a few microseconds of math per item, similar to sampling an animation
+static float Work(uint32_t index) {
+	float value = (float)index;
+	for (int i = 0; i < 64; i++) {
+		value = std::sin(value) * 0.5f + std::cos(value * 0.25f);
+	}
+	return value;
+}
+
+// ParallelFor over the same work with more and more workers, against a plain loop
+BENCHMARK(JobSystemScaling) {
+	std::vector<float> results(ITEM_COUNT);
+
+	const float serial_ms = Benchmark::MeasureMs(RUNS, [&]() {
+		for (uint32_t i = 0; i < ITEM_COUNT; i++) {
+			results[i] = Work(i);
+		}
+	});
+	Benchmark::DoNotOptimize(results[ITEM_COUNT / 2]);
+	BENCHMARK_PRINT("%u items, batch %u, median of %u runs\n", ITEM_COUNT, BATCH_SIZE, RUNS);
+	BENCHMARK_PRINT("%-8s %10s %8s\n", "threads", "ms", "speedup");
+	BENCHMARK_PRINT("%-8s %10.3f %8.2f\n", "serial", serial_ms, 1.0f);
+
+	const uint32_t max_workers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+	for (uint32_t workers = 1; ; workers = std::min(workers * 2, max_workers)) {
+		JobSystem job_system(workers);
+		const float ms = Benchmark::MeasureMs(RUNS, [&]() {
+			job_system.ParallelFor(ITEM_COUNT, BATCH_SIZE, [&](uint32_t begin, uint32_t end) {
+				for (uint32_t i = begin; i < end; i++) {
+					results[i] = Work(i);
+				}
+			});
+		});
+		Benchmark::DoNotOptimize(results[ITEM_COUNT / 2]);
+
+		// the calling thread takes part too
+		BENCHMARK_PRINT("%-8u %10.3f %8.2f\n", workers + 1, ms, serial_ms / ms);
+		if (workers == max_workers) {
+			break;
+		}
+	}
+}
+
+// cost of one job from Submit to done, with nothing to do inside
+BENCHMARK(JobSystemOverhead) {
+	static constexpr uint32_t JOB_COUNT = 100000;
+	JobSystem job_system;
+
+	const float ms = Benchmark::MeasureMs(RUNS, [&]() {
+		JobCounter counter;
+		for (uint32_t i = 0; i < JOB_COUNT; i++) {
+			job_system.Submit([]() {}, &counter);
+		}
+		job_system.Wait(counter);
+	});
+	BENCHMARK_PRINT("%u empty jobs on %u workers: %.3f ms, %.1f ns per job\n",
+		JOB_COUNT, job_system.GetWorkerCount(), ms, ms * 1e6f / (float)JOB_COUNT);
+}
@@ -0,0 +1,66 @@
+#include "benchmark.h"
+#include "script_system/script_registry.h"
+
+#include <chrono>
+
+using namespace Enik;
+
+static uint32_t s_GroundEnters = 0;
+
+class GroundContacts : public ScriptableEntity {
+public:
+	virtual void OnCollisionEnter(Entity& other) override {
+		s_GroundEnters++;
+	}
+};
+
+// every body lands on the ground in the same step, so the contact buffer
+// (1024 events) overflows on the first step and grows before the next one
+BENCHMARK(PhysicsContactOverflow) {
+	static constexpr uint32_t BODY_COUNT = 10000;
+	static constexpr float SPACING = 1.5f;
+	static constexpr uint32_t STEPS = 60;
+
+	ScriptRegistry::RegisterScript<GroundContacts>("GroundContacts");
+
+	Ref<Scene> scene = CreateRef<Scene>();
+	const float width = BODY_COUNT * SPACING;
+
+	Entity ground = scene->CreateEntity("Ground");
+	ground.Get<Component::Transform>().LocalScale = glm::vec3(width + 2.0f, 1.0f, 1.0f);
+	ground.Add<Component::CollisionBody>();
+	ground.Add<Component::CollisionShape>();
+	ground.Add<Component::NativeScript>().Bind(*ScriptRegistry::Find("GroundContacts"));
+
+	// already sunk into the ground, apart from each other
+	for (uint32_t i = 0; i < BODY_COUNT; i++) {
+		Entity box = scene->CreateEntity("Box");
+		box.Get<Component::Transform>().LocalPosition = glm::vec3(i * SPACING - width * 0.5f, 0.8f, 0.0f);
+		box.Add<Component::RigidBody>();
+		box.Add<Component::CollisionShape>();
+	}
+
+	s_GroundEnters = 0;
+	// instantiates the ground script
+	scene->OnUpdateRuntime(PHYSICS_UPDATE_RATE);
+
+	using Clock = std::chrono::steady_clock;
+	float first_ms = 0.0f;
+	float total_ms = 0.0f;
+	for (uint32_t step = 0; step < STEPS; step++) {
+		const Clock::time_point start = Clock::now();
+		scene->OnFixedUpdate();
+		const float ms = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+		if (step == 0) {
+			first_ms = ms;
+		}
+		total_ms += ms;
+	}
+
+	const PhysicsStats& stats = scene->GetPhysicsStats();
+	BENCHMARK_PRINT("%u bodies, %u steps, %u contacts in the last step\n", BODY_COUNT, STEPS, stats.Contacts);
+	BENCHMARK_PRINT("first step (world creation and overflow) %.3f ms, average step %.3f ms\n",
+		first_ms, total_ms / (float)STEPS);
+	BENCHMARK_PRINT("ground OnCollisionEnter %u of %u %s\n",
+		s_GroundEnters, BODY_COUNT, s_GroundEnters == BODY_COUNT ? "ok" : "MISMATCH");
+}
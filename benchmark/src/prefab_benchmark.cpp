@@ -0,0 +1,43 @@
+#include "benchmark.h"
+#include "benchmark_scenes.h"
+#include "scene/scene_serializer.h"
+
+using namespace Enik;
+
+static constexpr uint32_t INSTANCE_COUNT = 10000;
+static constexpr uint32_t RUNS = 5;
+
+// the cached template against parsing the prefab's yaml for every instance
+BENCHMARK(PrefabInstantiate) {
+	Project::New();
+	const std::filesystem::path prefab_path = Benchmark::GetDataDirectory() / "body.prefab";
+	Benchmark::WriteBodyPrefab(prefab_path);
+
+	// the template is built once, on the first instance
+	{
+		Ref<Scene> scene = CreateRef<Scene>();
+		scene->InstantiatePrefab(prefab_path);
+	}
+
+	// a new scene every run, so each one starts with empty storages.
+	// scenes are kept until the end, destroying them is not timed
+	std::vector<Ref<Scene>> scenes;
+	const float cached_ms = Benchmark::MeasureMs(RUNS, [&]() {
+		Ref<Scene> scene = scenes.emplace_back(CreateRef<Scene>());
+		for (uint32_t i = 0; i < INSTANCE_COUNT; i++) {
+			scene->InstantiatePrefab(prefab_path);
+		}
+	});
+	const float yaml_ms = Benchmark::MeasureMs(RUNS, [&]() {
+		SceneSerializer serializer(scenes.emplace_back(CreateRef<Scene>()));
+		for (uint32_t i = 0; i < INSTANCE_COUNT; i++) {
+			serializer.InstantiatePrefab(prefab_path.string());
+		}
+	});
+	scenes.clear();
+
+	BENCHMARK_PRINT("%u instances of a 3 entity prefab, median of %u runs\n", INSTANCE_COUNT, RUNS);
+	BENCHMARK_PRINT("%-8s %10s %14s\n", "path", "ms", "us per prefab");
+	BENCHMARK_PRINT("%-8s %10.3f %14.3f\n", "cached", cached_ms, cached_ms * 1e3f / (float)INSTANCE_COUNT);
+	BENCHMARK_PRINT("%-8s %10.3f %14.3f\n", "yaml",   yaml_ms,   yaml_ms   * 1e3f / (float)INSTANCE_COUNT);
+}
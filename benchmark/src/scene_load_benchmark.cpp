@@ -0,0 +1,54 @@
+#include "benchmark.h"
+#include "benchmark_scenes.h"
+#include "scene/scene_serializer.h"
+
+using namespace Enik;
+
+// groups of a body with nine child shapes
+static void WriteScene(const std::filesystem::path& path, uint32_t entity_count) {
+	Ref<Scene> scene = CreateRef<Scene>();
+	Entity root;
+	for (uint32_t i = 0; i < entity_count; i++) {
+		Entity entity = scene->CreateEntity("Entity");
+		entity.Get<Component::Transform>().LocalPosition = glm::vec3((float)(i % 100), (float)(i / 100), 0.0f);
+		entity.Add<Component::CollisionShape>();
+		if (i % 10 == 0) {
+			entity.Add<Component::RigidBody>();
+			root = entity;
+		} else {
+			entity.Reparent(root);
+		}
+	}
+
+	SceneSerializer serializer(scene);
+	serializer.Serialize(path.string());
+	serializer.SerializeRuntime(SceneSerializer::GetRuntimePath(path.string()));
+}
+
+// the yaml the editor saves against the cooked binary the runtime loads
+BENCHMARK(SceneLoad) {
+	Project::New();
+
+	BENCHMARK_PRINT("%-9s %10s %10s %10s %10s %8s\n", "entities", "yaml ms", "binary ms", "yaml KiB", "binary KiB", "speedup");
+	for (uint32_t entity_count : { 1000u, 10000u, 100000u }) {
+		const std::filesystem::path path = Benchmark::GetDataDirectory() / ("load_" + std::to_string(entity_count) + ".escn");
+		const std::string runtime_path = SceneSerializer::GetRuntimePath(path.string());
+		WriteScene(path, entity_count);
+
+		// scenes are kept until the end, destroying them is not timed
+		const uint32_t runs = entity_count >= 100000 ? 3 : 7;
+		std::vector<Ref<Scene>> scenes;
+		const float yaml_ms = Benchmark::MeasureMs(runs, [&]() {
+			SceneSerializer(scenes.emplace_back(CreateRef<Scene>())).Deserialize(path.string());
+		});
+		const float binary_ms = Benchmark::MeasureMs(runs, [&]() {
+			SceneSerializer(scenes.emplace_back(CreateRef<Scene>())).DeserializeRuntime(runtime_path);
+		});
+		scenes.clear();
+
+		BENCHMARK_PRINT("%-9u %10.3f %10.3f %10.1f %10.1f %8.1f\n", entity_count, yaml_ms, binary_ms,
+			(float)std::filesystem::file_size(path) / 1024.0f,
+			(float)std::filesystem::file_size(runtime_path) / 1024.0f,
+			yaml_ms / binary_ms);
+	}
+}
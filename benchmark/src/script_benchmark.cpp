@@ -0,0 +1,108 @@
+#include "benchmark.h"
+#include "script_system/script_registry.h"
+
+using namespace Enik;
+
+static constexpr uint32_t SCRIPT_COUNT = 10000;
+static constexpr uint32_t RUNS = 31;
+
+// overrides nothing, the scene never calls it
+class IdleScript : public ScriptableEntity {
+};
+
+class EmptyFixedUpdateScript : public ScriptableEntity {
+public:
+	virtual void OnFixedUpdate() override {}
+};
+
+class CountingUpdateScript : public ScriptableEntity {
+public:
+	virtual void OnUpdate(Timestep ts) override { Count++; }
+	uint32_t Count = 0;
+};
+
+class KeyScript : public ScriptableEntity {
+public:
+	virtual void OnKeyPressed(const KeyPressedEvent& event) override { Count++; }
+	uint32_t Count = 0;
+};
+
+// each one listens to a single letter
+class SubscribedKeyScript : public ScriptableEntity {
+public:
+	virtual void OnCreate() override { SubscribeToKey(Key::A + s_NextKey++ % 26); }
+	virtual void OnKeyPressed(const KeyPressedEvent& event) override { Count++; }
+	uint32_t Count = 0;
+	static inline uint32_t s_NextKey = 0;
+};
+
+// a scene with nothing but scripts, so a step only costs the dispatch
+static Ref<Scene> CreateScriptScene(const std::string& script_name, uint32_t count) {
+	Ref<Scene> scene = CreateRef<Scene>();
+	const ScriptClass& script_class = *ScriptRegistry::Find(script_name);
+	for (uint32_t i = 0; i < count; i++) {
+		Entity entity = scene->CreateEntity("Scripted");
+		entity.Add<Component::NativeScript>().Bind(script_class);
+	}
+	// creates the instances
+	scene->OnUpdateRuntime(0.0f);
+	return scene;
+}
+
+// median of the Scripts system's own time in the phase, the rest of the step is not dispatch
+template <typename F>
+static float MeasureScriptsMs(Scene& scene, SystemPhase phase, F&& step) {
+	std::vector<float> times;
+	for (uint32_t i = 0; i < RUNS; i++) {
+		step();
+		for (const SystemTiming& timing : scene.GetSystemTimings()) {
+			if (timing.Phase == phase and timing.Name == "Scripts") {
+				times.push_back(timing.LastMs);
+			}
+		}
+	}
+	std::sort(times.begin(), times.end());
+	return times.empty() ? 0.0f : times[times.size() / 2];
+}
+
+// a fixed update and a runtime update over scripts that override
+// nothing, an empty OnFixedUpdate, and OnUpdate
+BENCHMARK(ScriptDispatch) {
+	ScriptRegistry::RegisterScript<IdleScript>("IdleScript");
+	ScriptRegistry::RegisterScript<EmptyFixedUpdateScript>("EmptyFixedUpdateScript");
+	ScriptRegistry::RegisterScript<CountingUpdateScript>("CountingUpdateScript");
+
+	BENCHMARK_PRINT("%u scripts, Scripts system time, median of %u runs\n", SCRIPT_COUNT, RUNS);
+	BENCHMARK_PRINT("%-24s %12s %12s\n", "script", "fixed ms", "update ms");
+
+	for (const char* name : { "IdleScript", "EmptyFixedUpdateScript", "CountingUpdateScript" }) {
+		Ref<Scene> scene = CreateScriptScene(name, SCRIPT_COUNT);
+		const float fixed_ms  = MeasureScriptsMs(*scene, SystemPhase::FixedUpdate, [&]() { scene->OnFixedUpdate(); });
+		const float update_ms = MeasureScriptsMs(*scene, SystemPhase::Update, [&]() { scene->OnUpdateRuntime(PHYSICS_UPDATE_RATE); });
+		BENCHMARK_PRINT("%-24s %12.3f %12.3f\n", name, fixed_ms, update_ms);
+	}
+}
+
+// a burst of key presses over scripts that ignore input, scripts that take every key,
+// and scripts subscribed to one key each
+BENCHMARK(ScriptInputDispatch) {
+	static constexpr uint32_t INPUT_SCRIPT_COUNT = 5000;
+	static constexpr uint32_t EVENT_COUNT = 1000;
+
+	ScriptRegistry::RegisterScript<IdleScript>("IdleScript");
+	ScriptRegistry::RegisterScript<KeyScript>("KeyScript");
+	ScriptRegistry::RegisterScript<SubscribedKeyScript>("SubscribedKeyScript");
+
+	BENCHMARK_PRINT("%u scripts, %u key presses over A to Z, median of %u runs\n", INPUT_SCRIPT_COUNT, EVENT_COUNT, RUNS);
+	BENCHMARK_PRINT("%-24s %12s %14s\n", "script", "ms", "us per event");
+
+	for (const char* name : { "IdleScript", "KeyScript", "SubscribedKeyScript" }) {
+		Ref<Scene> scene = CreateScriptScene(name, INPUT_SCRIPT_COUNT);
+		const float ms = Benchmark::MeasureMs(RUNS, [&]() {
+			for (uint32_t i = 0; i < EVENT_COUNT; i++) {
+				scene->OnKeyPressed(KeyPressedEvent(Key::A + i % 26));
+			}
+		});
+		BENCHMARK_PRINT("%-24s %12.3f %14.3f\n", name, ms, ms * 1e3f / (float)EVENT_COUNT);
+	}
+}
@@ -6,7 +6,7 @@ print_usage() {
 	echo "    clean   : Clean the build directory"
 	echo "    config  : Build configuration (debug | release | min)"
 	echo "    run     : Run the executable after build"
-	echo "    target  : Build target (editor | runtime)"
+	echo "    target  : Build target (editor | runtime | runtime_headless)"
 	echo "    static  : Link the script module statically"
 	echo "    mingw   : Use mingw toolchain"
 }
@@ -136,7 +136,7 @@ while [[ $# -gt 0 ]]; do
 			configure_first=true
 			shift
 			;;
-		editor|runtime)
+		editor|runtime|runtime_headless)
 			target="$1"
 			shift
 			;;
@@ -161,7 +161,7 @@ case "$target" in
 	editor)
 		build_dir="./build/editor"
 		;;
-	runtime)
+	runtime|runtime_headless)
 		build_dir="./build/runtime"
 		;;
 	*)
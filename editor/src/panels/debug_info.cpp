@@ -4,6 +4,7 @@
 #include "project/project.h"
 #include "core/application.h"
 #include "core/input.h"
+#include "script_system/script_registry.h"
 
 namespace Enik {
 
@@ -16,12 +17,15 @@ void DebugInfoPanel::BeginMenu() {
 		ImGui::Checkbox("Project",        &m_ShowProject);
 		ImGui::Checkbox("Viewport",       &m_ShowViewport);
 		ImGui::Checkbox("Program",        &m_ShowProgram);
+		ImGui::Checkbox("Systems",        &m_ShowSystems);
+		ImGui::Checkbox("Scripts",        &m_ShowScripts);
+		ImGui::Checkbox("Physics",        &m_ShowPhysics);
 		ImGui::EndMenu();
 	}
 }
 
 
-void DebugInfoPanel::ShowDebugInfoPanel(Timestep timestep, glm::vec2 viewport_size) {
+void DebugInfoPanel::ShowDebugInfoPanel(Timestep timestep, glm::vec2 viewport_size, Scene* scene) {
 	constexpr ImGuiWindowFlags debug_info_window_flags = ImGuiWindowFlags_AlwaysAutoResize |
 		ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoInputs |
 		ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoDocking | ImGuiWindowFlags_NoBackground
@@ -118,6 +122,47 @@ void DebugInfoPanel::ShowDebugInfoPanel(Timestep timestep, glm::vec2 viewport_si
 		ImGui::Text("	Time: %d minutes %d seconds", minutes, seconds);
 	}
 
+	if (m_ShowSystems and scene) {
+		ImGui::Spacing();
+		ImGui::Spacing();
+
+		ImGui::TextColored(color, "Systems");
+		for (const SystemTiming& timing : scene->GetSystemTimings()) {
+			ImGui::Text("	%-12s %u %-20s %.3fms (avg %.3fms)",
+				SystemScheduler::PhaseToString(timing.Phase), timing.Stage,
+				timing.Name.c_str(), timing.LastMs, timing.AverageMs);
+		}
+	}
+
+	if (m_ShowScripts) {
+		ImGui::Spacing();
+		ImGui::Spacing();
+
+		ImGui::TextColored(color, "Scripts");
+		for (const ScriptClassStats& stats : ScriptRegistry::GetStats()) {
+			ImGui::Text("	%-20s %4u live (peak %u) %4u slots %zuB",
+				stats.Name.c_str(), stats.LiveInstances, stats.PeakInstances,
+				stats.Capacity, stats.InstanceSize);
+		}
+	}
+
+	if (m_ShowPhysics and scene) {
+		ImGui::Spacing();
+		ImGui::Spacing();
+
+		const PhysicsStats& stats = scene->GetPhysicsStats();
+		ImGui::TextColored(color, "Physics");
+		ImGui::Text("	Bodies: %u / %u (%u active)", stats.Bodies, stats.MaxBodies, stats.ActiveBodies);
+		ImGui::Text("	Contacts: %u (pairs %u, constraints %u)", stats.Contacts, stats.MaxBodyPairs, stats.MaxContactConstraints);
+		ImGui::Text("	Temp Allocator: %.1fKB / %.1fKB (peak %.1fKB)",
+			stats.TempHighWater / 1024.0f, stats.TempSize / 1024.0f, stats.TempPeakHighWater / 1024.0f);
+		ImGui::Text("	Shapes: %u", stats.Shapes);
+		ImGui::Text("	Rebuilds: %u", stats.Rebuilds);
+		if (scene->IsDeterministic()) {
+			ImGui::Text("	State Hash: %016llx (step %llu)",
+				(unsigned long long)scene->GetStateHash(), (unsigned long long)scene->GetFixedStep());
+		}
+	}
 
 	ImGui::End();
 }
@@ -126,7 +171,7 @@ void DebugInfoPanel::ShowDebugInfoPanel(Timestep timestep, glm::vec2 viewport_si
 bool DebugInfoPanel::OnKeyReleased(KeyReleasedEvent& event) {
 	if (Input::IsKeyPressed(Key::LeftControl)) {
 		if (event.GetKeyCode() == Key::U) {
-			m_ShowPerformance = m_ShowRendererStats = m_ShowRenderer = m_ShowProject = m_ShowViewport = m_ShowProgram = not m_ShowPerformance;
+			m_ShowPerformance = m_ShowRendererStats = m_ShowRenderer = m_ShowProject = m_ShowViewport = m_ShowProgram = m_ShowSystems = m_ShowScripts = m_ShowPhysics = not m_ShowPerformance;
 		}
 	}
     return false;
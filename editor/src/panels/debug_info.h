@@ -3,6 +3,7 @@
 #include <glm/glm.hpp>
 #include "events/key_event.h"
 #include "core/timestep.h"
+#include "scene/scene.h"
 
 
 namespace Enik {
@@ -11,7 +12,7 @@ class DebugInfoPanel {
 public:
 	void BeginMenu();
 
-	void ShowDebugInfoPanel(Timestep timestep, glm::vec2 viewport_size);
+	void ShowDebugInfoPanel(Timestep timestep, glm::vec2 viewport_size, Scene* scene);
 
 	bool OnKeyReleased(KeyReleasedEvent& event);
 
@@ -22,6 +23,9 @@ private:
 	bool m_ShowProject       = false;
 	bool m_ShowViewport        = false;
 	bool m_ShowProgram       = false;
+	bool m_ShowSystems       = false;
+	bool m_ShowScripts       = false;
+	bool m_ShowPhysics       = false;
 
 	std::chrono::high_resolution_clock::time_point m_StartTime = std::chrono::high_resolution_clock::now();
 
@@ -25,6 +25,22 @@ constexpr ImGuiTreeNodeFlags inner_tree_node_flags = ImGuiTreeNodeFlags_OpenOnDo
 	ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_FramePadding;
 
 
+static void DisplayPhysicsLayerCombo(uint16_t& layer) {
+	const auto& layers = Project::GetActive()->GetConfig().physics_layers;
+	const std::string preview = layer < layers.size() ? layers[layer].name : std::to_string(layer) + " (invalid)";
+
+	if (ImGui::BeginCombo("##Layer", preview.c_str())) {
+		for (uint16_t i = 0; i < layers.size(); i++) {
+			ImGui::PushID(i);
+			if (ImGui::Selectable(layers[i].name.c_str(), i == layer)) {
+				layer = i;
+			}
+			ImGui::PopID();
+		}
+		ImGui::EndCombo();
+	}
+}
+
 void InspectorPanel::SetContext(const Ref<Scene>& context, SceneTreePanel* scene_tree_panel, AnimationEditorPanel* animation_panel, EditorLayer* el) {
 	m_Context = context;
 	m_SceneTreePanel = scene_tree_panel;
@@ -275,12 +291,7 @@ void InspectorPanel::DrawEntityInInspector(Entity entity) {
 		auto& body = entity.Get<Component::RigidBody>();
 
 		ImGuiUtils::PrefixLabel("Layer");
-		if (ImGui::BeginCombo("##Layer", std::to_string(body.Layer).c_str())) {
-			if (ImGui::Selectable("0")) { body.Layer = 0; }
-			if (ImGui::Selectable("1")) { body.Layer = 1; }
-			if (ImGui::Selectable("2")) { body.Layer = 2; }
-			ImGui::EndCombo();
-		}
+		DisplayPhysicsLayerCombo(body.Layer);
 
 		ImGuiUtils::PrefixLabel("Mass");
 		float mass = body.GetMass();
@@ -301,12 +312,7 @@ void InspectorPanel::DrawEntityInInspector(Entity entity) {
 		auto& body = entity.Get<Component::CollisionBody>();
 
 		ImGuiUtils::PrefixLabel("Layer");
-		if (ImGui::BeginCombo("##Layer", std::to_string(body.Layer).c_str())) {
-			if (ImGui::Selectable("0")) { body.Layer = 0; }
-			if (ImGui::Selectable("1")) { body.Layer = 1; }
-			if (ImGui::Selectable("2")) { body.Layer = 2; }
-			ImGui::EndCombo();
-		}
+		DisplayPhysicsLayerCombo(body.Layer);
 
 		ImGuiUtils::PrefixLabel("Is Static");
 		bool is_static = body.MotionType == JPH::EMotionType::Static;
@@ -333,6 +339,13 @@ void InspectorPanel::DrawEntityInInspector(Entity entity) {
 				cs.Shape == Component::CollisionShape::Type::CIRCLE)) {
 				cs.Shape =  Component::CollisionShape::Type::CIRCLE;
 			}
+			if (ImGui::Selectable("Polygon",
+				cs.Shape == Component::CollisionShape::Type::POLYGON)) {
+				cs.Shape =  Component::CollisionShape::Type::POLYGON;
+				if (cs.Points.empty()) {
+					cs.Points = { { -0.5f, -0.5f }, { 0.5f, -0.5f }, { 0.0f, 0.5f } };
+				}
+			}
 			ImGui::EndCombo();
 		}
 
@@ -345,6 +358,27 @@ void InspectorPanel::DrawEntityInInspector(Entity entity) {
 				ImGuiUtils::PrefixLabel("Scale");
 				ImGui::DragFloat3("##Scale", glm::value_ptr(cs.BoxScale), 0.01f);
 			} break;
+			case Component::CollisionShape::Type::POLYGON: {
+				// the shape is the convex hull of the points
+				int remove_index = -1;
+				for (size_t i = 0; i < cs.Points.size(); i++) {
+					ImGui::PushID((int)i);
+					ImGuiUtils::PrefixLabel("Point " + std::to_string(i));
+					ImGui::DragFloat2("##Point", glm::value_ptr(cs.Points[i]), 0.01f);
+					ImGui::SameLine();
+					if (ImGui::Button("-") and cs.Points.size() > 3) {
+						remove_index = (int)i;
+					}
+					ImGui::PopID();
+				}
+				if (remove_index >= 0) {
+					cs.Points.erase(cs.Points.begin() + remove_index);
+				}
+				ImGuiUtils::PrefixLabel("");
+				if (ImGui::Button("Add Point")) {
+					cs.Points.push_back(cs.Points.empty() ? glm::vec2(0.0f) : cs.Points.back());
+				}
+			} break;
 			case Component::CollisionShape::Type::NONE: break;
 		}
 
@@ -626,9 +660,12 @@ void InspectorPanel::DisplayNativeScriptsInPopup() {
 
 	if (open) {
 		ImGui::BeginDisabled(m_SceneTreePanel->GetSelectedEntity().Has<Component::NativeScript>());
-		for (auto& pair : ScriptRegistry::GetRegistry()) {
-			if (ImGui::MenuItem(pair.first.c_str())) {
-				m_SceneTreePanel->GetSelectedEntity().Add<Component::NativeScript>().Bind(pair.first, pair.second);
+		for (const ScriptClass& script_class : ScriptRegistry::GetClasses()) {
+			if (not script_class.IsRegistered()) {
+				continue;
+			}
+			if (ImGui::MenuItem(script_class.Name.c_str())) {
+				m_SceneTreePanel->GetSelectedEntity().Add<Component::NativeScript>().Bind(script_class);
 				ImGui::CloseCurrentPopup();
 			}
 		}
@@ -639,10 +676,13 @@ void InspectorPanel::DisplayNativeScriptsInPopup() {
 }
 
 void InspectorPanel::DisplayNativeScript(Component::NativeScript& script) {
-	for (auto& pair : script.NativeScriptFields) {
-		NativeScriptField& field = pair.second;
+	if (not script.FieldSchema) {
+		return;
+	}
 
-		EN_CORE_ASSERT(field.Value != nullptr);
+	for (const ScriptFieldInfo& field : script.FieldSchema->Fields) {
+		// edits the live instance while playing
+		void* value = script.GetFieldValue(field);
 
 		ImGuiUtils::PrefixLabel(field.Name);
 
@@ -655,30 +695,30 @@ void InspectorPanel::DisplayNativeScript(Component::NativeScript& script) {
 				EN_CORE_ERROR("DisplayNativeScript field.Type is NONE !");
 				continue;
 			case FieldType::BOOL:
-				ImGui::Checkbox(label, static_cast<bool*>(field.Value));
+				ImGui::Checkbox(label, static_cast<bool*>(value));
 				continue;
 			case FieldType::INT:
-				ImGui::DragInt(label, static_cast<int*>(field.Value));
+				ImGui::DragInt(label, static_cast<int*>(value));
 				continue;
 			case FieldType::FLOAT:
-				ImGui::DragFloat(label, static_cast<float*>(field.Value), speed);
+				ImGui::DragFloat(label, static_cast<float*>(value), speed);
 				continue;
 			case FieldType::DOUBLE:
-				ImGui::DragFloat(label, (float*)static_cast<double*>(field.Value), speed);
+				ImGui::DragFloat(label, (float*)static_cast<double*>(value), speed);
 				continue;
 			case FieldType::VEC2:
-				ImGui::DragFloat2(label, static_cast<float*>(field.Value), speed);
+				ImGui::DragFloat2(label, static_cast<float*>(value), speed);
 				continue;
 			case FieldType::VEC3:
-				ImGui::DragFloat3(label, static_cast<float*>(field.Value), speed);
+				ImGui::DragFloat3(label, static_cast<float*>(value), speed);
 				continue;
 			case FieldType::VEC4:
-				ImGui::DragFloat4(label, static_cast<float*>(field.Value), speed);
+				ImGui::DragFloat4(label, static_cast<float*>(value), speed);
 				continue;
 			case FieldType::PREFAB: {
 				char buffer[256];
 				memset(buffer, 0, sizeof(buffer));
-				strcpy(buffer, static_cast<std::string*>(field.Value)->c_str());
+				strcpy(buffer, static_cast<std::string*>(value)->c_str());
 
 				auto file = std::filesystem::path(buffer);
 				if (file.empty()) {
@@ -702,7 +742,7 @@ void InspectorPanel::DisplayNativeScript(Component::NativeScript& script) {
 								strcpy(buffer, reinterpret_cast<const char*>(payload_data));
 								std::filesystem::path path = { buffer };
 								if (path.has_extension() and path.extension() == ".prefab") {
-									*static_cast<std::string*>(field.Value) = path.string();
+									*static_cast<std::string*>(value) = path.string();
 								}
 								delete[] payload_data;
 							}
@@ -715,9 +755,9 @@ void InspectorPanel::DisplayNativeScript(Component::NativeScript& script) {
 			case FieldType::STRING: {
 				char buffer[256];
 				memset(buffer, 0, sizeof(buffer));
-				strcpy(buffer, static_cast<std::string*>(field.Value)->c_str());
+				strcpy(buffer, static_cast<std::string*>(value)->c_str());
 				if (ImGui::InputTextMultiline(label, buffer, sizeof(buffer))) {
-					*static_cast<std::string*>(field.Value) = std::string(buffer);
+					*static_cast<std::string*>(value) = std::string(buffer);
 				}
 
 				if (ImGui::BeginDragDropTarget()) {
@@ -727,7 +767,7 @@ void InspectorPanel::DisplayNativeScript(Component::NativeScript& script) {
 							if (payload_data != nullptr) {
 								memcpy(payload_data, payload->Data, payload->DataSize);
 								strcpy(buffer, reinterpret_cast<const char*>(payload_data));
-								*static_cast<std::string*>(field.Value) = std::string(buffer);
+								*static_cast<std::string*>(value) = std::string(buffer);
 								delete[] payload_data;
 							}
 						}
@@ -738,7 +778,7 @@ void InspectorPanel::DisplayNativeScript(Component::NativeScript& script) {
 				continue;
 			}
 			case FieldType::ENTITY: {
-				UUID& id = *static_cast<UUID*>(field.Value);
+				UUID& id = *static_cast<UUID*>(value);
 				if (EntityButton(id)) {
 					m_SceneTreePanel->SetSelectedEntityWithUUID(id);
 				}
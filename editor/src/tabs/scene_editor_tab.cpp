@@ -211,7 +211,7 @@ void SceneEditorTab::RenderContent() {
 			m_ViewportBounds[1].x - m_ViewportBounds[0].x,
 			m_ViewportBounds[1].y - m_ViewportBounds[0].y
 		};
-		m_DebugInfoPanel.ShowDebugInfoPanel(m_Timestep, viewport_size);
+		m_DebugInfoPanel.ShowDebugInfoPanel(m_Timestep, viewport_size, m_ActiveScene.get());
 	}
 
 
@@ -276,6 +276,7 @@ void SceneEditorTab::SaveScene() {
 
 		SceneSerializer serializer = SceneSerializer(m_ActiveScene);
 		serializer.Serialize(m_ActiveScenePath.string());
+		serializer.SerializeRuntime(SceneSerializer::GetRuntimePath(m_ActiveScenePath.string()));
 		Project::GetAssetManagerEditor()->SerializeAssetRegistry();
 	}
 }
@@ -310,11 +311,10 @@ bool SceneEditorTab::OnKeyPressed(KeyPressedEvent& event) {
 			break;
 		case Key::D:
 			if (control and m_SceneTreePanel.IsSelectedEntityValid()) {
-				SaveScene();
 				SceneSerializer serializer = SceneSerializer(m_ActiveScene);
 
 				auto& id = m_SceneTreePanel.GetSelectedEntity().Get<Component::ID>().uuid;
-				auto& new_id = serializer.DuplicateEntity(m_ActiveScenePath.string(), id);
+				auto& new_id = serializer.DuplicateEntity(id);
 				m_SceneTreePanel.SetSelectedEntityWithUUID(new_id);
 
 			}
@@ -481,12 +481,8 @@ void SceneEditorTab::ShowToolbarPlayPause() {
 
 void SceneEditorTab::OnScenePlay() {
 	OnScenePause(false);
-	// FIX: i do not want to save everytime
-	// maybe save to a tmp file, read from that to create the tmp playing scene
-	// we also can use this as autosave
-	SaveScene();
 
-	if (m_ActiveScenePath.empty()) {
+	if (m_EditorScene == nullptr) {
 		return;
 	}
 
@@ -494,15 +490,10 @@ void SceneEditorTab::OnScenePlay() {
 
 	m_SceneState = SceneState::Play;
 
-	/* Copy Current Editor Scene */ {
-		Ref<Scene> new_scene = CreateRef<Scene>();
-		SceneSerializer serializer = SceneSerializer(new_scene);
-		if (serializer.Deserialize(m_ActiveScenePath.string())) {
-			m_ActiveScene = new_scene;
-			m_ActiveScene->OnViewportResize(m_ViewportPosition, (uint32_t)m_ViewportSize.x, (uint32_t)m_ViewportSize.y);
-			SetPanelsContext();
-		}
-	}
+	// play on an in memory copy, the editor scene is restored on stop
+	m_ActiveScene = Scene::Copy(m_EditorScene);
+	m_ActiveScene->OnViewportResize(m_ViewportPosition, (uint32_t)m_ViewportSize.x, (uint32_t)m_ViewportSize.y);
+	SetPanelsContext();
 
 	m_SceneTreePanel.SetSelectedEntityWithUUID(current_selected_entity);
 	ImGui::SetWindowFocus(m_ViewportPanelName.c_str());
@@ -598,6 +589,18 @@ void SceneEditorTab::OnOverlayRender() {
 					Renderer2D::DrawRect(trans, glm::vec4(0.3f, 0.8f, 0.3f, 1.0f), line_thickness);
 					break;
 				}
+				case Component::CollisionShape::Type::POLYGON: {
+					auto to_world = [&](const glm::vec2& point) {
+						glm::vec3 local = glm::vec3(point, 0.0f) * transform.GlobalScale;
+						glm::vec3 world = transform.GlobalPosition + transform.GlobalRotation * local;
+						return glm::vec3(world.x, world.y, 0.998f);
+					};
+					for (size_t i = 0; i < collider.Points.size(); i++) {
+						const glm::vec2& next = collider.Points[(i + 1) % collider.Points.size()];
+						Renderer2D::DrawLine(to_world(collider.Points[i]), to_world(next), glm::vec4(0.3f, 0.8f, 0.3f, 1.0f), line_thickness);
+					}
+					break;
+				}
 				case Component::CollisionShape::Type::NONE: break;
 
 			}
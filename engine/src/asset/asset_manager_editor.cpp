@@ -35,6 +35,7 @@ bool AssetManagerEditor::IsAssetHandleValid(AssetHandle handle) const {
 }
 
 bool AssetManagerEditor::IsAssetLoaded(AssetHandle handle) const {
+	std::lock_guard<std::recursive_mutex> lock(m_LoadedAssetsMutex);
 	return m_LoadedAssets.find(handle) != m_LoadedAssets.end();
 }
 
@@ -64,6 +65,8 @@ Ref<Asset> AssetManagerEditor::GetAsset(AssetHandle handle) {
 		return nullptr;
 	}
 
+	std::lock_guard<std::recursive_mutex> lock(m_LoadedAssetsMutex);
+
 	Ref<Asset> asset;
 	if (IsAssetLoaded(handle)) {
 		asset = m_LoadedAssets.at(handle);
@@ -107,6 +110,7 @@ AssetHandle AssetManagerEditor::ImportAsset(const std::filesystem::path& path) {
 	
 	Ref<Asset> asset = AssetImporter::ImportAsset(handle, metadata);
 	if (asset) {
+		std::lock_guard<std::recursive_mutex> lock(m_LoadedAssetsMutex);
 		asset->Handle = handle;
 		m_LoadedAssets[handle] = asset;
 		m_AssetRegistry[handle] = metadata;
@@ -1,5 +1,6 @@
 #pragma once
 #include <map>
+#include <mutex>
 #include "asset/asset_manager_base.h"
 #include "asset/asset_metadata.h"
 
@@ -28,6 +29,9 @@ private:
 	AssetRegistry m_AssetRegistry;
 	AssetMap m_LoadedAssets;
 
+	// NOTE: scene systems can request assets from worker threads
+	mutable std::recursive_mutex m_LoadedAssetsMutex;
+
 };
 
 }
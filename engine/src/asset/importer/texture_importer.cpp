@@ -2,6 +2,7 @@
 #include "base.h"
 #include "core/log.h"
 #include "project/project.h"
+#include "renderer/renderer.h"
 #include "renderer/texture.h"
 #include <stb_image/stb_image.h>
 
@@ -14,6 +15,11 @@ Ref<Texture2D> TextureImporter::ImportTexture2D(AssetHandle handle, const AssetM
 Ref<Texture2D> TextureImporter::LoadTexture2D(const std::filesystem::path& path) {
 	EN_PROFILE_SCOPE;
 
+	// headless, no need to decode the image
+	if (Renderer::GetAPI() == RendererAPI::API::None) {
+		return nullptr;
+	}
+
 	int width, height, channels;
 	stbi_set_flip_vertically_on_load(1);
 	Buffer data;
@@ -68,6 +68,9 @@ void UninitSound(void* sound) {
 
 
 void Play(AssetHandle sound_handle) {
+	if (!is_engine_initialized) {
+		return;
+	}
 	Ref<SoundAsset> sound_asset = AssetManager::GetAsset<SoundAsset>(sound_handle);
 	ma_sound* sound = static_cast<ma_sound*>(sound_asset->sound);
 
@@ -6,19 +6,29 @@
 #include "renderer/renderer.h"
 #include "physics/physics.h"
 #include "audio/audio.h"
+#include <chrono>
 
 namespace Enik {
 
 // make application static
 Application* Application::s_Instance = nullptr;
 Application& Application::Get() { return *Application::s_Instance; }
+ApplicationCommandLineArgs Application::s_CommandLineArgs;
 
-Application::Application(const std::string& name) {
+Application::Application(const std::string& name, bool headless)
+	: m_Headless(headless) {
 	EN_PROFILE_SCOPE;
 
 	EN_CORE_ASSERT(!s_Instance, "Application already exists!");
 	s_Instance = this;
 
+	m_JobSystem = CreateScope<JobSystem>();
+
+	if (m_Headless) {
+		RendererAPI::SetAPI(RendererAPI::API::None);
+		return;
+	}
+
 	m_Window = CreateScope<Window>(WindowProperties(name, 1600, 800));
 	m_Window->SetEventCallback(EN_BIND_EVENT_FN(Application::OnEvent));
 	m_Window->SetVsync(true);
@@ -31,6 +41,9 @@ Application::Application(const std::string& name) {
 }
 
 Application::~Application() {
+	if (m_Headless) {
+		return;
+	}
 	Renderer::Shutdown();
 	Audio::Shutdown();
 }
@@ -50,7 +63,12 @@ void Application::PushOverlay(Layer* overlay) {
 }
 
 void Application::Run() {
-	const double dt = PHYSICS_UPDATE_RATE;
+	if (m_Headless) {
+		RunHeadless();
+		return;
+	}
+
+	using Clock = std::chrono::steady_clock;
 	double accumulator = 0.0;
 
 	while (m_Running) {
@@ -58,17 +76,16 @@ void Application::Run() {
 		Timestep timestep = time - m_LastFrameTime;
 		m_LastFrameTime = time;
 
+		const Clock::time_point frame_start = Clock::now();
+
 		ExecuteMainThreadQueue();
+		if (not UpdateInput(timestep)) {
+			break;
+		}
 
-		if (!m_Minimized) {
-			accumulator += timestep.GetSeconds();
-			while ( accumulator >= dt ) {
-				for (Layer* layer : m_LayerStack) {
-					EN_PROFILE_SECTION("layers OnFixedUpdate");
-					layer->OnFixedUpdate();
-				}
-				accumulator -= dt;
-			}
+		// a replay keeps stepping while minimized, or it would drift from the recording
+		if (!m_Minimized or m_InputRecorder.IsReplaying()) {
+			RunFixedUpdates(accumulator, timestep);
 
 			for (Layer* layer : m_LayerStack) {
 				EN_PROFILE_SECTION("layers OnUpdate");
@@ -84,15 +101,121 @@ void Application::Run() {
 			m_ImGuiLayer->End();
 		}
 
+		// without the buffer swap, vsync would hide the frame time
+		if (m_InputRecorder.IsReplaying()) {
+			m_FrameTimes.Add(std::chrono::duration<float, std::milli>(Clock::now() - frame_start).count());
+		}
 
 		m_Window->OnUpdate();
 		EN_PROFILE_FRAME("Application::Run");
 	}
 }
 
+void Application::RunHeadless() {
+	using Clock = std::chrono::steady_clock;
+	double accumulator = 0.0;
+
+	Clock::time_point window_start = Clock::now();
+	uint64_t window_start_step = m_StepCount;
+
+	while (m_Running) {
+		const Clock::time_point frame_start = Clock::now();
+
+		// without a replay every frame is exactly one step
+		Timestep timestep = PHYSICS_UPDATE_RATE;
+
+		ExecuteMainThreadQueue();
+		if (not UpdateInput(timestep)) {
+			break;
+		}
+
+		RunFixedUpdates(accumulator, timestep);
+
+		for (Layer* layer : m_LayerStack) {
+			EN_PROFILE_SECTION("layers OnUpdate");
+			layer->OnUpdate(timestep);
+		}
+
+		const Clock::time_point now = Clock::now();
+		if (m_InputRecorder.IsReplaying()) {
+			m_FrameTimes.Add(std::chrono::duration<float, std::milli>(now - frame_start).count());
+		}
+
+		const double elapsed = std::chrono::duration<double>(now - window_start).count();
+		if (elapsed >= 1.0) {
+			m_StepsPerSecond = (double)(m_StepCount - window_start_step) / elapsed;
+			window_start_step = m_StepCount;
+			window_start = now;
+		}
+
+		EN_PROFILE_FRAME("Application::RunHeadless");
+	}
+}
+
+void Application::RunFixedUpdates(double& accumulator, Timestep timestep) {
+	const double dt = PHYSICS_UPDATE_RATE;
+
+	accumulator += timestep.GetSeconds();
+	int fixed_updates = 0;
+	while ( accumulator >= dt and fixed_updates < MAX_FIXED_UPDATES_PER_FRAME ) {
+		for (Layer* layer : m_LayerStack) {
+			EN_PROFILE_SECTION("layers OnFixedUpdate");
+			layer->OnFixedUpdate();
+		}
+		accumulator -= dt;
+		fixed_updates++;
+		m_StepCount++;
+	}
+	// catching up would make the next frame even slower
+	if (accumulator >= dt) {
+		accumulator = std::fmod(accumulator, dt);
+	}
+	m_FixedUpdateAlpha = (float)(accumulator / dt);
+}
+
+bool Application::UpdateInput(Timestep& timestep) {
+	if (m_InputRecorder.IsReplaying()) {
+		float recorded_timestep = 0.0f;
+		if (not m_InputRecorder.ReplayFrame(recorded_timestep, EN_BIND_EVENT_FN(Application::DispatchEvent))) {
+			m_FrameTimes.Print("Replay frame times");
+			Close();
+			return false;
+		}
+		timestep = recorded_timestep;
+	} else if (not m_Headless) {
+		Input::PollWindow();
+		m_InputRecorder.RecordFrame(timestep);
+	}
+
+	Input::Update();
+	return true;
+}
+
+bool Application::StartInputRecording(const std::filesystem::path& path) {
+	return m_InputRecorder.StartRecording(path);
+}
+
+bool Application::StartInputReplay(const std::filesystem::path& path) {
+	m_FrameTimes.Clear();
+	return m_InputRecorder.StartReplay(path);
+}
+
 void Application::OnEvent(Event& e) {
+	if (e.IsInCategory(EventCategoryInput)) {
+		// live input is ignored while a recording plays
+		if (m_InputRecorder.IsReplaying()) {
+			return;
+		}
+		m_InputRecorder.RecordEvent(e);
+	}
+	DispatchEvent(e);
+}
+
+void Application::DispatchEvent(Event& e) {
 	EN_PROFILE_SCOPE;
 
+	Input::OnEvent(e);
+
 	EventDispatcher dispatcher(e);
 	dispatcher.Dispatch<WindowCloseEvent>(EN_BIND_EVENT_FN(Application::OnWindowClose));
 	dispatcher.Dispatch<WindowResizeEvent>(EN_BIND_EVENT_FN(Application::OnWindowResize));
@@ -139,11 +262,15 @@ bool Application::OnKeyPressed(KeyPressedEvent& e) {
 }
 
 void Application::ExecuteMainThreadQueue() {
-	std::scoped_lock<std::mutex> lock(m_MainThreadQueueMutex);
-	for(auto& function : m_MainThreadQueue) {
+	// swapped out first, so a function can submit again for the next frame
+	std::vector<std::function<void()>> queue;
+	{
+		std::scoped_lock<std::mutex> lock(m_MainThreadQueueMutex);
+		queue.swap(m_MainThreadQueue);
+	}
+	for(auto& function : queue) {
 		function();
 	}
-	m_MainThreadQueue.clear();
 }
 
 }
\ No newline at end of file
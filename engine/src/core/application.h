@@ -1,6 +1,9 @@
 #pragma once
 
 #include <base.h>
+#include "core/frame_time_stats.h"
+#include "core/input_recorder.h"
+#include "core/job_system.h"
 #include "core/timestep.h"
 #include "events/application_event.h"
 #include "events/event.h"
@@ -12,9 +15,17 @@
 
 namespace Enik {
 
+struct ApplicationCommandLineArgs {
+	int Count = 0;
+	char** Args = nullptr;
+
+	const char* operator[](int index) const { return Args[index]; }
+};
+
 class Application {
 public:
-	Application(const std::string& name = "eengine");
+	// headless runs without a window, renderer, audio or imgui
+	Application(const std::string& name = "eengine", bool headless = false);
 	virtual ~Application();
 	virtual void Run();
 
@@ -24,16 +35,38 @@ public:
 	void PushOverlay(Layer* overlay);
 
 	static Application& Get();
+
+	// set by the entry point before the application is created
+	inline static void SetCommandLineArgs(ApplicationCommandLineArgs args) { s_CommandLineArgs = args; }
+	inline static const ApplicationCommandLineArgs& GetCommandLineArgs() { return s_CommandLineArgs; }
 	inline Window& GetWindow() { return *m_Window; }
 
 	inline ImGuiLayer* GetImGuiLayer() { return m_ImGuiLayer; }
 
+	inline JobSystem& GetJobSystem() { return *m_JobSystem; }
+
 	void Close();
 
 	inline static void SetWindowTitle(const std::string& title) { Get().m_Window->SetWindowTitle(title); }
 
 	void SubmitToMainThread(const std::function<void()>& function);
 
+	// how far the frame is between the last fixed update and the next, in [0, 1)
+	inline float GetFixedUpdateAlpha() const { return m_FixedUpdateAlpha; }
+
+	inline bool IsHeadless() const { return m_Headless; }
+	// fixed steps run so far
+	inline uint64_t GetStepCount() const { return m_StepCount; }
+	// measured over the last second of a headless run
+	inline double GetStepsPerSecond() const { return m_StepsPerSecond; }
+
+	// records the input of every frame until the application closes
+	bool StartInputRecording(const std::filesystem::path& path);
+	// plays recorded input on the recorded frame times instead of the wall clock,
+	// logs frame time percentiles and closes the application when it ends
+	bool StartInputReplay(const std::filesystem::path& path);
+	inline bool IsReplayingInput() const { return m_InputRecorder.IsReplaying(); }
+
 private:
 	bool OnWindowClose(WindowCloseEvent& e);
 	bool OnWindowResize(WindowResizeEvent& e);
@@ -41,19 +74,36 @@ private:
 
 	void ExecuteMainThreadQueue();
 
+	// steps the layers on a fixed clock as fast as possible
+	void RunHeadless();
+	void RunFixedUpdates(double& accumulator, Timestep timestep);
+	// replays or polls and records the input of the frame, false once a replay ended
+	bool UpdateInput(Timestep& timestep);
+	// OnEvent without the recording
+	void DispatchEvent(Event& e);
+
 private:
+	Scope<JobSystem> m_JobSystem;
 	Scope<Window> m_Window;
-	ImGuiLayer* m_ImGuiLayer;
+	ImGuiLayer* m_ImGuiLayer = nullptr;
+	bool m_Headless = false;
 	bool m_Running = true;
 	bool m_Minimized = false;
 	LayerStack m_LayerStack;
 	float m_LastFrameTime = 0.0f;
+	float m_FixedUpdateAlpha = 0.0f;
+	uint64_t m_StepCount = 0;
+	double m_StepsPerSecond = 0.0;
+
+	InputRecorder m_InputRecorder;
+	FrameTimeStats m_FrameTimes;
 
 	std::vector<std::function<void()>> m_MainThreadQueue;
 	std::mutex m_MainThreadQueueMutex;
 
 private:
 	static Application* s_Instance;
+	static ApplicationCommandLineArgs s_CommandLineArgs;
 };
 
 // To be defined in CLIENT
@@ -6,6 +6,7 @@ extern Enik::Application* Enik::CreateApplication();
 
 int main(int argc, char** argv) {
 	Enik::Log::Init();
+	Enik::Application::SetCommandLineArgs({ argc, argv });
 	auto app = Enik::CreateApplication();
 	app->Run();
 	delete app;
@@ -0,0 +1,44 @@
+#include "frame_time_stats.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace Enik {
+
+static float Percentile(const std::vector<float>& sorted, float percent) {
+	const size_t rank = (size_t)std::ceil(percent / 100.0f * (float)sorted.size());
+	return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+FrameTimeStats::Summary FrameTimeStats::Summarize() const {
+	Summary summary;
+	if (m_Samples.empty()) {
+		return summary;
+	}
+
+	std::vector<float> sorted = m_Samples;
+	std::sort(sorted.begin(), sorted.end());
+
+	double total = 0.0;
+	for (float sample : sorted) {
+		total += sample;
+	}
+
+	summary.FrameCount = (uint32_t)sorted.size();
+	summary.Mean = (float)(total / (double)sorted.size());
+	summary.P50  = Percentile(sorted, 50.0f);
+	summary.P90  = Percentile(sorted, 90.0f);
+	summary.P95  = Percentile(sorted, 95.0f);
+	summary.P99  = Percentile(sorted, 99.0f);
+	summary.Max  = sorted.back();
+	return summary;
+}
+
+void FrameTimeStats::Print(const std::string& name) const {
+	const Summary summary = Summarize();
+	std::printf("%s: %u frames, ms mean %.3f | p50 %.3f | p90 %.3f | p95 %.3f | p99 %.3f | max %.3f\n",
+		name.c_str(), summary.FrameCount, summary.Mean, summary.P50, summary.P90, summary.P95, summary.P99, summary.Max);
+	std::fflush(stdout);
+}
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <base.h>
+#include <vector>
+
+namespace Enik {
+
+// frame times of a run, summarized as percentiles for benchmarks
+class FrameTimeStats {
+public:
+	struct Summary {
+		uint32_t FrameCount = 0;
+		float Mean = 0.0f;
+		float P50  = 0.0f;
+		float P90  = 0.0f;
+		float P95  = 0.0f;
+		float P99  = 0.0f;
+		float Max  = 0.0f;
+	};
+
+	void Add(float milliseconds) { m_Samples.push_back(milliseconds); }
+	void Clear() { m_Samples.clear(); }
+	uint32_t GetFrameCount() const { return (uint32_t)m_Samples.size(); }
+
+	// nearest rank percentiles, in milliseconds
+	Summary Summarize() const;
+	// to stdout, logging is compiled out of release builds
+	void Print(const std::string& name) const;
+
+private:
+	std::vector<float> m_Samples;
+};
+
+}
@@ -1,28 +1,115 @@
 #include "core/input.h"
 
 #include "application.h"
+#include <array>
 
 namespace Enik {
 
 Scope<Input> Input::s_Instance = CreateScope<Input>();
 
+static constexpr int KEY_COUNT = GLFW_KEY_LAST + 1;
+static constexpr int MOUSE_BUTTON_COUNT = GLFW_MOUSE_BUTTON_LAST + 1;
+
+struct InputState {
+	std::array<bool, KEY_COUNT> Keys{};
+	std::array<bool, MOUSE_BUTTON_COUNT> MouseButtons{};
+	float MouseX = 0.0f;
+	float MouseY = 0.0f;
+};
+// events write the live state, queries read the snapshot taken at the start of the frame
+static InputState s_Live;
+static InputState s_Frame;
+static std::array<bool, KEY_COUNT> s_PreviousKeys{};
+
+static bool IsValidKey(int keycode) {
+	return keycode >= 0 and keycode < KEY_COUNT;
+}
+
 bool Input::IsKeyPressed(int keycode) {
-	GLFWwindow* window = (Application::Get().GetWindow().GetNativeWindow());
-	auto state = glfwGetKey(window, keycode);
-	return ((state == GLFW_PRESS) || (state == GLFW_REPEAT));
+	return IsValidKey(keycode) and s_Frame.Keys[keycode];
+}
+
+bool Input::IsKeyJustPressed(int keycode) {
+	return IsValidKey(keycode) and s_Frame.Keys[keycode] and not s_PreviousKeys[keycode];
+}
+
+bool Input::IsKeyJustReleased(int keycode) {
+	return IsValidKey(keycode) and not s_Frame.Keys[keycode] and s_PreviousKeys[keycode];
 }
 
 bool Input::IsMouseButtonPressed(int button) {
-	GLFWwindow* window = (Application::Get().GetWindow().GetNativeWindow());
-	auto state = glfwGetMouseButton(window, button);
-	return (state == GLFW_PRESS);
+	return button >= 0 and button < MOUSE_BUTTON_COUNT and s_Frame.MouseButtons[button];
 }
 
 std::pair<float, float> Input::GetMousePosition() {
-	GLFWwindow* window = (Application::Get().GetWindow().GetNativeWindow());
+	return { s_Frame.MouseX, s_Frame.MouseY };
+}
+
+void Input::PollWindow() {
+	EN_PROFILE_SCOPE;
+
+	Application& app = Application::Get();
+	GLFWwindow* window = app.GetWindow().GetNativeWindow();
+
+	// NOTE: release events are lost if the window loses focus while a key is down
+	for (int key = 0; key < KEY_COUNT; key++) {
+		if (s_Live.Keys[key] and glfwGetKey(window, key) == GLFW_RELEASE) {
+			KeyReleasedEvent event = KeyReleasedEvent((KeyCode)key);
+			app.OnEvent(event);
+		}
+	}
+	for (int button = 0; button < MOUSE_BUTTON_COUNT; button++) {
+		if (s_Live.MouseButtons[button] and glfwGetMouseButton(window, button) == GLFW_RELEASE) {
+			MouseButtonReleasedEvent event = MouseButtonReleasedEvent((MouseCode)button);
+			app.OnEvent(event);
+		}
+	}
+
 	double mouseX, mouseY;
 	glfwGetCursorPos(window, &mouseX, &mouseY);
-	return {(float)mouseX, (float)mouseY};
+	if ((float)mouseX != s_Live.MouseX or (float)mouseY != s_Live.MouseY) {
+		MouseMovedEvent event = MouseMovedEvent((float)mouseX, (float)mouseY);
+		app.OnEvent(event);
+	}
 }
 
-}
\ No newline at end of file
+void Input::Update() {
+	EN_PROFILE_SCOPE;
+
+	s_PreviousKeys = s_Frame.Keys;
+	s_Frame = s_Live;
+}
+
+void Input::OnEvent(Event& e) {
+	switch (e.GetEventType()) {
+		case EventType::KeyPressed: {
+			int key = static_cast<KeyPressedEvent&>(e).GetKeyCode();
+			if (IsValidKey(key)) { s_Live.Keys[key] = true; }
+			break;
+		}
+		case EventType::KeyReleased: {
+			int key = static_cast<KeyReleasedEvent&>(e).GetKeyCode();
+			if (IsValidKey(key)) { s_Live.Keys[key] = false; }
+			break;
+		}
+		case EventType::MouseButtonPressed: {
+			int button = static_cast<MouseButtonPressedEvent&>(e).GetMouseButton();
+			if (button >= 0 and button < MOUSE_BUTTON_COUNT) { s_Live.MouseButtons[button] = true; }
+			break;
+		}
+		case EventType::MouseButtonReleased: {
+			int button = static_cast<MouseButtonReleasedEvent&>(e).GetMouseButton();
+			if (button >= 0 and button < MOUSE_BUTTON_COUNT) { s_Live.MouseButtons[button] = false; }
+			break;
+		}
+		case EventType::MouseMoved: {
+			auto& moved = static_cast<MouseMovedEvent&>(e);
+			s_Live.MouseX = moved.GetX();
+			s_Live.MouseY = moved.GetY();
+			break;
+		}
+		default: break;
+	}
+}
+
+}
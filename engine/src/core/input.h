@@ -1,17 +1,31 @@
 #pragma once
 
 #include <base.h>
+#include "events/event.h"
 
 namespace Enik {
 
+// key and mouse state is kept from events and snapshotted once per frame,
+// queries do not go through glfw
 class Input {
 public:
 	static bool IsKeyPressed(int keycode);
+	// changed since the last frame
+	static bool IsKeyJustPressed (int keycode);
+	static bool IsKeyJustReleased(int keycode);
+
 	static bool IsMouseButtonPressed(int button);
 	static std::pair<float, float> GetMousePosition();
 
+	// turns state glfw reports but sent no event for into events,
+	// called by Application before Update when there is a window and no replay
+	static void PollWindow();
+	// called by Application at the start of every frame
+	static void Update();
+	static void OnEvent(Event& e);
+
 private:
 	static Scope<Input> s_Instance;
 };
 
-}
\ No newline at end of file
+}
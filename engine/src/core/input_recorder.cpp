@@ -0,0 +1,226 @@
+#include "input_recorder.h"
+
+#include "events/key_event.h"
+#include "events/mouse_event.h"
+
+namespace Enik {
+
+// file: header, then frames of
+// float timestep, uint16 event count, events of uint8 type and a payload for the type.
+// values are in native byte order
+static constexpr char     MAGIC[4] = { 'E', 'N', 'I', 'R' };
+static constexpr uint32_t VERSION  = 1;
+
+struct RecordingHeader {
+	char     Magic[4];
+	uint32_t Version;
+};
+
+InputRecorder::~InputRecorder() {
+	Stop();
+}
+
+bool InputRecorder::StartRecording(const std::filesystem::path& path) {
+	Stop();
+
+	m_Output.open(path, std::ios::binary);
+	if (not m_Output) {
+		EN_CORE_ERROR("Failed to create input recording '{}'", path.string());
+		return false;
+	}
+
+	RecordingHeader header = {};
+	memcpy(header.Magic, MAGIC, sizeof(MAGIC));
+	header.Version = VERSION;
+	m_Output.write((const char*)&header, sizeof(RecordingHeader));
+
+	m_Mode = Mode::RECORD;
+	m_FrameIndex = 0;
+	m_PendingEvents.clear();
+	m_PendingEventCount = 0;
+	EN_CORE_INFO("Recording input to '{}'", path.string());
+	return true;
+}
+
+bool InputRecorder::StartReplay(const std::filesystem::path& path) {
+	Stop();
+
+	m_Input = CreateScope<MappedFile>(path);
+	if (not *m_Input or m_Input->Size() < sizeof(RecordingHeader)) {
+		EN_CORE_ERROR("Failed to open input recording '{}'", path.string());
+		m_Input.reset();
+		return false;
+	}
+
+	const RecordingHeader& header = *(const RecordingHeader*)m_Input->Data();
+	if (memcmp(header.Magic, MAGIC, sizeof(MAGIC)) != 0 or header.Version != VERSION) {
+		EN_CORE_ERROR("'{}' is not an input recording of version {}", path.string(), VERSION);
+		m_Input.reset();
+		return false;
+	}
+
+	m_Mode = Mode::REPLAY;
+	m_FrameIndex = 0;
+	m_ReadOffset = sizeof(RecordingHeader);
+	EN_CORE_INFO("Replaying input from '{}'", path.string());
+	return true;
+}
+
+void InputRecorder::Stop() {
+	if (IsRecording()) {
+		m_Output.close();
+		EN_CORE_INFO("Recorded {} frames of input", m_FrameIndex);
+	}
+	m_Input.reset();
+	m_Mode = Mode::NONE;
+}
+
+template <typename T>
+void InputRecorder::Append(const T& value) {
+	const uint8_t* bytes = (const uint8_t*)&value;
+	m_PendingEvents.insert(m_PendingEvents.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+bool InputRecorder::Read(T& value) {
+	if (m_ReadOffset + sizeof(T) > m_Input->Size()) {
+		return false;
+	}
+	memcpy(&value, m_Input->Data() + m_ReadOffset, sizeof(T));
+	m_ReadOffset += sizeof(T);
+	return true;
+}
+
+void InputRecorder::RecordEvent(Event& e) {
+	if (not IsRecording() or not e.IsInCategory(EventCategoryInput)) {
+		return;
+	}
+
+	const EventType type = e.GetEventType();
+	switch (type) {
+		case EventType::KeyPressed: {
+			auto& pressed = static_cast<KeyPressedEvent&>(e);
+			Append((uint8_t)type);
+			Append(pressed.GetKeyCode());
+			Append((uint8_t)pressed.IsRepeat());
+			break;
+		}
+		case EventType::KeyReleased:
+		case EventType::KeyTyped: {
+			Append((uint8_t)type);
+			Append(static_cast<KeyEvent&>(e).GetKeyCode());
+			break;
+		}
+		case EventType::MouseButtonPressed:
+		case EventType::MouseButtonReleased: {
+			Append((uint8_t)type);
+			Append(static_cast<MouseButtonEvent&>(e).GetMouseButton());
+			break;
+		}
+		case EventType::MouseMoved: {
+			auto& moved = static_cast<MouseMovedEvent&>(e);
+			Append((uint8_t)type);
+			Append(moved.GetX());
+			Append(moved.GetY());
+			break;
+		}
+		case EventType::MouseScrolled: {
+			auto& scrolled = static_cast<MouseScrolledEvent&>(e);
+			Append((uint8_t)type);
+			Append(scrolled.GetXOffset());
+			Append(scrolled.GetYOffset());
+			break;
+		}
+		default: return;
+	}
+	m_PendingEventCount++;
+}
+
+void InputRecorder::RecordFrame(float timestep) {
+	if (not IsRecording()) {
+		return;
+	}
+
+	m_Output.write((const char*)&timestep, sizeof(float));
+	m_Output.write((const char*)&m_PendingEventCount, sizeof(uint16_t));
+	m_Output.write((const char*)m_PendingEvents.data(), m_PendingEvents.size());
+
+	m_PendingEvents.clear();
+	m_PendingEventCount = 0;
+	m_FrameIndex++;
+}
+
+bool InputRecorder::ReplayFrame(float& timestep, const std::function<void(Event&)>& dispatch) {
+	if (not IsReplaying()) {
+		return false;
+	}
+
+	uint16_t event_count = 0;
+	if (not Read(timestep) or not Read(event_count)) {
+		Stop();
+		return false;
+	}
+
+	for (uint16_t i = 0; i < event_count; i++) {
+		uint8_t type = 0;
+		bool valid = Read(type);
+
+		switch ((EventType)type) {
+			case EventType::KeyPressed: {
+				KeyCode key = 0;
+				uint8_t repeat = 0;
+				valid = valid and Read(key) and Read(repeat);
+				if (valid) { KeyPressedEvent event(key, repeat != 0); dispatch(event); }
+				break;
+			}
+			case EventType::KeyReleased: {
+				KeyCode key = 0;
+				valid = valid and Read(key);
+				if (valid) { KeyReleasedEvent event(key); dispatch(event); }
+				break;
+			}
+			case EventType::KeyTyped: {
+				KeyCode key = 0;
+				valid = valid and Read(key);
+				if (valid) { KeyTypedEvent event(key); dispatch(event); }
+				break;
+			}
+			case EventType::MouseButtonPressed: {
+				MouseCode button = 0;
+				valid = valid and Read(button);
+				if (valid) { MouseButtonPressedEvent event(button); dispatch(event); }
+				break;
+			}
+			case EventType::MouseButtonReleased: {
+				MouseCode button = 0;
+				valid = valid and Read(button);
+				if (valid) { MouseButtonReleasedEvent event(button); dispatch(event); }
+				break;
+			}
+			case EventType::MouseMoved: {
+				float x = 0.0f, y = 0.0f;
+				valid = valid and Read(x) and Read(y);
+				if (valid) { MouseMovedEvent event(x, y); dispatch(event); }
+				break;
+			}
+			case EventType::MouseScrolled: {
+				float x = 0.0f, y = 0.0f;
+				valid = valid and Read(x) and Read(y);
+				if (valid) { MouseScrolledEvent event(x, y); dispatch(event); }
+				break;
+			}
+			default: valid = false; break;
+		}
+
+		if (not valid) {
+			EN_CORE_ERROR("Input recording is corrupt at frame {}", m_FrameIndex);
+			Stop();
+			return false;
+		}
+	}
+
+	m_FrameIndex++;
+	return true;
+}
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <base.h>
+#include "core/mapped_file.h"
+#include "events/event.h"
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <vector>
+
+namespace Enik {
+
+// records the input events of every frame with the frame time to a binary file
+// and plays them back, so a run can be repeated exactly.
+// polled input state reaches the recording as events, see Input::PollWindow
+class InputRecorder {
+public:
+	InputRecorder() = default;
+	~InputRecorder();
+
+	bool StartRecording(const std::filesystem::path& path);
+	bool StartReplay   (const std::filesystem::path& path);
+	void Stop();
+
+	bool IsRecording() const { return m_Mode == Mode::RECORD; }
+	bool IsReplaying() const { return m_Mode == Mode::REPLAY; }
+
+	// input events received since the last frame started
+	void RecordEvent(Event& e);
+	// writes the events with the time of the frame they are handled in
+	void RecordFrame(float timestep);
+
+	// dispatches the events of the next frame and gives its time, false once the recording ended
+	bool ReplayFrame(float& timestep, const std::function<void(Event&)>& dispatch);
+	uint32_t GetFrameIndex() const { return m_FrameIndex; }
+
+private:
+	enum class Mode : uint8_t {
+		NONE, RECORD, REPLAY
+	};
+
+	template <typename T>
+	void Append(const T& value);
+	template <typename T>
+	bool Read(T& value);
+
+private:
+	Mode m_Mode = Mode::NONE;
+	uint32_t m_FrameIndex = 0;
+
+	std::ofstream m_Output;
+	std::vector<uint8_t> m_PendingEvents;
+	uint16_t m_PendingEventCount = 0;
+
+	Scope<MappedFile> m_Input;
+	uint64_t m_ReadOffset = 0;
+};
+
+}
@@ -0,0 +1,234 @@
+#include "job_system.h"
+#include "core/application.h"
+
+namespace Enik {
+
+static thread_local int32_t s_WorkerIndex = -1;
+
+JobSystem::JobSystem(uint32_t worker_count) {
+	if (worker_count == 0) {
+		uint32_t hardware = std::thread::hardware_concurrency();
+		worker_count = hardware > 1 ? hardware - 1 : 1;
+	}
+
+	m_Workers.reserve(worker_count);
+	for (uint32_t i = 0; i < worker_count; i++) {
+		m_Workers.push_back(CreateScope<Worker>());
+	}
+	for (uint32_t i = 0; i < worker_count; i++) {
+		m_Workers[i]->Thread = std::thread(&JobSystem::WorkerLoop, this, i);
+	}
+}
+
+JobSystem::~JobSystem() {
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_Running = false;
+	}
+	m_SleepCondition.notify_all();
+
+	for (auto& worker : m_Workers) {
+		if (worker->Thread.joinable()) {
+			worker->Thread.join();
+		}
+	}
+}
+
+bool JobSystem::IsWorkerThread() {
+	return s_WorkerIndex >= 0;
+}
+
+void JobSystem::Submit(Job job, JobCounter* counter) {
+	if (counter) {
+		counter->Count.fetch_add(1, std::memory_order_relaxed);
+	}
+	Enqueue(std::move(job), counter);
+}
+
+void JobSystem::Enqueue(Job job, JobCounter* counter) {
+	// jobs submitted from a worker stay on its own queue
+	uint32_t index = s_WorkerIndex >= 0
+		? (uint32_t)s_WorkerIndex
+		: m_NextQueue.fetch_add(1, std::memory_order_relaxed) % m_Workers.size();
+
+	{
+		Worker& worker = *m_Workers[index];
+		std::lock_guard<std::mutex> lock(worker.Mutex);
+		worker.Queue.push_back({ std::move(job), counter });
+	}
+	m_QueuedTasks.fetch_add(1, std::memory_order_release);
+
+	{
+		// NOTE: prevents a lost wakeup between the sleep check and the wait
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+	}
+	m_SleepCondition.notify_one();
+}
+
+void JobSystem::SubmitAfter(JobCounter& dependency, Job job, JobCounter* counter) {
+	{
+		std::lock_guard<std::mutex> lock(dependency.Mutex);
+		if (not dependency.IsDone()) {
+			if (counter) {
+				counter->Count.fetch_add(1, std::memory_order_relaxed);
+			}
+			dependency.Continuations.emplace_back(std::move(job), counter);
+			return;
+		}
+	}
+	Submit(std::move(job), counter);
+}
+
+void JobSystem::SubmitAfter(std::initializer_list<JobCounter*> dependencies, Job job, JobCounter* counter) {
+	if (dependencies.size() == 0) {
+		Submit(std::move(job), counter);
+		return;
+	}
+	if (dependencies.size() == 1) {
+		SubmitAfter(**dependencies.begin(), std::move(job), counter);
+		return;
+	}
+
+	// last finished dependency submits the job
+	auto remaining = CreateRef<std::atomic<uint32_t>>((uint32_t)dependencies.size());
+	auto shared_job = CreateRef<Job>(std::move(job));
+	if (counter) {
+		counter->Count.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	for (JobCounter* dependency : dependencies) {
+		SubmitAfter(*dependency, [this, remaining, shared_job, counter]() {
+			if (remaining->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				Enqueue(std::move(*shared_job), counter);
+			}
+		});
+	}
+}
+
+void JobSystem::ContinueOnMainThread(JobCounter& dependency, Job job) {
+	SubmitAfter(dependency, [job = std::move(job)]() {
+		Application::Get().SubmitToMainThread(job);
+	});
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t batch_size, const std::function<void(uint32_t begin, uint32_t end)>& function) {
+	if (count == 0) {
+		return;
+	}
+	batch_size = std::max(batch_size, 1u);
+	if (count <= batch_size) {
+		function(0, count);
+		return;
+	}
+
+	JobCounter counter;
+	for (uint32_t begin = batch_size; begin < count; begin += batch_size) {
+		uint32_t end = std::min(begin + batch_size, count);
+		Submit([&function, begin, end]() { function(begin, end); }, &counter);
+	}
+	function(0, batch_size);
+	Wait(counter);
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+	Task task;
+	while (not counter.IsDone()) {
+		if (PopTask(s_WorkerIndex, task)) {
+			Execute(task);
+		} else {
+			std::this_thread::yield();
+		}
+	}
+
+	// NOTE: the thread that finished the last job might still be holding the lock,
+	// counter is usually destroyed right after this returns
+	std::lock_guard<std::mutex> lock(counter.Mutex);
+}
+
+bool JobSystem::PopTask(int32_t index, Task& task) {
+	const uint32_t count = (uint32_t)m_Workers.size();
+
+	// own queue first, newest task is the most likely to be in cache
+	if (index >= 0) {
+		Worker& worker = *m_Workers[index];
+		std::lock_guard<std::mutex> lock(worker.Mutex);
+		if (not worker.Queue.empty()) {
+			task = std::move(worker.Queue.back());
+			worker.Queue.pop_back();
+			m_QueuedTasks.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	// steal the oldest task from someone else
+	uint32_t start = index >= 0 ? (uint32_t)index + 1 : 0;
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t victim = (start + i) % count;
+		if ((int32_t)victim == index) {
+			continue;
+		}
+
+		Worker& worker = *m_Workers[victim];
+		std::lock_guard<std::mutex> lock(worker.Mutex);
+		if (not worker.Queue.empty()) {
+			task = std::move(worker.Queue.front());
+			worker.Queue.pop_front();
+			m_QueuedTasks.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::Execute(Task& task) {
+	task.Function();
+	task.Function = nullptr;
+	if (task.Counter) {
+		Finish(*task.Counter);
+	}
+}
+
+void JobSystem::Finish(JobCounter& counter) {
+	// jobs that are not the last one leave without touching the lock
+	uint32_t count = counter.Count.load(std::memory_order_relaxed);
+	while (count > 1) {
+		if (counter.Count.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+			return;
+		}
+	}
+
+	// the last one takes the lock, SubmitAfter and Wait rely on it
+	std::vector<std::pair<std::function<void()>, JobCounter*>> continuations;
+	{
+		std::lock_guard<std::mutex> lock(counter.Mutex);
+		if (counter.Count.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+			return;
+		}
+		continuations.swap(counter.Continuations);
+	}
+
+	// counter was already reserved by SubmitAfter
+	for (auto& [job, job_counter] : continuations) {
+		Enqueue(std::move(job), job_counter);
+	}
+}
+
+void JobSystem::WorkerLoop(uint32_t index) {
+	s_WorkerIndex = (int32_t)index;
+
+	Task task;
+	while (m_Running) {
+		if (PopTask(index, task)) {
+			Execute(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_SleepCondition.wait(lock, [this]() {
+			return not m_Running or m_QueuedTasks.load(std::memory_order_acquire) > 0;
+		});
+	}
+}
+
+}
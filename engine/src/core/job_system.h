@@ -0,0 +1,90 @@
+#pragma once
+
+#include <base.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Enik {
+
+// counts unfinished jobs, JobSystem::Wait blocks until it reaches zero
+struct JobCounter {
+	std::atomic<uint32_t> Count = 0;
+
+	bool IsDone() const { return Count.load(std::memory_order_acquire) == 0; }
+
+private:
+	// jobs submitted with SubmitAfter, queued once Count reaches zero
+	std::mutex Mutex;
+	std::vector<std::pair<std::function<void()>, JobCounter*>> Continuations;
+
+	friend class JobSystem;
+};
+
+// every worker owns a queue, it pushes and pops from the back,
+// idle workers steal from the front of other queues
+class JobSystem {
+public:
+	using Job = std::function<void()>;
+
+	// 0 means hardware_concurrency - 1, main thread also executes jobs while waiting
+	JobSystem(uint32_t worker_count = 0);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	void Submit(Job job, JobCounter* counter = nullptr);
+
+	// job is queued after every dependency is done
+	void SubmitAfter(JobCounter& dependency, Job job, JobCounter* counter = nullptr);
+	void SubmitAfter(std::initializer_list<JobCounter*> dependencies, Job job, JobCounter* counter = nullptr);
+
+	// job runs on the main thread, at the start of the frame after the dependency is done
+	void ContinueOnMainThread(JobCounter& dependency, Job job);
+
+	// splits [0, count) into batches of batch_size, calling thread takes part,
+	// returns when every batch is done
+	void ParallelFor(uint32_t count, uint32_t batch_size, const std::function<void(uint32_t begin, uint32_t end)>& function);
+
+	// executes queued jobs on the calling thread until counter is done,
+	// a counter must not be destroyed before waiting on it
+	void Wait(JobCounter& counter);
+
+	uint32_t GetWorkerCount() const { return (uint32_t)m_Workers.size(); }
+
+	static bool IsWorkerThread();
+
+private:
+	struct Task {
+		Job Function;
+		JobCounter* Counter = nullptr;
+	};
+
+	struct Worker {
+		std::thread Thread;
+		std::deque<Task> Queue;
+		std::mutex Mutex;
+	};
+
+	void Enqueue(Job job, JobCounter* counter);
+	void Finish(JobCounter& counter);
+	void WorkerLoop(uint32_t index);
+	bool PopTask(int32_t index, Task& task);
+	void Execute(Task& task);
+
+private:
+	std::vector<Scope<Worker>> m_Workers;
+
+	std::atomic<uint32_t> m_NextQueue = 0;
+	std::atomic<uint32_t> m_QueuedTasks = 0;
+	std::atomic<bool> m_Running = true;
+
+	std::mutex m_SleepMutex;
+	std::condition_variable m_SleepCondition;
+};
+
+}
@@ -0,0 +1,83 @@
+#include "mapped_file.h"
+
+#ifdef EN_PLATFORM_LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif defined(EN_PLATFORM_WINDOWS)
+#include <windows.h>
+#endif
+
+namespace Enik {
+
+#ifdef EN_PLATFORM_LINUX
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) == 0 and info.st_size > 0) {
+		void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data != MAP_FAILED) {
+			m_Data = (const uint8_t*)data;
+			m_Size = (uint64_t)info.st_size;
+		}
+	}
+
+	// NOTE: the mapping stays valid after the descriptor is closed
+	close(fd);
+}
+
+MappedFile::~MappedFile() {
+	if (m_Data) {
+		munmap((void*)m_Data, (size_t)m_Size);
+	}
+}
+
+#elif defined(EN_PLATFORM_WINDOWS)
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	m_File = file;
+
+	LARGE_INTEGER size;
+	if (not GetFileSizeEx(file, &size) or size.QuadPart == 0) {
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		return;
+	}
+	m_Mapping = mapping;
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (data) {
+		m_Data = (const uint8_t*)data;
+		m_Size = (uint64_t)size.QuadPart;
+	}
+}
+
+MappedFile::~MappedFile() {
+	if (m_Data) {
+		UnmapViewOfFile(m_Data);
+	}
+	if (m_Mapping) {
+		CloseHandle((HANDLE)m_Mapping);
+	}
+	if (m_File) {
+		CloseHandle((HANDLE)m_File);
+	}
+}
+
+#endif
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <base.h>
+
+#include <filesystem>
+
+namespace Enik {
+
+// read only view of a whole file, pages are loaded by the os on first access
+class MappedFile {
+public:
+	MappedFile(const std::filesystem::path& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const uint8_t* Data() const { return m_Data; }
+	uint64_t Size() const { return m_Size; }
+
+	operator bool() const { return m_Data != nullptr; }
+
+private:
+	const uint8_t* m_Data = nullptr;
+	uint64_t m_Size = 0;
+
+#ifdef EN_PLATFORM_WINDOWS
+	void* m_File = nullptr;
+	void* m_Mapping = nullptr;
+#endif
+};
+
+}
@@ -16,4 +16,20 @@ UUID::UUID(uint64_t uuid)
 	: m_UUID(uuid) {
 }
 
+void UUID::Seed(uint64_t seed) {
+	s_Engine.seed(seed);
+}
+
+void UUID::Reseed() {
+	s_Engine.seed(s_RandomDevice());
+}
+
+// splitmix64 finalizer, nearby inputs give unrelated uuids
+UUID UUID::Derive(uint64_t base, uint64_t key) {
+	uint64_t value = base ^ (key + 0x9e3779b97f4a7c15ull + (base << 6) + (base >> 2));
+	value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+	value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+	return UUID(value ^ (value >> 31));
+}
+
 }
\ No newline at end of file
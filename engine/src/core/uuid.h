@@ -13,6 +13,14 @@ public:
 
 	operator uint64_t() const { return m_UUID; }
 
+	// deterministic runs generate the same uuids every time
+	static void Seed(uint64_t seed);
+	// back to random uuids
+	static void Reseed();
+
+	// the same for the same inputs, whatever the generator's state
+	static UUID Derive(uint64_t base, uint64_t key);
+
 private:
 	uint64_t m_UUID;
 };
@@ -1,11 +1,13 @@
 #include "physics.h"
 
+#include "core/application.h"
 #include "core/log.h"
+#include "physics/physics_query.h"
 #include "physics/raycast.h"
+#include "project/project.h"
 #include "scene/components.h"
 #include "scene/entity.h"
 #include "scene/scriptable_entity.h"
-#include "script_system/extern_functions.h"
 
 #include "Jolt/Math/MathTypes.h"
 #include "Jolt/Math/Real.h"
@@ -19,59 +21,86 @@
 #include "Jolt/Physics/Collision/CollisionCollectorImpl.h"
 #include "Jolt/Physics/Collision/ObjectLayer.h"
 #include "Jolt/Physics/Collision/RayCast.h"
+#include "Jolt/Physics/Collision/ShapeCast.h"
+#include "Jolt/Physics/Collision/CollideShape.h"
+#include "Jolt/Physics/Collision/Shape/BoxShape.h"
+#include "Jolt/Physics/Collision/Shape/SphereShape.h"
 #include "Jolt/Physics/EActivation.h"
 #include "script_system/script_system.h"
 #include <Jolt/Core/Factory.h>
 #include <Jolt/Physics/Body/BodyActivationListener.h>
 #include <Jolt/Physics/Body/BodyCreationSettings.h>
-#include <Jolt/Physics/Collision/Shape/BoxShape.h>
-#include <Jolt/Physics/Collision/Shape/SphereShape.h>
 #include <Jolt/Physics/PhysicsSettings.h>
 #include <Jolt/RegisterTypes.h>
+#include <unordered_set>
 
 namespace Enik {
 using namespace JPH;
 
-// Layer that objects can be in, determines which other objects it can collide with
-// Typically you at least want to have 1 layer for moving bodies and 1 layer for static bodies, but you can have more
-// layers if you want. E.g. you could have a layer for high detail collision (which is not used by the physics simulation
-// but only if you do collision testing).
-namespace Layers
+// Object layers are derived from Component::PhysicsBodyBase::Layer and the broadphase the body belongs to,
+// (layer << 2) | broadphase. The collision layers and their masks come from the project config.
+// Each broadphase layer results in a separate bounding volume tree in the broad phase. Static bodies get their own
+// tree so it is never updated, sensors get their own so queries against them stay cheap. Pairs of layers that
+// never collide are rejected before any tree is tested.
+namespace BroadPhaseLayers
 {
-	static constexpr ObjectLayer NON_MOVING = 0;
-	static constexpr ObjectLayer MOVING = 1;
-	static constexpr ObjectLayer NUM_LAYERS = 2;
+	static constexpr BroadPhaseLayer NON_MOVING(0);
+	static constexpr BroadPhaseLayer MOVING(1);
+	static constexpr BroadPhaseLayer SENSOR(2);
+	static constexpr uint NUM_LAYERS(3);
+};
+
+static constexpr ObjectLayer BROADPHASE_BITS = 2;
+static constexpr ObjectLayer BROADPHASE_MASK = (1 << BROADPHASE_BITS) - 1;
+
+static ObjectLayer MakeObjectLayer(uint16_t layer, BroadPhaseLayer broadphase) {
+	return (ObjectLayer)((layer << BROADPHASE_BITS) | (BroadPhaseLayer::Type)broadphase);
+}
+static uint16_t GetCollisionLayer(ObjectLayer layer) {
+	return layer >> BROADPHASE_BITS;
+}
+static BroadPhaseLayer GetBroadPhase(ObjectLayer layer) {
+	return BroadPhaseLayer((BroadPhaseLayer::Type)(layer & BROADPHASE_MASK));
+}
+
+// symmetric collision masks of the project layers
+struct PhysicsLayerTable {
+	uint16_t Count = 0;
+	uint16_t CollidesWith[MAX_PHYSICS_LAYERS] = {};
+
+	PhysicsLayerTable(const std::vector<PhysicsLayerConfig>& layers) {
+		Count = (uint16_t)std::min<size_t>(layers.size(), MAX_PHYSICS_LAYERS);
+		for (uint16_t a = 0; a < Count; a++) {
+			for (uint16_t b = 0; b < Count; b++) {
+				if ((layers[a].collides_with & (1 << b)) and (layers[b].collides_with & (1 << a))) {
+					CollidesWith[a] |= 1 << b;
+				}
+			}
+		}
+	}
+
+	bool ShouldCollide(uint16_t a, uint16_t b) const {
+		return a < Count and (CollidesWith[a] & (1 << b));
+	}
 };
 
 /// Class that determines if two object layers can collide
 class ObjectLayerPairFilterImpl : public ObjectLayerPairFilter
 {
 public:
+	ObjectLayerPairFilterImpl(const PhysicsLayerTable& table) : m_Table(table) {}
+
 	virtual bool	ShouldCollide(ObjectLayer inObject1, JPH::ObjectLayer inObject2) const override
 	{
-		switch (inObject1)
-		{
-		case Layers::NON_MOVING:
-			return inObject2 == Layers::MOVING; // Non moving only collides with moving
-		case Layers::MOVING:
-			return true; // Moving collides with everything
-		default:
-			JPH_ASSERT(false);
+		// non moving only collides with moving
+		if (GetBroadPhase(inObject1) == BroadPhaseLayers::NON_MOVING and GetBroadPhase(inObject2) == BroadPhaseLayers::NON_MOVING) {
 			return false;
 		}
+		return m_Table.ShouldCollide(GetCollisionLayer(inObject1), GetCollisionLayer(inObject2));
 	}
-};
 
-// Each broadphase layer results in a separate bounding volume tree in the broad phase. You at least want to have
-// a layer for non-moving and moving objects to avoid having to update a tree full of static objects every frame.
-// You can have a 1-on-1 mapping between object layers and broadphase layers (like in this case) but if you have
-// many object layers you'll be creating many broad phase trees, which is not efficient. If you want to fine tune
-// your broadphase layers define JPH_TRACK_BROADPHASE_STATS and look at the stats reported on the TTY.
-namespace BroadPhaseLayers
-{
-	static constexpr BroadPhaseLayer NON_MOVING(0);
-	static constexpr BroadPhaseLayer MOVING(1);
-	static constexpr uint NUM_LAYERS(2);
+private:
+	PhysicsLayerTable m_Table;
 };
 
 // BroadPhaseLayerInterface implementation
@@ -79,13 +108,6 @@ namespace BroadPhaseLayers
 class BPLayerInterfaceImpl final : public BroadPhaseLayerInterface
 {
 public:
-									BPLayerInterfaceImpl()
-	{
-		// Create a mapping table from object to broad phase layer
-		mObjectToBroadPhase[Layers::NON_MOVING] = BroadPhaseLayers::NON_MOVING;
-		mObjectToBroadPhase[Layers::MOVING] = BroadPhaseLayers::MOVING;
-	}
-
 	virtual uint					GetNumBroadPhaseLayers() const override
 	{
 		return BroadPhaseLayers::NUM_LAYERS;
@@ -93,8 +115,8 @@ public:
 
 	virtual BroadPhaseLayer			GetBroadPhaseLayer(JPH::ObjectLayer inLayer) const override
 	{
-		JPH_ASSERT(inLayer < Layers::NUM_LAYERS);
-		return mObjectToBroadPhase[inLayer];
+		JPH_ASSERT((inLayer & BROADPHASE_MASK) < BroadPhaseLayers::NUM_LAYERS);
+		return GetBroadPhase(inLayer);
 	}
 
 #if defined(JPH_EXTERNAL_PROFILE) || defined(JPH_PROFILE_ENABLED)
@@ -104,125 +126,321 @@ public:
 		{
 		case (BroadPhaseLayer::Type)BroadPhaseLayers::NON_MOVING:	return "NON_MOVING";
 		case (BroadPhaseLayer::Type)BroadPhaseLayers::MOVING:		return "MOVING";
+		case (BroadPhaseLayer::Type)BroadPhaseLayers::SENSOR:		return "SENSOR";
 		default:													JPH_ASSERT(false); return "INVALID";
 		}
 	}
 #endif // JPH_EXTERNAL_PROFILE || JPH_PROFILE_ENABLED
-
-private:
-	BroadPhaseLayer					mObjectToBroadPhase[Layers::NUM_LAYERS];
 };
 
 /// Class that determines if an object layer can collide with a broadphase layer
 class ObjectVsBroadPhaseLayerFilterImpl : public ObjectVsBroadPhaseLayerFilter
 {
 public:
+	ObjectVsBroadPhaseLayerFilterImpl(const PhysicsLayerTable& table) : m_Table(table) {}
+
 	virtual bool				ShouldCollide(ObjectLayer inLayer1, JPH::BroadPhaseLayer inLayer2) const override
 	{
-		switch (inLayer1)
-		{
-		case Layers::NON_MOVING:
-			return inLayer2 == BroadPhaseLayers::MOVING;
-		case Layers::MOVING:
-			return true;
-		default:
-			JPH_ASSERT(false);
+		if (GetBroadPhase(inLayer1) == BroadPhaseLayers::NON_MOVING and inLayer2 == BroadPhaseLayers::NON_MOVING) {
 			return false;
 		}
+		// a tree is only tested when it holds a layer the mask collides with
+		const uint16_t layer = GetCollisionLayer(inLayer1);
+		const uint16_t tree_layers = m_TreeLayers[(BroadPhaseLayer::Type)inLayer2].load(std::memory_order_relaxed);
+		return layer < m_Table.Count and (m_Table.CollidesWith[layer] & tree_layers) != 0;
 	}
+
+	// called for every body created, layers are never taken out of a tree again
+	void AddTreeLayer(ObjectLayer inLayer)
+	{
+		m_TreeLayers[(BroadPhaseLayer::Type)GetBroadPhase(inLayer)].fetch_or(1 << GetCollisionLayer(inLayer), std::memory_order_relaxed);
+	}
+
+private:
+	PhysicsLayerTable m_Table;
+	std::atomic<uint16_t> m_TreeLayers[BroadPhaseLayers::NUM_LAYERS] = {};
 };
 
+// runs on jolt's worker threads, only reads the body table and appends events
 class MyContactListener : public ContactListener {
 public:
+	MyContactListener(Physics& physics) : m_Physics(physics) {}
+
 	virtual void OnContactAdded(const Body &inBody1, const JPH::Body &inBody2, const JPH::ContactManifold &inManifold, JPH::ContactSettings &ioSettings) override {
-		ScriptSystem::GetPhysicsContext().DeferOnEnter(inBody1, inBody2);
+		m_Physics.m_step_contacts.fetch_add(1, std::memory_order_relaxed);
+
+		const RVec3 point = inManifold.mRelativeContactPointsOn1.empty()
+			? inManifold.mBaseOffset
+			: inManifold.GetWorldSpaceContactPointOn1(0);
+		const Vec3& normal = inManifold.mWorldSpaceNormal;
+
+		ContactEvent event;
+		event.A = m_Physics.GetBodyEntity(inBody1.GetID()).Entity;
+		event.B = m_Physics.GetBodyEntity(inBody2.GetID()).Entity;
+		event.Enter  = true;
+		event.Sensor = inBody1.IsSensor() or inBody2.IsSensor();
+		event.Point  = glm::vec3(point.GetX(), point.GetY(), point.GetZ());
+		event.Normal = glm::vec3(normal.GetX(), normal.GetY(), normal.GetZ());
+		m_Physics.PushContactEvent(event);
+	}
+
+	virtual void OnContactPersisted(const Body &inBody1, const JPH::Body &inBody2, const JPH::ContactManifold &inManifold, JPH::ContactSettings &ioSettings) override {
+		m_Physics.m_step_contacts.fetch_add(1, std::memory_order_relaxed);
 	}
 
+	// the bodies may already be destroyed, the table still knows their entities
 	virtual void OnContactRemoved(const SubShapeIDPair &inSubShapePair) override {
-		ScriptSystem::GetPhysicsContext().DeferOnExit(inSubShapePair.GetBody1ID(), inSubShapePair.GetBody2ID());
+		const Physics::BodyEntity& a = m_Physics.GetBodyEntity(inSubShapePair.GetBody1ID());
+		const Physics::BodyEntity& b = m_Physics.GetBodyEntity(inSubShapePair.GetBody2ID());
+
+		ContactEvent event;
+		event.A = a.Entity;
+		event.B = b.Entity;
+		event.Enter  = false;
+		event.Sensor = a.Sensor or b.Sensor;
+		m_Physics.PushContactEvent(event);
 	}
+
+private:
+	Physics& m_Physics;
 };
 
+// called when jolt wakes or puts a body to sleep, also from worker threads
+class MyBodyActivationListener : public BodyActivationListener {
+public:
+	MyBodyActivationListener(Physics& physics) : m_Physics(physics) {}
+
+	virtual void OnBodyActivated(const BodyID& inBodyID, uint64 inBodyUserData) override {
+		m_Physics.PushActivationChange(inBodyID, true);
+	}
+
+	virtual void OnBodyDeactivated(const BodyID& inBodyID, uint64 inBodyUserData) override {
+		m_Physics.PushActivationChange(inBodyID, false);
+	}
+
+private:
+	Physics& m_Physics;
+};
+
+static constexpr uint32_t CONTACT_EVENT_CAPACITY = 1024;
+static constexpr int DETERMINISTIC_PHYSICS_CONCURRENCY = 4;
+
+// start growing before jolt refuses to create bodies
+static constexpr float GROW_THRESHOLD = 0.9f;
 
-void Physics::DeferOnExit(JPH::BodyID a, JPH::BodyID b) {
-	std::lock_guard<std::mutex> lock(m_DeferredOnExitMutex);
-	m_DeferredOnExits.emplace_back(a,b);
+static uint32_t NextPowerOfTwo(uint32_t value) {
+	uint32_t result = 1;
+	while (result < value) {
+		result <<= 1;
+	}
+	return result;
 }
 
-void Physics::DeferOnEnter(const JPH::Body& a, const JPH::Body& b) {
-	std::lock_guard<std::mutex> lock(m_DeferredOnEnterMutex);
-	m_DeferredOnEnters.emplace_back(&a,&b);
+// pairs and contact constraints keep their ratio to the body count
+static void GrowBodyCapacity(PhysicsCapacityConfig& capacity, uint32_t max_bodies) {
+	const uint32_t ratio_pairs       = std::max<uint32_t>(capacity.max_body_pairs / capacity.max_bodies, 1);
+	const uint32_t ratio_constraints = std::max<uint32_t>(capacity.max_contact_constraints / capacity.max_bodies, 1);
+
+	capacity.max_bodies = max_bodies;
+	capacity.max_body_pairs          = std::max(capacity.max_body_pairs,          max_bodies * ratio_pairs);
+	capacity.max_contact_constraints = std::max(capacity.max_contact_constraints, max_bodies * ratio_constraints);
 }
 
-void Physics::ProcessDeferredOnExitSignals() {
-	for (auto pair : m_DeferredOnExits) {
-		auto& bi = m_PhysicsSystem->GetBodyInterface();
-		Entity e1 = FindEntityByUUID(bi.GetUserData(pair.first));
-		Entity e2 = FindEntityByUUID(bi.GetUserData(pair.second));
 
-		if (!e1 || !e2) { return; }
+const Physics::BodyEntity& Physics::GetBodyEntity(const JPH::BodyID& id) const {
+	static const BodyEntity s_None;
+	const uint32_t index = id.GetIndex();
+	return index < m_body_entities.size() ? m_body_entities[index] : s_None;
+}
 
-		bool is_sensor =   (e1.Has<Component::CollisionBody>() && e1.Get<Component::CollisionBody>().IsSensor)
-						|| (e2.Has<Component::CollisionBody>() && e2.Get<Component::CollisionBody>().IsSensor);
+void Physics::SetBodyEntity(const JPH::BodyID& id, entt::entity entity, bool sensor) {
+	const uint32_t index = id.GetIndex();
+	if (index >= m_body_entities.size()) {
+		m_body_entities.resize(index + 1);
+	}
+	// the active slot belongs to the index, a deactivation of the previous body may still be queued
+	m_body_entities[index].Entity = entity;
+	m_body_entities[index].Sensor = sensor;
 
-		if (e1.Has<Component::NativeScript>()) {
-			if (ScriptableEntity* se = e1.GetScriptInstance()) {
-				if (is_sensor) {
-					se->OnSensorExit(e2);
-				} else {
-					se->OnCollisionExit(e2);
-				}
-			}
+	if (index >= m_body_motions.size()) {
+		m_body_motions.resize(index + 1);
+	}
+	// a reused index must not interpolate from the previous body
+	m_body_motions[index].Step = 0;
+}
+
+void Physics::PushActivationChange(const JPH::BodyID& id, bool active) {
+	std::lock_guard<std::mutex> lock(m_activation_mutex);
+	m_activation_changes.emplace_back(id, active);
+}
+
+void Physics::ApplyActivationChanges() {
+	{
+		std::lock_guard<std::mutex> lock(m_activation_mutex);
+		m_activation_changes.swap(m_applied_activation_changes);
+	}
+	m_fell_asleep.clear();
+
+	for (const auto& [id, active] : m_applied_activation_changes) {
+		const uint32_t index = id.GetIndex();
+		if (index >= m_body_entities.size()) {
+			m_body_entities.resize(index + 1);
 		}
-		if (e2.Has<Component::NativeScript>()) {
-			if (ScriptableEntity* se = e2.GetScriptInstance()) {
-				if (is_sensor) {
-					se->OnSensorExit(e1);
-				} else {
-					se->OnCollisionExit(e1);
-				}
+		uint32_t& slot = m_body_entities[index].ActiveSlot;
+
+		if (active) {
+			if (slot == BodyEntity::INACTIVE) {
+				slot = (uint32_t)m_active_bodies.size();
+				m_active_bodies.push_back(id);
+			} else {
+				m_active_bodies[slot] = id;
 			}
 		}
+		else if (slot != BodyEntity::INACTIVE and m_active_bodies[slot] == id) {
+			// swap with the last one
+			const BodyID last = m_active_bodies.back();
+			m_active_bodies[slot] = last;
+			m_body_entities[last.GetIndex()].ActiveSlot = slot;
+			m_active_bodies.pop_back();
+			slot = BodyEntity::INACTIVE;
+
+			// its last step moved it
+			m_fell_asleep.push_back(id);
+		}
+	}
+	m_applied_activation_changes.clear();
+}
+
+void Physics::ClearActiveBodies() {
+	for (BodyEntity& body : m_body_entities) {
+		body.ActiveSlot = BodyEntity::INACTIVE;
 	}
-	m_DeferredOnExits.clear();
+	m_active_bodies.clear();
+	m_fell_asleep.clear();
+	std::lock_guard<std::mutex> lock(m_activation_mutex);
+	m_activation_changes.clear();
 }
 
-void Physics::ProcessDeferredOnEnterSignals() {
-	for (auto pair : m_DeferredOnEnters) {
-		Entity e1 = FindEntityByUUID(pair.first->GetUserData());
-		Entity e2 = FindEntityByUUID(pair.second->GetUserData());
+void Physics::PushContactEvent(const ContactEvent& event) {
+	const uint32_t index = m_contact_event_count.fetch_add(1, std::memory_order_relaxed);
+	if (index < m_contact_events.size()) {
+		m_contact_events[index] = event;
+		return;
+	}
+	// rare, the buffer grows after the step
+	std::lock_guard<std::mutex> lock(m_contact_overflow_mutex);
+	m_contact_overflow.push_back(event);
+}
 
-		if (!e1 || !e2) { return; }
+void Physics::ProcessContactEvents() {
+	EN_PROFILE_SECTION("Physics::ProcessContactEvents");
 
-		bool is_sensor =   (e1.Has<Component::CollisionBody>() && e1.Get<Component::CollisionBody>().IsSensor)
-						|| (e2.Has<Component::CollisionBody>() && e2.Get<Component::CollisionBody>().IsSensor);
+	const uint32_t pushed = m_contact_event_count.exchange(0, std::memory_order_relaxed);
+	const uint32_t count = std::min<uint32_t>(pushed, (uint32_t)m_contact_events.size());
+	if (count == 0 and m_contact_overflow.empty()) {
+		return;
+	}
 
-		if (e1.Has<Component::NativeScript>()) {
-			if (ScriptableEntity* se = e1.GetScriptInstance()) {
-				if (is_sensor) {
-					se->OnSensorEnter(e2);
-				} else {
-					se->OnCollisionEnter(e2);
-				}
+	// key order pairs the events up and makes the callback order independent of the worker threads
+	std::vector<std::pair<uint64_t, const ContactEvent*>> events;
+	events.reserve(count + m_contact_overflow.size());
+	auto add = [&](ContactEvent& event) {
+		if (event.B < event.A) {
+			std::swap(event.A, event.B);
+			event.Normal = -event.Normal;
+		}
+		const uint64_t key = ((uint64_t)entt::to_integral(event.A) << 32) | entt::to_integral(event.B);
+		events.emplace_back(key, &event);
+	};
+	for (uint32_t i = 0; i < count; i++) {
+		add(m_contact_events[i]);
+	}
+	for (ContactEvent& event : m_contact_overflow) {
+		add(event);
+	}
+	std::stable_sort(events.begin(), events.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+	// a pair touches with one or more sub shapes, enter and exit are reported once per pair
+	std::vector<const ContactEvent*> enters;
+	std::vector<const ContactEvent*> exits;
+	for (size_t i = 0; i < events.size();) {
+		const uint64_t key = events[i].first;
+		const ContactEvent* first_enter = nullptr;
+		const ContactEvent* last = nullptr;
+		int32_t delta = 0;
+		for (; i < events.size() and events[i].first == key; i++) {
+			const ContactEvent* event = events[i].second;
+			if (event->Enter and first_enter == nullptr) {
+				first_enter = event;
 			}
+			delta += event->Enter ? 1 : -1;
+			last = event;
 		}
-		if (e2.Has<Component::NativeScript>()) {
-			if (ScriptableEntity* se = e2.GetScriptInstance()) {
-				if (is_sensor) {
-					se->OnSensorEnter(e1);
-				} else {
-					se->OnCollisionEnter(e1);
-				}
+
+		auto it = m_contact_pairs.find(key);
+		const int32_t before = it != m_contact_pairs.end() ? (int32_t)it->second : 0;
+		const int32_t after  = std::max(before + delta, 0);
+		if (after == 0) {
+			if (it != m_contact_pairs.end()) {
+				m_contact_pairs.erase(it);
 			}
 		}
-	}
-	m_DeferredOnEnters.clear();
-}
+		else {
+			m_contact_pairs[key] = (uint32_t)after;
+		}
 
+		if (before == 0 and after > 0) {
+			enters.push_back(first_enter ? first_enter : last);
+		}
+		else if (before > 0 and after == 0) {
+			exits.push_back(last);
+		}
+	}
 
+	for (const ContactEvent* event : exits) {
+		DispatchContactEvent(*event, false);
+	}
+	for (const ContactEvent* event : enters) {
+		DispatchContactEvent(*event, true);
+	}
+	m_contact_overflow.clear();
 
+	// grown only after dispatch, enters and exits point into the buffer
+	if (pushed > m_contact_events.size()) {
+		const uint32_t capacity = NextPowerOfTwo(pushed);
+		EN_CORE_WARN("Physics contact buffer full ({} events), growing to {}", pushed, capacity);
+		m_contact_events.resize(capacity);
+	}
+}
 
+void Physics::DispatchContactEvent(const ContactEvent& event, bool enter) {
+	auto dispatch = [&](entt::entity self_handle, entt::entity other_handle, const glm::vec3& normal) {
+		// a callback can destroy either entity
+		if (not m_Registry->valid(self_handle) or not m_Registry->valid(other_handle)) {
+			return;
+		}
+		Entity self  = Entity(self_handle,  m_Scene);
+		Entity other = Entity(other_handle, m_Scene);
+		if (not self.Has<Component::NativeScript>()) {
+			return;
+		}
+		ScriptableEntity* se = self.GetScriptInstance();
+		if (se == nullptr) {
+			return;
+		}
 
+		m_current_contact = { event.Point, normal };
+		if (enter) {
+			event.Sensor ? se->OnSensorEnter(other) : se->OnCollisionEnter(other);
+		}
+		else {
+			event.Sensor ? se->OnSensorExit(other) : se->OnCollisionExit(other);
+		}
+	};
+	// the normal points from the other entity towards the one being notified
+	dispatch(event.A, event.B, -event.Normal);
+	dispatch(event.B, event.A,  event.Normal);
+}
 
 
 void Physics::Initialize(entt::registry& Registry, class Scene* scene) {
@@ -235,32 +453,54 @@ void Physics::Initialize(entt::registry& Registry, class Scene* scene) {
 	Factory::sInstance = new Factory();
 	RegisterTypes();
 
-	m_temp_allocator = new TempAllocatorImpl(32 * 1024 * 1024);
+	const ProjectConfig& config = Project::GetActive() ? Project::GetActive()->GetConfig() : ProjectConfig();
+
+	// size the world from the scene so big levels do not start by growing
+	m_capacity = config.physics_capacity;
+	m_interpolation = config.physics_interpolation;
+	m_capacity.max_bodies = std::max<uint32_t>(m_capacity.max_bodies, 1);
+	const uint32_t body_count = (uint32_t)(m_Registry->view<Component::RigidBody>().size() + m_Registry->view<Component::CollisionBody>().size());
+	const uint32_t wanted_bodies = body_count + body_count / 4;
+	if (wanted_bodies > m_capacity.max_bodies) {
+		GrowBodyCapacity(m_capacity, NextPowerOfTwo(wanted_bodies));
+	}
+
+	m_temp_allocator = CreateScope<PhysicsTempAllocator>(m_capacity.temp_allocator_size);
+
+	// bodies added after the world is created are created on the next step
+	m_Registry->on_construct<Component::RigidBody>    ().connect<&Physics::OnBodyConstruct>(this);
+	m_Registry->on_construct<Component::CollisionBody>().connect<&Physics::OnBodyConstruct>(this);
+	// CreatePhysicsWorld skips inactive entities, they get their bodies once activated
+	for (entt::entity entity : m_Registry->view<Component::RigidBody, Component::Inactive>()) {
+		m_constructed_bodies.push_back(entity);
+	}
+	for (entt::entity entity : m_Registry->view<Component::CollisionBody, Component::Inactive>(entt::exclude<Component::RigidBody>)) {
+		m_constructed_bodies.push_back(entity);
+	}
+
+	PhysicsLayerTable layers(config.physics_layers);
+	m_layer_count = layers.Count;
 
 	m_broad_phase_layer_interface = new BPLayerInterfaceImpl();
 
 	// Create class that filters object vs broadphase layers
 	// Note: As this is an interface, PhysicsSystem will take a reference to this so this instance needs to stay alive!
-	// Also have a look at ObjectVsBroadPhaseLayerFilterTable or ObjectVsBroadPhaseLayerFilterMask for a simpler interface.
-	m_object_vs_broadphase_layer_filter = new ObjectVsBroadPhaseLayerFilterImpl();
+	m_object_vs_broadphase_layer_filter = new ObjectVsBroadPhaseLayerFilterImpl(layers);
 
 	// Create class that filters object vs object layers
 	// Note: As this is an interface, PhysicsSystem will take a reference to this so this instance needs to stay alive!
-	// Also have a look at ObjectLayerPairFilterTable or ObjectLayerPairFilterMask for a simpler interface.
-	m_object_vs_object_layer_filter = new ObjectLayerPairFilterImpl();
-
-	m_contact_listener = new MyContactListener();
+	m_object_vs_object_layer_filter = new ObjectLayerPairFilterImpl(layers);
 
-	// Now we can create the actual physics system.
-	m_PhysicsSystem = new PhysicsSystem();
-	m_PhysicsSystem->Init(
-		m_max_bodies, m_num_body_mutexes, m_max_body_pairs, m_max_contact_constraints,
-		*m_broad_phase_layer_interface, *m_object_vs_broadphase_layer_filter, *m_object_vs_object_layer_filter
-	);
+	m_contact_listener = new MyContactListener(*this);
+	m_activation_listener = new MyBodyActivationListener(*this);
+	m_contact_events.resize(CONTACT_EVENT_CAPACITY);
 
-	m_PhysicsSystem->SetContactListener(m_contact_listener);
+	CreatePhysicsSystem();
+	m_stats = {};
 
-	m_job_system = new JobSystemThreadPool(cMaxPhysicsJobs, cMaxPhysicsBarriers, std::max(1u,thread::hardware_concurrency()-4));
+	// the same partitioning on every machine, whatever its core count
+	const int max_concurrency = config.deterministic ? DETERMINISTIC_PHYSICS_CONCURRENCY : 0;
+	m_job_system = CreateScope<PhysicsJobSystem>(Application::Get().GetJobSystem(), cMaxPhysicsJobs, cMaxPhysicsBarriers, max_concurrency);
 
 // 	// TODO: set global settings here?
 // 	m_PhysicsSystem->SetGravity(m_PhysicsSystem->GetGravity());
@@ -273,12 +513,39 @@ void Physics::Initialize(entt::registry& Registry, class Scene* scene) {
 	m_is_initialized = true;
 }
 
+void Physics::CreatePhysicsSystem() {
+	m_PhysicsSystem = new PhysicsSystem();
+	m_PhysicsSystem->Init(
+		m_capacity.max_bodies, m_num_body_mutexes, m_capacity.max_body_pairs, m_capacity.max_contact_constraints,
+		*m_broad_phase_layer_interface, *m_object_vs_broadphase_layer_filter, *m_object_vs_object_layer_filter
+	);
+
+	m_PhysicsSystem->SetContactListener(m_contact_listener);
+	m_PhysicsSystem->SetBodyActivationListener(m_activation_listener);
+}
+
 void Physics::Uninitialize() {
 	if (!m_is_initialized) {
 		return;
 	}
 	m_is_initialized = false;
 
+	delete m_PhysicsSystem;
+	m_PhysicsSystem = nullptr;
+	ClearActiveBodies();
+	m_Registry->on_construct<Component::RigidBody>    ().disconnect<&Physics::OnBodyConstruct>(this);
+	m_Registry->on_construct<Component::CollisionBody>().disconnect<&Physics::OnBodyConstruct>(this);
+	m_constructed_bodies.clear();
+	m_pending_adds_active.clear();
+	m_pending_adds_inactive.clear();
+	m_pending_removes.clear();
+	m_body_entities.clear();
+	m_body_motions.clear();
+	m_moved_bodies.clear();
+	m_contact_pairs.clear();
+	m_contact_overflow.clear();
+	m_contact_event_count.store(0, std::memory_order_relaxed);
+
 	UnregisterTypes();
 
 	delete Factory::sInstance;
@@ -288,7 +555,9 @@ void Physics::Uninitialize() {
 	delete m_object_vs_broadphase_layer_filter;
 	delete m_object_vs_object_layer_filter;
 	delete m_contact_listener;
-	delete m_temp_allocator;
+	delete m_activation_listener;
+	m_temp_allocator.reset();
+	m_job_system.reset();
 
 
 	m_Registry->each([&](entt::entity entity) {
@@ -302,12 +571,10 @@ void Physics::Uninitialize() {
 		}
 		if (m_Registry->any_of<Component::CollisionShape>(entity)) {
 			auto& cs = m_Registry->get<Component::CollisionShape>(entity);
-			if (cs.shape != nullptr) {
-				cs.shape->Release();
-				cs.shape = nullptr;
-			}
+			cs.shape = nullptr;
 		}
 	});
+	m_shape_cache.Clear();
 }
 
 
@@ -319,59 +586,368 @@ void Physics::UpdatePhysics() {
 		return;
 	}
 
+	RemovePendingBodies();
+	if (m_rebuild_requested) {
+		RebuildPhysicsSystem();
+	}
+
+	m_step_contacts.store(0, std::memory_order_relaxed);
+	m_temp_allocator->ResetStepStats();
+
+	EPhysicsUpdateError errors;
 	{
 		EN_PROFILE_SECTION("Jolt Physics System Update");
-		m_PhysicsSystem->Update(PHYSICS_UPDATE_RATE, 1, m_temp_allocator, m_job_system);
+		errors = m_PhysicsSystem->Update(PHYSICS_UPDATE_RATE, 1, m_temp_allocator.get(), m_job_system.get());
 	}
 
-	SyncTransforms<Component::RigidBody>();
-	SyncTransforms<Component::CollisionBody>();
+	UpdateStats();
+	GrowIfNeeded(errors);
+
+	// the scene restored the interpolated transforms before the step
+	m_step_index++;
+	m_moved_bodies.clear();
+	m_transforms_interpolated = false;
+	SyncTransforms();
+	CreateConstructedBodies();
+	AddPendingBodies();
 
-	ProcessDeferredOnExitSignals();
-	ProcessDeferredOnEnterSignals();
+	ProcessContactEvents();
 }
 
-template<typename T>
+// only bodies jolt moved this step, sleeping and static bodies cost nothing
 void Physics::SyncTransforms() {
 	EN_PROFILE_SECTION("Physics::SyncTransforms");
 
-	auto group = m_Registry->group<T>(entt::get<Component::Transform>);
-	for (auto entity : group) {
-		auto& tr = group.template get<Component::Transform>(entity);
+	ApplyActivationChanges();
 
-		T& body = group.template get<T>(entity);
+	const BodyLockInterfaceNoLock& lock_interface = m_PhysicsSystem->GetBodyLockInterfaceNoLock();
+	auto sync = [&](const BodyID& id) {
+		// a queued id can belong to a destroyed body
+		BodyLockRead lock(lock_interface, id);
+		if (not lock.Succeeded()) {
+			return;
+		}
+		const Body& body = lock.GetBody();
+		if (body.IsStatic()) {
+			return;
+		}
 
-		if (body.body != nullptr) {
-			if (body.IsStatic()) {
-				continue;
-			}
+		const entt::entity entity = m_body_entities[id.GetIndex()].Entity;
+		if (not m_Registry->valid(entity) or m_Registry->any_of<Component::Inactive>(entity)
+			or not m_Registry->all_of<Component::Transform>(entity)) {
+			return;
+		}
 
-			const Vec3& pos = body.body->GetPosition();
-			const Quat& rot = body.body->GetRotation();
+		const Vec3& pos = body.GetPosition();
+		const Quat& rot = body.GetRotation();
 
-			const glm::vec3 global_pos = glm::vec3(pos.GetX(), pos.GetY(), pos.GetZ());
-			const glm::quat global_rot = glm::quat(rot.GetW(), rot.GetX(), rot.GetY(), rot.GetZ());
+		const glm::vec3 global_pos = glm::vec3(pos.GetX(), pos.GetY(), pos.GetZ());
+		const glm::quat global_rot = glm::quat(rot.GetW(), rot.GetX(), rot.GetY(), rot.GetZ());
 
-			if (m_Registry->all_of<Component::Family>(entity)) {
-				Component::Family& family = m_Registry->get<Component::Family>(entity);
-				family.SetGlobalPositionRotation(tr, global_pos, global_rot);
-			} else {
-				tr.LocalPosition = global_pos;
-				tr.LocalRotation = global_rot;
+		RecordMotion(id, global_pos, global_rot);
+		SetTransform(entity, m_Registry->get<Component::Transform>(entity), global_pos, global_rot);
+	};
+
+	for (const BodyID& id : m_active_bodies) {
+		sync(id);
+	}
+	for (const BodyID& id : m_fell_asleep) {
+		sync(id);
+	}
+}
+
+void Physics::OnBodyConstruct(entt::registry& registry, entt::entity entity) {
+	m_constructed_bodies.push_back(entity);
+}
+
+void Physics::CreateConstructedBodies() {
+	// waits for the rebuild at the start of the next step, the world may be out of bodies
+	if (m_constructed_bodies.empty() or m_rebuild_requested) {
+		return;
+	}
+	EN_PROFILE_SECTION("Physics::CreateConstructedBodies");
+
+	// inactive entities wait in the queue until they are activated,
+	// bodies that can not be created are queued again by CreatePhysicsBody
+	std::vector<entt::entity> constructed;
+	constructed.swap(m_constructed_bodies);
+	for (entt::entity entity : constructed) {
+		if (not m_Registry->valid(entity) or not m_Registry->all_of<Component::Transform>(entity)) {
+			continue;
+		}
+		if (m_Registry->all_of<Component::Inactive>(entity)) {
+			m_constructed_bodies.push_back(entity);
+			continue;
+		}
+
+		Component::Transform& tr = m_Registry->get<Component::Transform>(entity);
+		if (auto* rb = m_Registry->try_get<Component::RigidBody>(entity)) {
+			if (rb->body == nullptr) {
+				CreatePhysicsBody(Entity(entity, m_Scene), tr, *rb);
+			}
+		} else if (auto* cb = m_Registry->try_get<Component::CollisionBody>(entity)) {
+			if (cb->body == nullptr) {
+				CreatePhysicsBody(Entity(entity, m_Scene), tr, *cb);
 			}
-		} else {
-			// component is new
-			CreatePhysicsBody(Entity(entity, m_Scene), tr, body);
 		}
 	}
 }
 
+void Physics::SetTransform(entt::entity entity, Component::Transform& tr, const glm::vec3& global_pos, const glm::quat& global_rot) {
+	if (m_Registry->all_of<Component::Family>(entity)) {
+		Component::Family& family = m_Registry->get<Component::Family>(entity);
+		family.SetGlobalPositionRotation(tr, global_pos, global_rot);
+	} else {
+		tr.LocalPosition = global_pos;
+		tr.LocalRotation = global_rot;
+	}
+}
+
+void Physics::RecordMotion(const JPH::BodyID& id, const glm::vec3& position, const glm::quat& rotation) {
+	const uint32_t index = id.GetIndex();
+	if (index >= m_body_motions.size()) {
+		return;
+	}
+
+	BodyMotion& motion = m_body_motions[index];
+	if (motion.Step + 1 == m_step_index) {
+		motion.PreviousPosition = motion.Position;
+		motion.PreviousRotation = motion.Rotation;
+	} else {
+		// new or was not synced last step, nothing to interpolate from
+		motion.PreviousPosition = position;
+		motion.PreviousRotation = rotation;
+	}
+	motion.Position = position;
+	motion.Rotation = rotation;
+	motion.Step = m_step_index;
+
+	// sleeping bodies already show their stepped transform
+	if (motion.PreviousPosition != motion.Position or motion.PreviousRotation != motion.Rotation) {
+		m_moved_bodies.push_back(index);
+	}
+}
+
+void Physics::InterpolateTransforms(float alpha) {
+	EN_PROFILE_SECTION("Physics::InterpolateTransforms");
+
+	if (m_interpolation == PhysicsInterpolation::NONE) {
+		return;
+	}
+	// extrapolation guesses where the next step will be, it does not lag a step behind
+	const float t = m_interpolation == PhysicsInterpolation::EXTRAPOLATE ? 1.0f + alpha : alpha;
+
+	for (uint32_t index : m_moved_bodies) {
+		const BodyMotion& motion = m_body_motions[index];
+		const entt::entity entity = m_body_entities[index].Entity;
+		if (not m_Registry->valid(entity) or m_Registry->any_of<Component::Inactive>(entity)
+			or not m_Registry->all_of<Component::Transform>(entity)) {
+			continue;
+		}
+
+		const glm::vec3 position = glm::mix(motion.PreviousPosition, motion.Position, t);
+		const glm::quat rotation = glm::slerp(motion.PreviousRotation, motion.Rotation, t);
+		SetRenderTransform(entity, m_Registry->get<Component::Transform>(entity), position, rotation);
+	}
+	m_transforms_interpolated = not m_moved_bodies.empty();
+}
+
+void Physics::RestoreTransforms() {
+	if (not m_transforms_interpolated) {
+		return;
+	}
+	for (uint32_t index : m_moved_bodies) {
+		const BodyMotion& motion = m_body_motions[index];
+		const entt::entity entity = m_body_entities[index].Entity;
+		if (not m_Registry->valid(entity) or not m_Registry->all_of<Component::Transform>(entity)) {
+			continue;
+		}
+		SetRenderTransform(entity, m_Registry->get<Component::Transform>(entity), motion.Position, motion.Rotation);
+	}
+	m_transforms_interpolated = false;
+}
+
+void Physics::SetRenderTransform(entt::entity entity, Component::Transform& tr, const glm::vec3& global_pos, const glm::quat& global_rot) {
+	tr.GlobalPosition = global_pos;
+	tr.GlobalRotation = global_rot;
+	if (auto* family = m_Registry->try_get<Component::Family>(entity)) {
+		family->SetChildrenGlobalTransformRecursive(tr);
+	}
+}
+
+
+void Physics::UpdateStats() {
+	const auto body_stats = m_PhysicsSystem->GetBodyStats();
+	m_stats.Bodies       = body_stats.mNumBodies;
+	m_stats.ActiveBodies = body_stats.mNumActiveBodiesDynamic + body_stats.mNumActiveBodiesKinematic;
+	m_stats.MaxBodies    = m_capacity.max_bodies;
+	m_stats.Contacts     = m_step_contacts.load(std::memory_order_relaxed);
+	m_stats.MaxBodyPairs          = m_capacity.max_body_pairs;
+	m_stats.MaxContactConstraints = m_capacity.max_contact_constraints;
+
+	m_stats.TempHighWater     = m_temp_allocator->GetStepHighWater();
+	m_stats.TempPeakHighWater = std::max(m_temp_allocator->GetPeakHighWater(), m_stats.TempHighWater);
+	m_stats.TempSize          = m_temp_allocator->GetSize();
+	m_stats.TempFallbacks     = m_temp_allocator->GetStepFallbackCount();
+
+	m_stats.Shapes = m_shape_cache.GetShapeCount();
+}
+
+void Physics::GrowIfNeeded(JPH::EPhysicsUpdateError errors) {
+	// nothing is allocated between steps
+	if (m_stats.TempFallbacks > 0) {
+		const uint32_t size = NextPowerOfTwo(m_stats.TempHighWater + m_stats.TempHighWater / 4);
+		EN_CORE_WARN("Physics temp allocator full ({} of {} bytes), growing to {} bytes", m_stats.TempHighWater, m_stats.TempSize, size);
+		m_capacity.temp_allocator_size = size;
+		m_temp_allocator->Resize(size);
+	}
+
+	if (errors != EPhysicsUpdateError::None) {
+		if ((errors & EPhysicsUpdateError::BodyPairCacheFull) != EPhysicsUpdateError::None or
+			(errors & EPhysicsUpdateError::ManifoldCacheFull) != EPhysicsUpdateError::None) {
+			m_capacity.max_body_pairs *= 2;
+		}
+		if ((errors & EPhysicsUpdateError::ContactConstraintsFull) != EPhysicsUpdateError::None) {
+			m_capacity.max_contact_constraints *= 2;
+		}
+		EN_CORE_WARN("Physics ran out of body pairs or contact constraints, growing to {} pairs {} constraints",
+			m_capacity.max_body_pairs, m_capacity.max_contact_constraints);
+		m_rebuild_requested = true;
+	}
+
+	if (m_failed_bodies > 0 or m_stats.Bodies >= m_capacity.max_bodies * GROW_THRESHOLD) {
+		const uint32_t max_bodies = NextPowerOfTwo(std::max(m_capacity.max_bodies * 2, m_stats.Bodies + m_failed_bodies));
+		if (m_failed_bodies > 0) {
+			EN_CORE_WARN("Physics could not create {} bodies, growing to {} bodies", m_failed_bodies, max_bodies);
+		}
+		else {
+			EN_CORE_WARN("Physics is close to its body limit ({} of {}), growing to {} bodies", m_stats.Bodies, m_capacity.max_bodies, max_bodies);
+		}
+		GrowBodyCapacity(m_capacity, max_bodies);
+		m_failed_bodies = 0;
+		m_rebuild_requested = true;
+	}
+}
+
+void Physics::RebuildPhysicsSystem() {
+	EN_PROFILE_SECTION("Physics::RebuildPhysicsSystem");
+	m_rebuild_requested = false;
+
+	struct CapturedBody {
+		entt::entity Entity;
+		RVec3 Position;
+		Quat  Rotation;
+		Vec3  LinearVelocity;
+		Vec3  AngularVelocity;
+		bool  Added;
+		bool  Active;
+	};
+	std::vector<CapturedBody> captured_rigid;
+	std::vector<CapturedBody> captured_collision;
+
+	// bodies created since the last step are not added yet, they are added to the new system instead
+	std::unordered_set<uint32_t> pending_active;
+	std::unordered_set<uint32_t> pending_inactive;
+	for (const BodyID& id : m_pending_adds_active) {
+		pending_active.insert(id.GetIndexAndSequenceNumber());
+	}
+	for (const BodyID& id : m_pending_adds_inactive) {
+		pending_inactive.insert(id.GetIndexAndSequenceNumber());
+	}
+
+	BodyInterface& old_interface = m_PhysicsSystem->GetBodyInterfaceNoLock();
+	auto capture = [&](entt::entity entity, Component::PhysicsBodyBase& base, std::vector<CapturedBody>& captured) {
+		const Body* body = base.body;
+		const uint32_t id = body->GetID().GetIndexAndSequenceNumber();
+		const bool pending = pending_active.count(id) > 0 or pending_inactive.count(id) > 0;
+		captured.push_back({
+			entity, body->GetPosition(), body->GetRotation(),
+			body->GetLinearVelocity(), body->GetAngularVelocity(),
+			pending or old_interface.IsAdded(body->GetID()),
+			pending_active.count(id) > 0 or body->IsActive()
+		});
+		base.body = nullptr;
+	};
+	for (auto [entity, rb] : m_Registry->view<Component::RigidBody>().each()) {
+		if (rb.body) {
+			capture(entity, rb, captured_rigid);
+		}
+	}
+	for (auto [entity, cb] : m_Registry->view<Component::CollisionBody>(entt::exclude<Component::RigidBody>).each()) {
+		if (cb.body) {
+			capture(entity, cb, captured_collision);
+		}
+	}
+	// shapes do not belong to the physics system, the cache keeps them
+
+	// ids of the old system, they would alias bodies of the new one
+	m_pending_adds_active.clear();
+	m_pending_adds_inactive.clear();
+	m_pending_removes.clear();
+	delete m_PhysicsSystem;
+	ClearActiveBodies();
+	m_body_entities.clear();
+	m_body_motions.clear();
+	m_moved_bodies.clear();
+	m_contact_pairs.clear();
+	CreatePhysicsSystem();
+
+	// NOTE: jolt's contact cache is lost, touching bodies get OnCollisionEnter again
+	BodyInterface& body_interface = m_PhysicsSystem->GetBodyInterfaceNoLock();
+	std::vector<std::pair<BodyID, const CapturedBody*>> restored;
+	restored.reserve(captured_rigid.size() + captured_collision.size());
+
+	auto restore = [&](const CapturedBody& captured, auto& component) {
+		Entity entity(captured.Entity, m_Scene);
+		CreatePhysicsBody(entity, entity.Get<Component::Transform>(), component);
+		if (component.body == nullptr) {
+			return;
+		}
+		const BodyID id = component.body->GetID();
+		body_interface.SetPositionAndRotation(id, captured.Position, captured.Rotation, EActivation::DontActivate);
+		if (not component.body->IsStatic()) {
+			component.body->SetLinearVelocity (captured.LinearVelocity);
+			component.body->SetAngularVelocity(captured.AngularVelocity);
+		}
+		restored.emplace_back(id, &captured);
+	};
+	for (const CapturedBody& captured : captured_rigid) {
+		restore(captured, m_Registry->get<Component::RigidBody>(captured.Entity));
+	}
+	for (const CapturedBody& captured : captured_collision) {
+		restore(captured, m_Registry->get<Component::CollisionBody>(captured.Entity));
+	}
+	AddPendingBodies();
+
+	std::vector<BodyID> not_added;
+	for (const auto& [id, captured] : restored) {
+		if (not captured->Added) {
+			not_added.push_back(id);
+		}
+		else if (captured->Active) {
+			body_interface.ActivateBody(id);
+		}
+		else {
+			body_interface.DeactivateBody(id);
+		}
+	}
+	if (not not_added.empty()) {
+		body_interface.RemoveBodies(not_added.data(), (int)not_added.size());
+	}
+	m_PhysicsSystem->OptimizeBroadPhase();
+
+	m_stats.Rebuilds++;
+	EN_CORE_INFO("Rebuilt physics world with {} bodies, capacity {} bodies {} pairs {} constraints",
+		captured_rigid.size() + captured_collision.size(),
+		m_capacity.max_bodies, m_capacity.max_body_pairs, m_capacity.max_contact_constraints);
+}
+
 
 void Physics::CreatePhysicsWorld() {
 	EN_PROFILE_SECTION("Physics::CreatePhysicsWorld");
 
 	{
-		auto group = m_Registry->group<Component::RigidBody>(entt::get<Component::Transform>);
+		auto group = m_Registry->group<Component::RigidBody>(entt::get<Component::Transform>, entt::exclude<Component::Inactive>);
 		for (auto entity : group) {
 			Component::Transform& tr = group.get<Component::Transform>(entity);
 			Component::RigidBody& rb = group.get<Component::RigidBody>(entity);
@@ -381,7 +957,7 @@ void Physics::CreatePhysicsWorld() {
 		}
 	}
 	{
-		auto group = m_Registry->group<Component::CollisionBody>(entt::get<Component::Transform>);
+		auto group = m_Registry->group<Component::CollisionBody>(entt::get<Component::Transform>, entt::exclude<Component::Inactive>);
 		for (auto entity : group) {
 			Component::Transform& tr = group.get<Component::Transform>(entity);
 			Component::CollisionBody& cb = group.get<Component::CollisionBody>(entity);
@@ -390,12 +966,13 @@ void Physics::CreatePhysicsWorld() {
 			}
 		}
 	}
+	AddPendingBodies();
 	m_PhysicsSystem->OptimizeBroadPhase();
 }
 
 
 void Physics::CreatePhysicsBody(Entity entity, const Component::Transform& tr, Component::RigidBody& body) {
-	Shape* shape = CreateShapeForBody(entity);
+	JPH::Ref<Shape> shape = CreateShapeForBody(entity);
 	if (shape == nullptr) {
 		EN_CORE_ERROR("invalid shape for body");
 		return;
@@ -406,7 +983,7 @@ void Physics::CreatePhysicsBody(Entity entity, const Component::Transform& tr, C
 		RVec3Arg(tr.GlobalPosition.x, tr.GlobalPosition.y, tr.GlobalPosition.z),
 		QuatArg(tr.GlobalRotation.x, tr.GlobalRotation.y, tr.GlobalRotation.z, tr.GlobalRotation.w),
 		body.MotionType,
-		static_cast<ObjectLayer>(body.Layer)
+		GetObjectLayer(entity, body.Layer, body.IsStatic() ? BroadPhaseLayers::NON_MOVING : BroadPhaseLayers::MOVING)
 	};
 	bcs.mAllowedDOFs = EAllowedDOFs::Plane2D;
 	// TODO: lock rotation for some objects
@@ -416,14 +993,21 @@ void Physics::CreatePhysicsBody(Entity entity, const Component::Transform& tr, C
 	bcs.mFriction = 0.05f;
 
 	Body* new_body = m_PhysicsSystem->GetBodyInterface().CreateBody(bcs);
+	if (new_body == nullptr) {
+		// out of bodies, retried after the world grows
+		m_failed_bodies++;
+		m_constructed_bodies.push_back(entity);
+		return;
+	}
 	new_body->GetMotionProperties()->ScaleToMass(body.GetMass());
 	new_body->SetUserData(entity.GetID());
-	m_PhysicsSystem->GetBodyInterface().AddBody(new_body->GetID(), EActivation::Activate);
+	SetBodyEntity(new_body->GetID(), entity, false);
+	m_pending_adds_active.push_back(new_body->GetID());
 
 	body.body = new_body;
 }
 void Physics::CreatePhysicsBody(Entity entity, const Component::Transform& tr, Component::CollisionBody& body) {
-	Shape* shape = CreateShapeForBody(entity);
+	JPH::Ref<Shape> shape = CreateShapeForBody(entity);
 	if (shape == nullptr) {
 		EN_CORE_ERROR("invalid shape for body");
 		return;
@@ -434,7 +1018,8 @@ void Physics::CreatePhysicsBody(Entity entity, const Component::Transform& tr, C
 		RVec3Arg(tr.GlobalPosition.x, tr.GlobalPosition.y, tr.GlobalPosition.z),
 		QuatArg(tr.GlobalRotation.x, tr.GlobalRotation.y, tr.GlobalRotation.z, tr.GlobalRotation.w),
 		body.MotionType,
-		static_cast<ObjectLayer>(body.Layer)
+		GetObjectLayer(entity, body.Layer,
+			body.IsSensor ? BroadPhaseLayers::SENSOR : (body.IsStatic() ? BroadPhaseLayers::NON_MOVING : BroadPhaseLayers::MOVING))
 	};
 	bcs.mAllowedDOFs = EAllowedDOFs::Plane2D;
 	bcs.mIsSensor = body.IsSensor;
@@ -442,15 +1027,30 @@ void Physics::CreatePhysicsBody(Entity entity, const Component::Transform& tr, C
 	bcs.mFriction = 0.05f;
 
 	Body* new_body = m_PhysicsSystem->GetBodyInterface().CreateBody(bcs);
+	if (new_body == nullptr) {
+		m_failed_bodies++;
+		m_constructed_bodies.push_back(entity);
+		return;
+	}
 	new_body->SetUserData(entity.GetID());
-	m_PhysicsSystem->GetBodyInterface().AddBody(new_body->GetID(), EActivation::DontActivate);
+	SetBodyEntity(new_body->GetID(), entity, body.IsSensor);
+	m_pending_adds_inactive.push_back(new_body->GetID());
 
 	body.body = new_body;
 }
 
+JPH::ObjectLayer Physics::GetObjectLayer(Entity entity, uint16_t layer, JPH::BroadPhaseLayer broadphase) {
+	if (layer >= m_layer_count) {
+		EN_CORE_WARN("Entity '{}' has invalid physics layer {}, using layer 0", entity.GetTag(), layer);
+		layer = 0;
+	}
+	const ObjectLayer object_layer = MakeObjectLayer(layer, broadphase);
+	static_cast<ObjectVsBroadPhaseLayerFilterImpl*>(m_object_vs_broadphase_layer_filter)->AddTreeLayer(object_layer);
+	return object_layer;
+}
+
 void Physics::RemovePhysicsBody(JPH::BodyID bodyID) {
-	m_PhysicsSystem->GetBodyInterface().RemoveBody (bodyID);
-	m_PhysicsSystem->GetBodyInterface().DestroyBody(bodyID);
+	m_pending_removes.push_back(bodyID);
 }
 void Physics::RemovePhysicsBody(JPH::Body* body) {
 	if (body != nullptr) {
@@ -458,43 +1058,149 @@ void Physics::RemovePhysicsBody(JPH::Body* body) {
 	}
 }
 
+void Physics::RemovePhysicsBodies(std::vector<JPH::BodyID>& body_ids) {
+	if (not m_is_initialized or body_ids.empty()) {
+		return;
+	}
+	BodyInterface& body_interface = m_PhysicsSystem->GetBodyInterface();
+
+	// NOTE: deactivated bodies are already removed
+	std::vector<BodyID> added;
+	added.reserve(body_ids.size());
+	for (const BodyID& id : body_ids) {
+		if (body_interface.IsAdded(id)) {
+			added.push_back(id);
+		}
+	}
+
+	if (not added.empty()) {
+		body_interface.RemoveBodies(added.data(), (int)added.size());
+	}
+	body_interface.DestroyBodies(body_ids.data(), (int)body_ids.size());
+}
+
+void Physics::AddPendingBodies() {
+	BodyInterface& body_interface = m_PhysicsSystem->GetBodyInterface();
+	auto add = [&](std::vector<BodyID>& body_ids, EActivation activation) {
+		if (body_ids.empty()) {
+			return;
+		}
+		// builds one balanced tree for the batch instead of inserting into the broadphase one by one
+		BodyInterface::AddState state = body_interface.AddBodiesPrepare(body_ids.data(), (int)body_ids.size());
+		body_interface.AddBodiesFinalize(body_ids.data(), (int)body_ids.size(), state, activation);
+		body_ids.clear();
+	};
+	add(m_pending_adds_active,   EActivation::Activate);
+	add(m_pending_adds_inactive, EActivation::DontActivate);
+}
+
+void Physics::RemovePendingBodies() {
+	if (not m_pending_removes.empty()) {
+		RemovePhysicsBodies(m_pending_removes);
+		m_pending_removes.clear();
+	}
+}
+
+void Physics::DeactivatePhysicsBody(JPH::Body* body) {
+	if (not m_is_initialized or body == nullptr) {
+		return;
+	}
+	BodyInterface& body_interface = m_PhysicsSystem->GetBodyInterface();
+	if (not body_interface.IsAdded(body->GetID())) {
+		// created since the last step, keep it out of the next batch
+		for (std::vector<BodyID>* pending : { &m_pending_adds_active, &m_pending_adds_inactive }) {
+			pending->erase(std::remove(pending->begin(), pending->end(), body->GetID()), pending->end());
+		}
+		return;
+	}
+	if (not body->IsStatic()) {
+		body->SetLinearVelocity (Vec3::sZero());
+		body->SetAngularVelocity(Vec3::sZero());
+	}
+	body_interface.RemoveBody(body->GetID());
+}
+
+void Physics::ActivatePhysicsBody(Entity entity) {
+	if (not m_is_initialized) {
+		return;
+	}
+	Component::PhysicsBodyBase* base = m_Registry->try_get<Component::RigidBody>(entity);
+	if (base == nullptr) {
+		base = m_Registry->try_get<Component::CollisionBody>(entity);
+	}
+	if (base == nullptr) {
+		return;
+	}
+
+	// inactive since before the world was created, it never had a body.
+	// the new body is added to the world with the next batch of pending adds
+	if (base->body == nullptr) {
+		const Component::Transform& tr = entity.Get<Component::Transform>();
+		if (auto* rb = m_Registry->try_get<Component::RigidBody>(entity)) {
+			CreatePhysicsBody(entity, tr, *rb);
+		} else {
+			CreatePhysicsBody(entity, tr, m_Registry->get<Component::CollisionBody>(entity));
+		}
+		return;
+	}
+
+	JPH::Body* body = base->body;
+	BodyInterface& body_interface = m_PhysicsSystem->GetBodyInterface();
+	if (body_interface.IsAdded(body->GetID())) {
+		return;
+	}
+	body_interface.AddBody(body->GetID(), body->IsStatic() ? EActivation::DontActivate : EActivation::Activate);
+}
+
 
 
 JPH::Ref<JPH::Shape> Physics::CreateShapeForBody(Entity entity) {
-	// TODO: composite shapes
+	const Component::Transform& tr = entity.Get<Component::Transform>();
 
+	std::vector<PhysicsShapePart> parts;
 	if (entity.Has<Component::CollisionShape>()) {
-		Component::CollisionShape& cs = entity.Get<Component::CollisionShape>();
-		Component::Transform& tr = entity.Get<Component::Transform>();
-
-		switch (cs.Shape) {
-			case Component::CollisionShape::Type::BOX: {
-				auto scale = cs.BoxScale * tr.GlobalScale;
-				BoxShapeSettings shape(Vec3(scale.x, scale.y, scale.z));
-				cs.shape = shape.Create().Get();
-				cs.shape->AddRef();
-				return cs.shape;
-			}
-			case Component::CollisionShape::Type::CIRCLE: {
-				auto scale = cs.CircleRadius * max(tr.GlobalScale.x, tr.GlobalScale.y);
-				SphereShapeSettings shape(scale);
-				cs.shape = shape.Create().Get();
-				cs.shape->AddRef();
-				return cs.shape;
+		parts.push_back({ &entity.Get<Component::CollisionShape>(), tr.GlobalScale });
+	}
+
+	// children without a body of their own are part of this body
+	if (entity.HasFamily()) {
+		const glm::quat inverse_rotation = glm::inverse(tr.GlobalRotation);
+		for (Entity child : entity.GetChildren()) {
+			if (not child.Has<Component::CollisionShape>() or child.Has<Component::Inactive>() or
+				child.Has<Component::RigidBody>() or child.Has<Component::CollisionBody>()) {
+				continue;
 			}
-			case Component::CollisionShape::Type::NONE: break;
+			const Component::Transform& child_tr = child.Get<Component::Transform>();
+			parts.push_back({
+				&child.Get<Component::CollisionShape>(),
+				child_tr.GlobalScale,
+				inverse_rotation * (child_tr.GlobalPosition - tr.GlobalPosition),
+				inverse_rotation * child_tr.GlobalRotation
+			});
 		}
 	}
 
-	BoxShapeSettings shape(Vec3(0.5f, 0.5f, 0.5f));
-	auto s = shape.Create().Get();
-	s->AddRef();
-	return s;
+	JPH::Ref<JPH::Shape> shape = m_shape_cache.GetShape(parts);
+	if (entity.Has<Component::CollisionShape>()) {
+		entity.Get<Component::CollisionShape>().shape = shape;
+	}
+	return shape;
 }
 
 
 RaycastResult Physics::CastRay(const Raycast& ray) {
-	assert(ray.layer < Layers::NUM_LAYERS);
+	uint16_t layer = ray.layer;
+	if (layer >= m_layer_count) {
+		EN_CORE_WARN("CastRay invalid physics layer {}, using layer 0", layer);
+		layer = 0;
+	}
+	// bodies of destroyed entities should not be hit
+	RemovePendingBodies();
+
+	// the ray hits what a moving body on its layer would hit
+	const ObjectLayer object_layer = MakeObjectLayer(layer, BroadPhaseLayers::MOVING);
+	DefaultBroadPhaseLayerFilter broadphase_filter(*m_object_vs_broadphase_layer_filter, object_layer);
+	DefaultObjectLayerFilter     object_filter    (*m_object_vs_object_layer_filter, object_layer);
 
 	JPH::Vec3 jolt_origin(ray.origin.x, ray.origin.y, ray.origin.z);
 	JPH::Vec3 jolt_dir(ray.dir.x, ray.dir.y, ray.dir.z);
@@ -510,8 +1216,8 @@ RaycastResult Physics::CastRay(const Raycast& ray) {
 
 	JPH::RayCastResult result;
 	auto& npq = m_PhysicsSystem->GetNarrowPhaseQuery();
-	if (npq.CastRay(jolt_ray, result) && result.mFraction <= 1.0f) {
-		Entity e = FindEntityByUUID(m_PhysicsSystem->GetBodyInterface().GetUserData(result.mBodyID));
+	if (npq.CastRay(jolt_ray, result, broadphase_filter, object_filter) && result.mFraction <= 1.0f) {
+		Entity e = Entity(GetBodyEntity(result.mBodyID).Entity, m_Scene);
 		JPH::Vec3 hit_position = jolt_ray.GetPointOnRay(result.mFraction);
 		glm::vec3 p = { hit_position.GetX(), hit_position.GetY(), hit_position.GetZ() };
 		return RaycastResult{e, p};
@@ -521,4 +1227,168 @@ RaycastResult Physics::CastRay(const Raycast& ray) {
 }
 
 
+
+// queries smaller than this run on the calling thread
+static constexpr uint32_t QUERY_BATCH_SIZE = 32;
+
+class QueryObjectLayerFilter final : public ObjectLayerFilter {
+public:
+	QueryObjectLayerFilter(uint16_t layer_mask) : m_LayerMask(layer_mask) {}
+	virtual bool ShouldCollide(ObjectLayer layer) const override {
+		return (m_LayerMask >> GetCollisionLayer(layer)) & 1;
+	}
+private:
+	uint16_t m_LayerMask;
+};
+
+class QueryBroadPhaseLayerFilter final : public BroadPhaseLayerFilter {
+public:
+	QueryBroadPhaseLayerFilter(bool include_sensors) : m_IncludeSensors(include_sensors) {}
+	virtual bool ShouldCollide(BroadPhaseLayer layer) const override {
+		return m_IncludeSensors or layer != BroadPhaseLayers::SENSOR;
+	}
+private:
+	bool m_IncludeSensors;
+};
+
+static JPH::Ref<Shape> CreateQueryShape(const PhysicsQuery& query) {
+	if (query.shape == PhysicsQueryShape::BOX) {
+		const Vec3 half_extent = Vec3::sMax(Vec3(query.size.x, query.size.y, query.size.z), Vec3::sReplicate(0.001f));
+		return new BoxShape(half_extent, std::min(cDefaultConvexRadius, half_extent.ReduceMin()));
+	}
+	return new SphereShape(std::max(query.size.x, 0.001f));
+}
+
+void Physics::RunQueries(PhysicsQueryBatch& batch) {
+	EN_PROFILE_SECTION("Physics::RunQueries");
+
+	const uint32_t count = batch.GetQueryCount();
+	batch.m_Ranges.assign(count, {});
+	batch.m_Hits.clear();
+	if (count == 0 or not m_is_initialized) {
+		return;
+	}
+
+	// bodies of destroyed entities should not be hit
+	RemovePendingBodies();
+
+	if (batch.m_Scratch.size() < count) {
+		batch.m_Scratch.resize(count);
+	}
+	// nothing changes the world while the batch runs, so the queries do not lock bodies
+	auto run = [&](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++) {
+			batch.m_Scratch[i].clear();
+			RunQuery(batch.m_Queries[i], batch.m_Scratch[i]);
+		}
+	};
+	if (count <= QUERY_BATCH_SIZE) {
+		run(0, count);
+	} else {
+		Application::Get().GetJobSystem().ParallelFor(count, QUERY_BATCH_SIZE, run);
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		const std::vector<PhysicsQueryHit>& hits = batch.m_Scratch[i];
+		batch.m_Ranges[i] = { (uint32_t)batch.m_Hits.size(), (uint32_t)hits.size() };
+		batch.m_Hits.insert(batch.m_Hits.end(), hits.begin(), hits.end());
+	}
+}
+
+void Physics::RunQuery(const PhysicsQuery& query, std::vector<PhysicsQueryHit>& hits) const {
+	const NarrowPhaseQuery& npq = m_PhysicsSystem->GetNarrowPhaseQueryNoLock();
+	const BodyLockInterfaceNoLock& lock_interface = m_PhysicsSystem->GetBodyLockInterfaceNoLock();
+	QueryBroadPhaseLayerFilter broadphase_filter(query.include_sensors);
+	QueryObjectLayerFilter     object_filter(query.layer_mask);
+
+	const RVec3 origin(query.origin.x, query.origin.y, query.origin.z);
+	const Vec3  dir(query.dir.x, query.dir.y, query.dir.z);
+
+	// compound shapes hit once per sub shape, a body is reported once with its closest hit
+	auto add_hit = [&](const BodyID& id, RVec3Arg point, Vec3Arg normal, float fraction) {
+		const entt::entity entity = GetBodyEntity(id).Entity;
+		if (not m_Registry->valid(entity)) {
+			return;
+		}
+		for (PhysicsQueryHit& hit : hits) {
+			if ((entt::entity)hit.entity == entity) {
+				return;
+			}
+		}
+		hits.push_back({
+			Entity(entity, m_Scene),
+			glm::vec3(point.GetX(), point.GetY(), point.GetZ()),
+			glm::vec3(normal.GetX(), normal.GetY(), normal.GetZ()),
+			fraction
+		});
+	};
+
+	switch (query.type) {
+		case PhysicsQueryType::RAY: {
+			const RRayCast ray(origin, dir);
+			auto add_ray_hit = [&](const RayCastResult& result) {
+				const RVec3 point = ray.GetPointOnRay(result.mFraction);
+				Vec3 normal = -dir.Normalized();
+				BodyLockRead lock(lock_interface, result.mBodyID);
+				if (lock.Succeeded()) {
+					normal = lock.GetBody().GetWorldSpaceSurfaceNormal(result.mSubShapeID2, point);
+				}
+				add_hit(result.mBodyID, point, normal, result.mFraction);
+			};
+
+			if (query.all_hits) {
+				AllHitCollisionCollector<CastRayCollector> collector;
+				npq.CastRay(ray, RayCastSettings(), collector, broadphase_filter, object_filter);
+				collector.Sort();
+				for (const RayCastResult& result : collector.mHits) {
+					add_ray_hit(result);
+				}
+			} else {
+				RayCastResult result;
+				if (npq.CastRay(ray, result, broadphase_filter, object_filter)) {
+					add_ray_hit(result);
+				}
+			}
+			break;
+		}
+		case PhysicsQueryType::SHAPE_CAST: {
+			const JPH::Ref<Shape> shape = CreateQueryShape(query);
+			const Quat rotation(query.rotation.x, query.rotation.y, query.rotation.z, query.rotation.w);
+			const RShapeCast cast(shape, Vec3::sReplicate(1.0f), RMat44::sRotationTranslation(rotation, origin), dir);
+			// the axis is zero when the shape starts exactly touching, the hit faces the cast then
+			const Vec3 fallback_axis = dir.NormalizedOr(-Vec3::sAxisY());
+			auto add_cast_hit = [&](const ShapeCastResult& result) {
+				add_hit(result.mBodyID2, result.mContactPointOn2, -result.mPenetrationAxis.NormalizedOr(fallback_axis), result.mFraction);
+			};
+
+			if (query.all_hits) {
+				AllHitCollisionCollector<CastShapeCollector> collector;
+				npq.CastShape(cast, ShapeCastSettings(), RVec3::sZero(), collector, broadphase_filter, object_filter);
+				collector.Sort();
+				for (const ShapeCastResult& result : collector.mHits) {
+					add_cast_hit(result);
+				}
+			} else {
+				ClosestHitCollisionCollector<CastShapeCollector> collector;
+				npq.CastShape(cast, ShapeCastSettings(), RVec3::sZero(), collector, broadphase_filter, object_filter);
+				if (collector.HadHit()) {
+					add_cast_hit(collector.mHit);
+				}
+			}
+			break;
+		}
+		case PhysicsQueryType::OVERLAP: {
+			const JPH::Ref<Shape> shape = CreateQueryShape(query);
+			const Quat rotation(query.rotation.x, query.rotation.y, query.rotation.z, query.rotation.w);
+			AllHitCollisionCollector<CollideShapeCollector> collector;
+			npq.CollideShape(shape, Vec3::sReplicate(1.0f), RMat44::sRotationTranslation(rotation, origin),
+				CollideShapeSettings(), RVec3::sZero(), collector, broadphase_filter, object_filter);
+			for (const CollideShapeResult& result : collector.mHits) {
+				add_hit(result.mBodyID2, result.mContactPointOn2, -result.mPenetrationAxis.NormalizedOr(-Vec3::sAxisY()), 0.0f);
+			}
+			break;
+		}
+	}
+}
+
 }
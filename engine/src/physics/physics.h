@@ -6,16 +6,60 @@
 #include <Jolt/Jolt.h>
 #include <Jolt/Core/TempAllocator.h>
 #include <Jolt/Physics/PhysicsSystem.h>
-#include <Jolt/Core/JobSystemThreadPool.h>
+#include "physics/physics_job_system.h"
+#include "physics/physics_shape_cache.h"
+#include "physics/physics_temp_allocator.h"
+#include "project/project.h"
 
 
 namespace Enik {
 
 constexpr float PHYSICS_UPDATE_RATE = 1.0/60.0;
+// a slow frame runs at most this many fixed updates, the rest of the time is dropped
+constexpr int MAX_FIXED_UPDATES_PER_FRAME = 5;
 
 
 struct RaycastResult;
 struct Raycast;
+struct PhysicsQuery;
+struct PhysicsQueryHit;
+class PhysicsQueryBatch;
+
+// normal points from the other entity towards the one receiving the callback
+struct CollisionContact {
+	glm::vec3 point;
+	glm::vec3 normal;
+};
+
+// captured by the contact listener, entities are resolved when the contact happens
+struct ContactEvent {
+	entt::entity A = entt::null;
+	entt::entity B = entt::null;
+	bool Enter  = false;
+	bool Sensor = false;
+	glm::vec3 Point  = glm::vec3(0.0f);
+	// from A towards B
+	glm::vec3 Normal = glm::vec3(0.0f);
+};
+
+struct PhysicsStats {
+	uint32_t Bodies = 0;
+	uint32_t ActiveBodies = 0;
+	uint32_t MaxBodies = 0;
+	// contacts added or kept in the last step, jolt does not expose its broadphase pair count
+	uint32_t Contacts = 0;
+	uint32_t MaxBodyPairs = 0;
+	uint32_t MaxContactConstraints = 0;
+
+	uint32_t TempHighWater = 0;
+	uint32_t TempPeakHighWater = 0;
+	uint32_t TempSize = 0;
+	uint32_t TempFallbacks = 0;
+
+	// unique shapes, shared by every body with the same shape
+	uint32_t Shapes = 0;
+	uint32_t Rebuilds = 0;
+};
 
 
 class Physics {
@@ -27,49 +71,151 @@ public:
 	void UpdatePhysics();
 	void CreatePhysicsWorld();
 
+	// queued, removed and destroyed together at the start of the next step
 	void RemovePhysicsBody(JPH::BodyID bodyID);
 	void RemovePhysicsBody(JPH::Body* body);
+	// removes and destroys every body with one call each, body pointers are invalid after
+	void RemovePhysicsBodies(std::vector<JPH::BodyID>& body_ids);
 
-	JPH::PhysicsSystem* GetPhysicsSystem() const { return m_PhysicsSystem; }
+	// takes the body out of the simulation but keeps it allocated, used by prefab pools
+	void DeactivatePhysicsBody(JPH::Body* body);
+	// creates the body when the entity was inactive since before the world existed
+	void ActivatePhysicsBody  (Entity entity);
 
-	void DeferOnExit(JPH::BodyID a, JPH::BodyID b);
-	void DeferOnEnter(const JPH::Body& a, const JPH::Body& b);
+	JPH::PhysicsSystem* GetPhysicsSystem() const { return m_PhysicsSystem; }
 
 	RaycastResult CastRay(const Raycast& ray);
+	// runs every query of the batch and fills its hits
+	void RunQueries(PhysicsQueryBatch& batch);
+
+	// moves the bodies' global transforms between the last two steps for rendering,
+	// alpha is how far the accumulator is into the next step.
+	// local transforms keep the stepped values, so scripts can write them
+	void InterpolateTransforms(float alpha);
+	// puts the stepped global transforms back, before scripts or the next step read them
+	void RestoreTransforms();
+
+	// the contact being reported to a script callback
+	const CollisionContact& GetCurrentContact() const { return m_current_contact; }
+
+	const PhysicsStats& GetStats() const { return m_stats; }
 
-	template<typename T>
 	void SyncTransforms();
+	void OnBodyConstruct(entt::registry& registry, entt::entity entity);
+	void CreateConstructedBodies();
+	void SetTransform(entt::entity entity, Component::Transform& tr, const glm::vec3& global_pos, const glm::quat& global_rot);
+	void RecordMotion(const JPH::BodyID& id, const glm::vec3& position, const glm::quat& rotation);
 private:
+	// global transform of the entity and its children only, what the renderer reads
+	void SetRenderTransform(entt::entity entity, Component::Transform& tr, const glm::vec3& global_pos, const glm::quat& global_rot);
 	void CreatePhysicsBody(Entity entity, const Component::Transform& tr, Component::RigidBody& body);
 	void CreatePhysicsBody(Entity entity, const Component::Transform& tr, Component::CollisionBody& body);
 	JPH::Ref<JPH::Shape> CreateShapeForBody(Entity entity);
-
-	void ProcessDeferredOnExitSignals();
-	void ProcessDeferredOnEnterSignals();
+	// invalid layers fall back to layer 0
+	JPH::ObjectLayer GetObjectLayer(Entity entity, uint16_t layer, JPH::BroadPhaseLayer broadphase);
+
+	struct BodyEntity {
+		entt::entity Entity = entt::null;
+		bool Sensor = false;
+		// position in m_active_bodies
+		uint32_t ActiveSlot = INACTIVE;
+		static constexpr uint32_t INACTIVE = 0xFFFFFFFF;
+	};
+	// indexed by JPH::BodyID::GetIndex, entries stay after the body is destroyed
+	// so contacts removed in the next step still find their entities
+	const BodyEntity& GetBodyEntity(const JPH::BodyID& id) const;
+	void SetBodyEntity(const JPH::BodyID& id, entt::entity entity, bool sensor);
+
+	// called from jolt's worker threads
+	void PushActivationChange(const JPH::BodyID& id, bool active);
+	void ApplyActivationChanges();
+	void ClearActiveBodies();
+
+	// called from jolt's worker threads
+	void PushContactEvent(const ContactEvent& event);
+	void ProcessContactEvents();
+	void RunQuery(const PhysicsQuery& query, std::vector<PhysicsQueryHit>& hits) const;
+	void DispatchContactEvent(const ContactEvent& event, bool enter);
+
+	// bodies are created right away but added to the broadphase in one batch
+	void AddPendingBodies();
+	void RemovePendingBodies();
+
+	void CreatePhysicsSystem();
+	// recreates the physics system with the current capacity, bodies keep their state
+	void RebuildPhysicsSystem();
+	void GrowIfNeeded(JPH::EPhysicsUpdateError errors);
+	void UpdateStats();
 
 private:
 	JPH::PhysicsSystem* m_PhysicsSystem = nullptr;
-	JPH::JobSystemThreadPool* m_job_system;
-	JPH::TempAllocator * m_temp_allocator = nullptr;
+	Scope<PhysicsJobSystem> m_job_system;
+	Scope<PhysicsTempAllocator> m_temp_allocator;
+	PhysicsShapeCache m_shape_cache;
 
 	entt::registry* m_Registry = nullptr;
 	class Scene* m_Scene = nullptr;
 
 
-	const int m_max_bodies = 1024;
+	PhysicsCapacityConfig m_capacity;
 	const int m_num_body_mutexes = 0;
-	const int m_max_body_pairs = 4096;
-	const int m_max_contact_constraints = 4096;
+	bool m_rebuild_requested = false;
+	uint32_t m_failed_bodies = 0;
+
+	std::atomic<uint32_t> m_step_contacts { 0 };
+
+	std::vector<JPH::BodyID> m_pending_adds_active;
+	std::vector<JPH::BodyID> m_pending_adds_inactive;
+	std::vector<JPH::BodyID> m_pending_removes;
+	PhysicsStats m_stats;
+
+	uint16_t m_layer_count = 0;
 
 	JPH::BroadPhaseLayerInterface*      m_broad_phase_layer_interface;
 	JPH::ObjectVsBroadPhaseLayerFilter* m_object_vs_broadphase_layer_filter;
 	JPH::ObjectLayerPairFilter*         m_object_vs_object_layer_filter;
 	JPH::ContactListener*               m_contact_listener;
-
-	std::vector<std::pair<JPH::BodyID, JPH::BodyID>> m_DeferredOnExits = {};
-	std::vector<std::pair<const JPH::Body*, const JPH::Body*>> m_DeferredOnEnters = {};
-	std::mutex m_DeferredOnExitMutex;
-	std::mutex m_DeferredOnEnterMutex;
+	JPH::BodyActivationListener*        m_activation_listener;
+
+	std::vector<BodyEntity> m_body_entities;
+
+	// bodies jolt is simulating, kept by the activation listener
+	std::vector<JPH::BodyID> m_active_bodies;
+	std::vector<JPH::BodyID> m_fell_asleep;
+	std::vector<std::pair<JPH::BodyID, bool>> m_activation_changes;
+	std::vector<std::pair<JPH::BodyID, bool>> m_applied_activation_changes;
+	std::mutex m_activation_mutex;
+
+	// body components added while the world exists
+	std::vector<entt::entity> m_constructed_bodies;
+
+	// last two stepped transforms, indexed like m_body_entities
+	struct BodyMotion {
+		glm::vec3 PreviousPosition = glm::vec3(0.0f);
+		glm::vec3 Position         = glm::vec3(0.0f);
+		glm::quat PreviousRotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		glm::quat Rotation         = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		uint32_t Step = 0;
+	};
+	std::vector<BodyMotion> m_body_motions;
+	// bodies that moved in the last step
+	std::vector<uint32_t> m_moved_bodies;
+	uint32_t m_step_index = 1;
+	bool m_transforms_interpolated = false;
+	PhysicsInterpolation m_interpolation = PhysicsInterpolation::INTERPOLATE;
+
+	// filled without locks by the contact listener, overflow is rare and takes the mutex
+	std::vector<ContactEvent> m_contact_events;
+	std::atomic<uint32_t> m_contact_event_count { 0 };
+	std::vector<ContactEvent> m_contact_overflow;
+	std::mutex m_contact_overflow_mutex;
+
+	// touching sub shape pairs per entity pair
+	std::unordered_map<uint64_t, uint32_t> m_contact_pairs;
+	CollisionContact m_current_contact;
+
+	friend class MyContactListener;
+	friend class MyBodyActivationListener;
 
 };
 
@@ -0,0 +1,52 @@
+#include "physics_job_system.h"
+
+namespace Enik {
+
+PhysicsJobSystem::PhysicsJobSystem(Enik::JobSystem& job_system, JPH::uint max_jobs, JPH::uint max_barriers, int max_concurrency)
+	: JPH::JobSystemWithBarrier(max_barriers), m_JobSystem(job_system), m_MaxConcurrency(max_concurrency) {
+	m_Jobs.Init(max_jobs, max_jobs);
+}
+
+JPH::JobSystem::JobHandle PhysicsJobSystem::CreateJob(const char* name, JPH::ColorArg color, const JobFunction& function, JPH::uint32 num_dependencies) {
+	JPH::uint32 index;
+	bool warned = false;
+	while (true) {
+		index = m_Jobs.ConstructObject(name, color, this, function, num_dependencies);
+		if (index != JPH::FixedSizeFreeList<Job>::cInvalidObjectIndex) {
+			break;
+		}
+		if (not warned) {
+			EN_CORE_WARN("PhysicsJobSystem: out of jobs, waiting for one to be freed");
+			warned = true;
+		}
+		std::this_thread::yield();
+	}
+	Job* job = &m_Jobs.Get(index);
+
+	// NOTE: handle keeps a reference, the job may finish before we return
+	JobHandle handle(job);
+	if (num_dependencies == 0) {
+		QueueJob(job);
+	}
+	return handle;
+}
+
+void PhysicsJobSystem::QueueJob(Job* job) {
+	job->AddRef();
+	m_JobSystem.Submit([job]() {
+		job->Execute();
+		job->Release();
+	});
+}
+
+void PhysicsJobSystem::QueueJobs(Job** jobs, JPH::uint count) {
+	for (JPH::uint i = 0; i < count; i++) {
+		QueueJob(jobs[i]);
+	}
+}
+
+void PhysicsJobSystem::FreeJob(Job* job) {
+	m_Jobs.DestructObject(job);
+}
+
+}
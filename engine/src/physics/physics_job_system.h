@@ -0,0 +1,34 @@
+#pragma once
+#include "base.h"
+#include "core/job_system.h"
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/FixedSizeFreeList.h>
+#include <Jolt/Core/JobSystemWithBarrier.h>
+
+namespace Enik {
+
+// runs jolt jobs on the engine job system instead of a separate thread pool
+class PhysicsJobSystem final : public JPH::JobSystemWithBarrier {
+public:
+	// max_concurrency 0 uses every worker
+	PhysicsJobSystem(Enik::JobSystem& job_system, JPH::uint max_jobs, JPH::uint max_barriers, int max_concurrency = 0);
+	virtual ~PhysicsJobSystem() override = default;
+
+	// jolt splits its work by this, workers and the thread waiting on the barrier by default
+	virtual int GetMaxConcurrency() const override { return m_MaxConcurrency > 0 ? m_MaxConcurrency : (int)m_JobSystem.GetWorkerCount() + 1; }
+
+	virtual JobHandle CreateJob(const char* name, JPH::ColorArg color, const JobFunction& function, JPH::uint32 num_dependencies = 0) override;
+
+protected:
+	virtual void QueueJob(Job* job) override;
+	virtual void QueueJobs(Job** jobs, JPH::uint count) override;
+	virtual void FreeJob(Job* job) override;
+
+private:
+	Enik::JobSystem& m_JobSystem;
+	int m_MaxConcurrency = 0;
+	JPH::FixedSizeFreeList<Job> m_Jobs;
+};
+
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "scene/entity.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace Enik {
+
+enum class PhysicsQueryType : uint8_t {
+	RAY,
+	SHAPE_CAST,
+	OVERLAP,
+};
+
+enum class PhysicsQueryShape : uint8_t {
+	NONE,
+	CIRCLE,
+	BOX,
+};
+
+struct PhysicsQuery {
+	PhysicsQueryType  type  = PhysicsQueryType::RAY;
+	PhysicsQueryShape shape = PhysicsQueryShape::NONE;
+	// every hit sorted by fraction instead of only the closest, overlaps always return every hit
+	bool all_hits = false;
+	bool include_sensors = false;
+	// bit i set hits bodies on physics layer i
+	uint16_t layer_mask = 0xFFFF;
+
+	glm::vec3 origin = glm::vec3(0.0f);
+	// direction and length of rays and shape casts
+	glm::vec3 dir = glm::vec3(0.0f);
+	// circle radius in x, box half extent
+	glm::vec3 size = glm::vec3(0.0f);
+	glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+};
+
+struct PhysicsQueryHit {
+	Entity entity;
+	glm::vec3 point;
+	// points out of the surface that was hit
+	glm::vec3 normal;
+	// along dir, 0 for overlaps
+	float fraction;
+};
+
+// queries are collected during the frame and run together with ScriptableEntity::RunQueries,
+// spread over the job system against the world as it is between steps
+class PhysicsQueryBatch {
+public:
+	// every Add returns the index of the query, used to read its hits
+	uint32_t Add(const PhysicsQuery& query) {
+		m_Queries.push_back(query);
+		return (uint32_t)m_Queries.size() - 1;
+	}
+
+	uint32_t AddRay(const glm::vec3& origin, const glm::vec3& dir, uint16_t layer_mask = 0xFFFF, bool all_hits = false) {
+		PhysicsQuery query;
+		query.origin = origin;
+		query.dir = dir;
+		query.layer_mask = layer_mask;
+		query.all_hits = all_hits;
+		return Add(query);
+	}
+
+	uint32_t AddCircleCast(const glm::vec3& origin, float radius, const glm::vec3& dir, uint16_t layer_mask = 0xFFFF, bool all_hits = false) {
+		PhysicsQuery query;
+		query.type = PhysicsQueryType::SHAPE_CAST;
+		query.shape = PhysicsQueryShape::CIRCLE;
+		query.origin = origin;
+		query.dir = dir;
+		query.size = glm::vec3(radius);
+		query.layer_mask = layer_mask;
+		query.all_hits = all_hits;
+		return Add(query);
+	}
+
+	uint32_t AddBoxCast(const glm::vec3& origin, const glm::vec3& half_extent, const glm::quat& rotation, const glm::vec3& dir, uint16_t layer_mask = 0xFFFF, bool all_hits = false) {
+		PhysicsQuery query;
+		query.type = PhysicsQueryType::SHAPE_CAST;
+		query.shape = PhysicsQueryShape::BOX;
+		query.origin = origin;
+		query.dir = dir;
+		query.size = half_extent;
+		query.rotation = rotation;
+		query.layer_mask = layer_mask;
+		query.all_hits = all_hits;
+		return Add(query);
+	}
+
+	uint32_t AddCircleOverlap(const glm::vec3& center, float radius, uint16_t layer_mask = 0xFFFF, bool include_sensors = false) {
+		PhysicsQuery query;
+		query.type = PhysicsQueryType::OVERLAP;
+		query.shape = PhysicsQueryShape::CIRCLE;
+		query.origin = center;
+		query.size = glm::vec3(radius);
+		query.layer_mask = layer_mask;
+		query.include_sensors = include_sensors;
+		return Add(query);
+	}
+
+	uint32_t AddBoxOverlap(const glm::vec3& center, const glm::vec3& half_extent, const glm::quat& rotation, uint16_t layer_mask = 0xFFFF, bool include_sensors = false) {
+		PhysicsQuery query;
+		query.type = PhysicsQueryType::OVERLAP;
+		query.shape = PhysicsQueryShape::BOX;
+		query.origin = center;
+		query.size = half_extent;
+		query.rotation = rotation;
+		query.layer_mask = layer_mask;
+		query.include_sensors = include_sensors;
+		return Add(query);
+	}
+
+	uint32_t GetQueryCount() const { return (uint32_t)m_Queries.size(); }
+
+	// hits of one query, closest first
+	uint32_t GetHitCount(uint32_t query) const { return query < m_Ranges.size() ? m_Ranges[query].count : 0; }
+	const PhysicsQueryHit* GetHits(uint32_t query) const { return m_Hits.data() + m_Ranges[query].first; }
+	bool HasHit(uint32_t query) const { return GetHitCount(query) > 0; }
+	const PhysicsQueryHit& GetClosestHit(uint32_t query) const { return m_Hits[m_Ranges[query].first]; }
+
+	// hits of every query in query order
+	const std::vector<PhysicsQueryHit>& GetAllHits() const { return m_Hits; }
+
+	// keeps the memory for the next frame
+	void Clear() {
+		m_Queries.clear();
+		m_Ranges.clear();
+		m_Hits.clear();
+	}
+
+private:
+	struct HitRange {
+		uint32_t first = 0;
+		uint32_t count = 0;
+	};
+
+	std::vector<PhysicsQuery> m_Queries;
+	std::vector<HitRange> m_Ranges;
+	std::vector<PhysicsQueryHit> m_Hits;
+	// hits per query while the batch runs
+	std::vector<std::vector<PhysicsQueryHit>> m_Scratch;
+
+	friend class Physics;
+};
+
+}
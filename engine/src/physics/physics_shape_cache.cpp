@@ -0,0 +1,183 @@
+#include "physics_shape_cache.h"
+
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <Jolt/Physics/Collision/Shape/ConvexHullShape.h>
+#include <Jolt/Physics/Collision/Shape/SphereShape.h>
+#include <Jolt/Physics/Collision/Shape/StaticCompoundShape.h>
+#include <Jolt/Physics/PhysicsSettings.h>
+
+namespace Enik {
+using namespace JPH;
+
+using ShapeType = Component::CollisionShape::Type;
+
+// parameters are stored in 1/1024 units
+static constexpr float QUANTIZE_SCALE = 1024.0f;
+
+// never a valid shape type, keeps compound keys apart from single shape keys
+static constexpr int32_t COMPOUND_KEY = -1;
+
+static int32_t Quantize(float value) {
+	return (int32_t)std::lround(value * QUANTIZE_SCALE);
+}
+static float Dequantize(int32_t value) {
+	return (float)value / QUANTIZE_SCALE;
+}
+
+static bool IsIdentity(const PhysicsShapePart& part) {
+	return part.Position == glm::vec3(0.0f) and part.Rotation == glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+}
+
+static JPH::Ref<Shape> CreateDefaultShape() {
+	return BoxShapeSettings(Vec3(0.5f, 0.5f, 0.5f)).Create().Get();
+}
+
+// builds the shape from the dequantized key, so it does not depend on which body asked first
+static JPH::Ref<Shape> CreateShapeFromKey(const int32_t* key) {
+	Shape::ShapeResult result;
+	switch ((ShapeType)key[0]) {
+		case ShapeType::BOX: {
+			Vec3 half_extent(Dequantize(key[1]), Dequantize(key[2]), Dequantize(key[3]));
+			const float convex_radius = std::min(cDefaultConvexRadius, half_extent.ReduceMin());
+			result = BoxShapeSettings(half_extent, std::max(convex_radius, 0.0f)).Create();
+			break;
+		}
+		case ShapeType::CIRCLE: {
+			result = SphereShapeSettings(Dequantize(key[1])).Create();
+			break;
+		}
+		case ShapeType::POLYGON: {
+			const float half_depth = Dequantize(key[1]);
+			const int32_t count = key[2];
+			if (count < 3) {
+				EN_CORE_ERROR("Polygon collision shape needs at least 3 points, has {}", count);
+				return CreateDefaultShape();
+			}
+
+			Array<Vec3> points;
+			points.reserve(count * 2);
+			for (int32_t i = 0; i < count; i++) {
+				const float x = Dequantize(key[3 + i * 2]);
+				const float y = Dequantize(key[4 + i * 2]);
+				points.push_back(Vec3(x, y,  half_depth));
+				points.push_back(Vec3(x, y, -half_depth));
+			}
+			result = ConvexHullShapeSettings(points).Create();
+			break;
+		}
+		case ShapeType::NONE:
+			return CreateDefaultShape();
+	}
+
+	if (result.HasError()) {
+		EN_CORE_ERROR("Could not create collision shape: {}", result.GetError().c_str());
+		return CreateDefaultShape();
+	}
+	return result.Get();
+}
+
+
+size_t PhysicsShapeCache::KeyHash::operator()(const Key& key) const {
+	// FNV-1a
+	uint64_t hash = 14695981039346656037ull;
+	for (int32_t value : key) {
+		hash ^= (uint32_t)value;
+		hash *= 1099511628211ull;
+	}
+	return (size_t)hash;
+}
+
+void PhysicsShapeCache::AppendPartKey(Key& key, const PhysicsShapePart& part) {
+	const ShapeType type = part.Shape ? part.Shape->Shape : ShapeType::NONE;
+	key.push_back((int32_t)type);
+
+	switch (type) {
+		case ShapeType::BOX: {
+			const glm::vec3 half_extent = part.Shape->BoxScale * part.Scale;
+			key.push_back(Quantize(half_extent.x));
+			key.push_back(Quantize(half_extent.y));
+			key.push_back(Quantize(half_extent.z));
+			break;
+		}
+		case ShapeType::CIRCLE: {
+			key.push_back(Quantize(part.Shape->CircleRadius * std::max(part.Scale.x, part.Scale.y)));
+			break;
+		}
+		case ShapeType::POLYGON: {
+			key.push_back(Quantize(0.5f * part.Scale.z));
+			key.push_back((int32_t)part.Shape->Points.size());
+			for (const glm::vec2& point : part.Shape->Points) {
+				key.push_back(Quantize(point.x * part.Scale.x));
+				key.push_back(Quantize(point.y * part.Scale.y));
+			}
+			break;
+		}
+		case ShapeType::NONE: break;
+	}
+}
+
+JPH::Ref<Shape> PhysicsShapeCache::Find(const Key& key) const {
+	auto it = m_Shapes.find(key);
+	return it != m_Shapes.end() ? it->second : nullptr;
+}
+
+JPH::Ref<Shape> PhysicsShapeCache::Insert(const Key& key, JPH::Ref<Shape> shape) {
+	m_Shapes.emplace(key, shape);
+	return shape;
+}
+
+JPH::Ref<Shape> PhysicsShapeCache::GetPartShape(const PhysicsShapePart& part) {
+	Key key;
+	AppendPartKey(key, part);
+	if (JPH::Ref<Shape> shape = Find(key)) {
+		return shape;
+	}
+	return Insert(key, CreateShapeFromKey(key.data()));
+}
+
+JPH::Ref<Shape> PhysicsShapeCache::GetShape(const std::vector<PhysicsShapePart>& parts) {
+	if (parts.empty()) {
+		return GetPartShape({});
+	}
+	if (parts.size() == 1 and IsIdentity(parts[0])) {
+		return GetPartShape(parts[0]);
+	}
+
+	Key key = { COMPOUND_KEY, (int32_t)parts.size() };
+	for (const PhysicsShapePart& part : parts) {
+		AppendPartKey(key, part);
+		key.push_back(Quantize(part.Position.x));
+		key.push_back(Quantize(part.Position.y));
+		key.push_back(Quantize(part.Position.z));
+		key.push_back(Quantize(part.Rotation.x));
+		key.push_back(Quantize(part.Rotation.y));
+		key.push_back(Quantize(part.Rotation.z));
+		key.push_back(Quantize(part.Rotation.w));
+	}
+	if (JPH::Ref<Shape> shape = Find(key)) {
+		return shape;
+	}
+
+	// sub shapes come from the cache too
+	StaticCompoundShapeSettings settings;
+	for (const PhysicsShapePart& part : parts) {
+		settings.AddShape(
+			Vec3(part.Position.x, part.Position.y, part.Position.z),
+			Quat(part.Rotation.x, part.Rotation.y, part.Rotation.z, part.Rotation.w),
+			GetPartShape(part)
+		);
+	}
+
+	Shape::ShapeResult result = settings.Create();
+	if (result.HasError()) {
+		EN_CORE_ERROR("Could not create compound collision shape: {}", result.GetError().c_str());
+		return Insert(key, CreateDefaultShape());
+	}
+	return Insert(key, result.Get());
+}
+
+void PhysicsShapeCache::Clear() {
+	m_Shapes.clear();
+}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include "base.h"
+#include "scene/components.h"
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Physics/Collision/Shape/Shape.h>
+
+namespace Enik {
+
+// a collision shape placed relative to the body
+struct PhysicsShapePart {
+	const Component::CollisionShape* Shape = nullptr;
+	glm::vec3 Scale    = glm::vec3(1.0f);
+	glm::vec3 Position = glm::vec3(0.0f);
+	glm::quat Rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+};
+
+// shapes are immutable, so bodies with the same shape parameters share one shape.
+// parameters are quantized to the key, tiny differences map to the same shape
+class PhysicsShapeCache {
+public:
+	// one part at the body origin is a plain shape, more parts make a compound shape
+	JPH::Ref<JPH::Shape> GetShape(const std::vector<PhysicsShapePart>& parts);
+
+	void Clear();
+	uint32_t GetShapeCount() const { return (uint32_t)m_Shapes.size(); }
+
+private:
+	using Key = std::vector<int32_t>;
+	struct KeyHash {
+		size_t operator()(const Key& key) const;
+	};
+
+	JPH::Ref<JPH::Shape> GetPartShape(const PhysicsShapePart& part);
+	JPH::Ref<JPH::Shape> Find(const Key& key) const;
+	JPH::Ref<JPH::Shape> Insert(const Key& key, JPH::Ref<JPH::Shape> shape);
+
+	static void AppendPartKey(Key& key, const PhysicsShapePart& part);
+
+private:
+	std::unordered_map<Key, JPH::Ref<JPH::Shape>, KeyHash> m_Shapes;
+};
+
+}
@@ -0,0 +1,68 @@
+#include "physics_temp_allocator.h"
+
+namespace Enik {
+
+static JPH::uint AlignSize(JPH::uint size) {
+	return (size + JPH_RVECTOR_ALIGNMENT - 1) & ~(JPH::uint)(JPH_RVECTOR_ALIGNMENT - 1);
+}
+
+PhysicsTempAllocator::PhysicsTempAllocator(JPH::uint size) {
+	Resize(size);
+}
+
+PhysicsTempAllocator::~PhysicsTempAllocator() {
+	EN_CORE_ASSERT(m_Top == 0, "PhysicsTempAllocator destroyed while in use");
+	JPH::AlignedFree(m_Base);
+}
+
+void* PhysicsTempAllocator::Allocate(JPH::uint size) {
+	if (size == 0) {
+		return nullptr;
+	}
+	const JPH::uint aligned = AlignSize(size);
+
+	m_Used += aligned;
+	m_StepHighWater = std::max(m_StepHighWater, m_Used);
+
+	if (m_Top + aligned > m_Size) {
+		m_StepFallbacks++;
+		return JPH::AlignedAllocate(aligned, JPH_RVECTOR_ALIGNMENT);
+	}
+
+	void* address = m_Base + m_Top;
+	m_Top += aligned;
+	return address;
+}
+
+void PhysicsTempAllocator::Free(void* address, JPH::uint size) {
+	if (address == nullptr) {
+		return;
+	}
+	const JPH::uint aligned = AlignSize(size);
+	m_Used -= aligned;
+
+	uint8_t* bytes = static_cast<uint8_t*>(address);
+	if (bytes < m_Base or bytes >= m_Base + m_Size) {
+		JPH::AlignedFree(address);
+		return;
+	}
+
+	// frees are in reverse order of allocations
+	EN_CORE_ASSERT(bytes + aligned == m_Base + m_Top, "PhysicsTempAllocator freed out of order");
+	m_Top -= aligned;
+}
+
+void PhysicsTempAllocator::Resize(JPH::uint size) {
+	EN_CORE_ASSERT(m_Top == 0 and m_Used == 0, "PhysicsTempAllocator resized while in use");
+	JPH::AlignedFree(m_Base);
+	m_Size = AlignSize(size);
+	m_Base = static_cast<uint8_t*>(JPH::AlignedAllocate(m_Size, JPH_RVECTOR_ALIGNMENT));
+}
+
+void PhysicsTempAllocator::ResetStepStats() {
+	m_PeakHighWater = std::max(m_PeakHighWater, m_StepHighWater);
+	m_StepHighWater = 0;
+	m_StepFallbacks = 0;
+}
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "base.h"
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/TempAllocator.h>
+
+namespace Enik {
+
+// stack allocator for jolt's per step allocations, like JPH::TempAllocatorImpl
+// but it tracks the high water mark and falls back to the heap instead of crashing when full
+class PhysicsTempAllocator final : public JPH::TempAllocator {
+public:
+	explicit PhysicsTempAllocator(JPH::uint size);
+	virtual ~PhysicsTempAllocator() override;
+
+	virtual void* Allocate(JPH::uint size) override;
+	virtual void  Free(void* address, JPH::uint size) override;
+
+	// only valid between steps, when nothing is allocated
+	void Resize(JPH::uint size);
+
+	// clears the step high water mark and fallback count
+	void ResetStepStats();
+
+	JPH::uint GetSize()               const { return m_Size; }
+	JPH::uint GetStepHighWater()      const { return m_StepHighWater; }
+	JPH::uint GetPeakHighWater()      const { return m_PeakHighWater; }
+	JPH::uint GetStepFallbackCount()  const { return m_StepFallbacks; }
+
+private:
+	uint8_t*  m_Base = nullptr;
+	JPH::uint m_Size = 0;
+	JPH::uint m_Top  = 0;
+
+	// includes heap fallbacks, so it shows how big the buffer should be
+	JPH::uint m_Used = 0;
+	JPH::uint m_StepHighWater = 0;
+	JPH::uint m_PeakHighWater = 0;
+	JPH::uint m_StepFallbacks = 0;
+};
+
+}
@@ -10,6 +10,30 @@
 
 namespace Enik {
 
+// a body on a layer collides with a body on another layer only when both layers list each other
+struct PhysicsLayerConfig {
+	std::string name;
+	uint16_t collides_with = 0xFFFF;
+};
+constexpr uint16_t MAX_PHYSICS_LAYERS = 16;
+
+// starting capacities of a scene's physics world, it grows past these when needed
+struct PhysicsCapacityConfig {
+	uint32_t max_bodies = 1024;
+	uint32_t max_body_pairs = 4096;
+	uint32_t max_contact_constraints = 4096;
+	uint32_t temp_allocator_size = 32 * 1024 * 1024;
+};
+
+// how bodies are drawn between fixed steps
+enum class PhysicsInterpolation : uint8_t {
+	NONE,
+	// smooth, one step behind the simulation
+	INTERPOLATE,
+	// no lag, but overshoots when bodies change direction
+	EXTRAPOLATE,
+};
+
 struct ProjectConfig {
 	std::string project_name = "untitled project";
 	std::filesystem::path start_scene;
@@ -17,6 +41,16 @@ struct ProjectConfig {
 	std::filesystem::path script_module_path;
 	std::vector<std::filesystem::path> autoloads;
 	std::vector<std::filesystem::path> open_assets;
+
+	std::vector<PhysicsLayerConfig> physics_layers = {
+		{ "Static", 0b10 },
+		{ "Moving", 0b11 },
+	};
+	PhysicsCapacityConfig physics_capacity;
+	PhysicsInterpolation physics_interpolation = PhysicsInterpolation::INTERPOLATE;
+
+	// same inputs give the same simulation, see Scene::GetStateHash
+	bool deterministic = false;
 };
 
 class Project {
@@ -7,6 +7,21 @@
 
 namespace Enik {
 
+static const char* PhysicsInterpolationToString(PhysicsInterpolation interpolation) {
+	switch (interpolation) {
+		case PhysicsInterpolation::NONE:        return "None";
+		case PhysicsInterpolation::INTERPOLATE: return "Interpolate";
+		case PhysicsInterpolation::EXTRAPOLATE: return "Extrapolate";
+	}
+	return "Interpolate";
+}
+
+static PhysicsInterpolation PhysicsInterpolationFromString(const std::string& string) {
+	if (string == "None")        { return PhysicsInterpolation::NONE; }
+	if (string == "Extrapolate") { return PhysicsInterpolation::EXTRAPOLATE; }
+	return PhysicsInterpolation::INTERPOLATE;
+}
+
 ProjectSerializer::ProjectSerializer(Ref<Project>& project)
 	: m_Project(project) {
 
@@ -42,6 +57,32 @@ void ProjectSerializer::Serialize(std::filesystem::path path) {
 	}
 	out << YAML::EndSeq;
 
+	out << YAML::Key << "PhysicsLayers";
+	out << YAML::Value << YAML::BeginSeq;
+	for (const PhysicsLayerConfig& layer : config.physics_layers) {
+		out << YAML::BeginMap;
+		out << YAML::Key << "Name" << YAML::Value << layer.name;
+		out << YAML::Key << "CollidesWith" << YAML::Value << YAML::Flow << YAML::BeginSeq;
+		for (size_t i = 0; i < config.physics_layers.size(); ++i) {
+			if (layer.collides_with & (1 << i)) {
+				out << config.physics_layers[i].name;
+			}
+		}
+		out << YAML::EndSeq;
+		out << YAML::EndMap;
+	}
+	out << YAML::EndSeq;
+
+	out << YAML::Key << "PhysicsCapacity" << YAML::Value << YAML::BeginMap;
+	out << YAML::Key << "MaxBodies"             << YAML::Value << config.physics_capacity.max_bodies;
+	out << YAML::Key << "MaxBodyPairs"          << YAML::Value << config.physics_capacity.max_body_pairs;
+	out << YAML::Key << "MaxContactConstraints" << YAML::Value << config.physics_capacity.max_contact_constraints;
+	out << YAML::Key << "TempAllocatorSize"     << YAML::Value << config.physics_capacity.temp_allocator_size;
+	out << YAML::EndMap;
+
+	out << YAML::Key << "PhysicsInterpolation" << YAML::Value << PhysicsInterpolationToString(config.physics_interpolation);
+	out << YAML::Key << "Deterministic" << YAML::Value << config.deterministic;
+
 
 	out << YAML::EndMap;
 
@@ -99,6 +140,49 @@ bool ProjectSerializer::Deserialize(std::filesystem::path path) {
 		}
 	}
 
+	if (auto pl = data["PhysicsLayers"]) {
+		if (pl.size() > MAX_PHYSICS_LAYERS) {
+			EN_CORE_WARN("Project has {} physics layers, only the first {} are used", pl.size(), MAX_PHYSICS_LAYERS);
+		}
+		const size_t count = std::min<size_t>(pl.size(), MAX_PHYSICS_LAYERS);
+
+		config.physics_layers.clear();
+		for (size_t i = 0; i < count; ++i) {
+			config.physics_layers.push_back({ pl[i]["Name"].as<std::string>(), 0 });
+		}
+
+		// layers are referenced by name, so they can be listed before they are defined
+		for (size_t i = 0; i < count; ++i) {
+			auto collides_with = pl[i]["CollidesWith"];
+			for (size_t j = 0; collides_with and j < collides_with.size(); ++j) {
+				const std::string name = collides_with[j].as<std::string>();
+				auto it = std::find_if(config.physics_layers.begin(), config.physics_layers.end(), [&](const PhysicsLayerConfig& layer) {
+					return layer.name == name;
+				});
+				if (it == config.physics_layers.end()) {
+					EN_CORE_WARN("Physics layer '{}' collides with unknown layer '{}'", config.physics_layers[i].name, name);
+					continue;
+				}
+				config.physics_layers[i].collides_with |= 1 << (it - config.physics_layers.begin());
+			}
+		}
+	}
+
+	if (auto pc = data["PhysicsCapacity"]) {
+		auto& capacity = config.physics_capacity;
+		if (pc["MaxBodies"])             { capacity.max_bodies              = pc["MaxBodies"].as<uint32_t>(); }
+		if (pc["MaxBodyPairs"])          { capacity.max_body_pairs          = pc["MaxBodyPairs"].as<uint32_t>(); }
+		if (pc["MaxContactConstraints"]) { capacity.max_contact_constraints = pc["MaxContactConstraints"].as<uint32_t>(); }
+		if (pc["TempAllocatorSize"])     { capacity.temp_allocator_size     = pc["TempAllocatorSize"].as<uint32_t>(); }
+	}
+
+	if (auto pi = data["PhysicsInterpolation"]) {
+		config.physics_interpolation = PhysicsInterpolationFromString(pi.as<std::string>());
+	}
+	if (auto d = data["Deterministic"]) {
+		config.deterministic = d.as<bool>();
+	}
+
 
 	EN_CORE_INFO("Deserialized project '{}', in {}", config.project_name, path);
 
@@ -6,5 +6,6 @@ namespace Enik {
 
 RendererAPI::API RendererAPI::s_API = RendererAPI::API::OpenGL;
 RendererAPI::API RendererAPI::GetAPI() { return RendererAPI::s_API; }
+void RendererAPI::SetAPI(API api) { RendererAPI::s_API = api; }
 
 }
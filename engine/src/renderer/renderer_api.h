@@ -25,6 +25,8 @@ public:
 	virtual void DrawLine(const Ref<VertexArray>& vertex_array, uint32_t vertex_count) = 0;
 
 	static API GetAPI();
+	// None runs without a graphics context, gpu resources are not created
+	static void SetAPI(API api);
 
 private:
 	static API s_API;
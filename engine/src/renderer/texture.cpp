@@ -10,7 +10,7 @@ Ref<Texture2D> Texture2D::Create(const TextureSpecification& specification, Buff
 			return CreateRef<OpenGLTexture2D>(specification, data);
 
 		case RendererAPI::API::None:
-			EN_CORE_ASSERT(false, "RendererAPI::None is currently not supported");
+			// headless, nothing is drawn
 			return nullptr;
 
 		default:
@@ -7,171 +7,62 @@
 #include "audio/audio.h"
 #include "project/project.h"
 #include "script_system/script_system.h"
+#include "script_system/script_registry.h"
 
 namespace Enik {
 
 // NativeScript
-void copy_saved_value_to_instance(NativeScriptField& instance_field, NativeScriptField& saved_field) {
-	switch (instance_field.Type) {
-		case FieldType::NONE: {
-			EN_CORE_ERROR("copy_saved_value_to_instance instance_field.Type is NONE !");
-			return;
-		}
-		case FieldType::BOOL: {
-			bool* instance_value = static_cast<bool*>(instance_field.Value);
-			bool*    saved_value = static_cast<bool*>(saved_field.Value);
-			*instance_value = *saved_value;
-			delete saved_value;
-			return;
-		}
-		case FieldType::INT: {
-			int* instance_value = static_cast<int*>(instance_field.Value);
-			int*    saved_value = static_cast<int*>(saved_field.Value);
-			*instance_value = *saved_value;
-			delete saved_value;
-			return;
-		}
-		case FieldType::FLOAT: {
-			float* instance_value = static_cast<float*>(instance_field.Value);
-			float*    saved_value = static_cast<float*>(saved_field.Value);
-			*instance_value = *saved_value;
-			delete saved_value;
-			return;
-		}
-		case FieldType::DOUBLE: {
-			double* instance_value = static_cast<double*>(instance_field.Value);
-			double*    saved_value = static_cast<double*>(saved_field.Value);
-			*instance_value = *saved_value;
-			delete saved_value;
-			return;
-		}
-		case FieldType::VEC2: {
-			glm::vec2* instance_value = static_cast<glm::vec2*>(instance_field.Value);
-			glm::vec2*    saved_value = static_cast<glm::vec2*>(saved_field.Value);
-			*instance_value = *saved_value;
-			delete saved_value;
-			return;
-		}
-		case FieldType::VEC3: {
-			glm::vec3* instance_value = static_cast<glm::vec3*>(instance_field.Value);
-			glm::vec3*    saved_value = static_cast<glm::vec3*>(saved_field.Value);
-			*instance_value = *saved_value;
-			delete saved_value;
-			return;
-		}
-		case FieldType::VEC4: {
-			glm::vec4* instance_value = static_cast<glm::vec4*>(instance_field.Value);
-			glm::vec4*    saved_value = static_cast<glm::vec4*>(saved_field.Value);
-			*instance_value = *saved_value;
-			delete saved_value;
-			return;
-		}
-		case FieldType::PREFAB:
-		case FieldType::STRING: {
-			std::string* instance_value = static_cast<std::string*>(instance_field.Value);
-			std::string*    saved_value = static_cast<std::string*>(saved_field.Value);
-			*instance_value = *saved_value;
-			delete saved_value;
-			return;
-		}
-		case FieldType::ENTITY: {
-			uint64_t* instance_value = static_cast<uint64_t*>(instance_field.Value);
-			uint64_t*    saved_value = static_cast<uint64_t*>(saved_field.Value);
-			*instance_value = *saved_value;
-			delete saved_value;
-			return;
-		}
+void* Component::NativeScript::GetFieldValue(const ScriptFieldInfo& field) {
+	if (Instance) {
+		return reinterpret_cast<uint8_t*>(Instance) + field.InstanceOffset;
 	}
+	return FieldValues.Get(field);
 }
 
 void Component::NativeScript::ApplyNativeScriptFieldsToInstance() {
 	EN_CORE_ASSERT(Instance, "ApplyNativeScriptFieldsToInstance Instance is null !");
 
-	for (auto& instance_field : Instance->OnEditorGetFields()) {
-		if (NativeScriptFields.find(instance_field.Name) != NativeScriptFields.end()) {
-			auto& saved_field = NativeScriptFields[instance_field.Name];
-			if (saved_field.Value != nullptr) {
-				copy_saved_value_to_instance(instance_field, saved_field);
-			}
-			saved_field.Value = instance_field.Value;
-		}
-	}
-}
-
-void* create_new_value_for_field(FieldType field_type, void* field_default) {
-	switch (field_type) {
-		case FieldType::NONE: {
-			EN_CORE_ERROR("create_new_value_for_field field_type is NONE !");
-			return nullptr;
-		}
-		case FieldType::BOOL:   return static_cast<void*>(new bool       (*(bool*       )field_default));
-		case FieldType::INT:    return static_cast<void*>(new int        (*(int*        )field_default));
-		case FieldType::FLOAT:  return static_cast<void*>(new float      (*(float*      )field_default));
-		case FieldType::DOUBLE: return static_cast<void*>(new double     (*(double*     )field_default));
-		case FieldType::VEC2:   return static_cast<void*>(new glm::vec2  (*(glm::vec2*  )field_default));
-		case FieldType::VEC3:   return static_cast<void*>(new glm::vec3  (*(glm::vec3*  )field_default));
-		case FieldType::VEC4:   return static_cast<void*>(new glm::vec4  (*(glm::vec4*  )field_default));
-		case FieldType::PREFAB:
-		case FieldType::STRING: return static_cast<void*>(new std::string(*(std::string*)field_default));
-		case FieldType::ENTITY: return static_cast<void*>(new uint64_t   (*(uint64_t*   )field_default));
-	}
-	return nullptr;
-}
-void delete_field_value(FieldType field_type, void* field_value) {
-	if (!field_value) return;
-	switch (field_type) {
-		case FieldType::NONE: {
-			EN_CORE_ERROR("delete_field_value field_type is NONE !");
-			return;
-		}
-		case FieldType::BOOL:   delete static_cast<bool*>       (field_value); return;
-		case FieldType::INT:    delete static_cast<int*>        (field_value); return;
-		case FieldType::FLOAT:  delete static_cast<float*>      (field_value); return;
-		case FieldType::DOUBLE: delete static_cast<double*>     (field_value); return;
-		case FieldType::VEC2:   delete static_cast<glm::vec2*>  (field_value); return;
-		case FieldType::VEC3:   delete static_cast<glm::vec3*>  (field_value); return;
-		case FieldType::VEC4:   delete static_cast<glm::vec4*>  (field_value); return;
-		case FieldType::PREFAB:
-		case FieldType::STRING: delete static_cast<std::string*>(field_value); return;
-		case FieldType::ENTITY: delete static_cast<uint64_t*>   (field_value); return;
+	if (FieldSchema) {
+		FieldSchema->ApplyToInstance(FieldValues, Instance);
 	}
 }
 
 
-void Component::NativeScript::Bind(const std::string& script_name, const std::function<ScriptableEntity*()>& inst) {
-	ScriptName = script_name;
-
-	InstantiateScript = inst;
+void Component::NativeScript::Bind(const ScriptClass& script_class) {
+	ScriptName = script_class.Name;
+	ClassID = script_class.ID;
+	Callbacks = script_class.Callbacks;
 
-	DestroyScript = [](NativeScript* ns) {
+	const ScriptClassID id = script_class.ID;
+	const bool pooled = script_class.Construct != nullptr;
 
-		// delete fields
-		for (auto& val : ns->NativeScriptFields) {
-			auto& field = val.second;
-			if (field.Value != nullptr) {
-				delete_field_value(field.Type, field.Value);
-				field.Value = nullptr;
-			}
-		}
+	InstantiateScript = [id, pooled]() {
+		return ScriptRegistry::CreateInstance(id, pooled);
+	};
 
-		if (ns->Instance) delete ns->Instance;
+	DestroyScript = [pooled](NativeScript* ns) {
+		ScriptRegistry::DestroyInstance(ns->ClassID, ns->Instance, pooled);
 		ns->Instance = nullptr;
 	};
 
+	FieldSchema = ScriptRegistry::GetFieldSchema(id);
+	if (FieldSchema) {
+		FieldValues = FieldSchema->Defaults;
+	}
+}
 
+void Component::NativeScript::BindCopy(const NativeScript& other) {
+	ScriptName = other.ScriptName;
+	ClassID = other.ClassID;
+	Callbacks = other.Callbacks;
+	InstantiateScript = other.InstantiateScript;
+	DestroyScript = other.DestroyScript;
 
-
-
-	// retrieve fields of the script from a temporary instance
-	ScriptableEntity* temp_instance = InstantiateScript();
-	for (auto field : temp_instance->OnEditorGetFields()) {
-		NativeScriptFields[field.Name] = NativeScriptField(
-			field.Name,
-			field.Type,
-			create_new_value_for_field(field.Type, field.Value)
-		);
+	FieldSchema = other.FieldSchema;
+	FieldValues = other.FieldValues;
+	if (FieldSchema and other.Instance) {
+		FieldSchema->CaptureFromInstance(FieldValues, other.Instance);
 	}
-	delete temp_instance;
 }
 
 
@@ -361,14 +252,24 @@ void Component::AnimationPlayer::Update(const Timestep& dt) {
 			CurrentTime = 0.0f;
 		} else {
 			Paused = true;
-			if (OnEndCallback) {
-				OnEndCallback(anim->Name);
-				OnEndCallback = nullptr;
-			}
+			EndedAnimation = anim->Name;
 		}
 	}
 }
 
+void Component::AnimationPlayer::CallOnEndCallback() {
+	if (EndedAnimation.empty()) {
+		return;
+	}
+	std::string name = std::move(EndedAnimation);
+	EndedAnimation.clear();
+	if (OnEndCallback) {
+		auto callback = std::move(OnEndCallback);
+		OnEndCallback = nullptr;
+		callback(name);
+	}
+}
+
 namespace Component {
 
 
@@ -433,14 +334,15 @@ glm::vec3 PhysicsBodyBase::GetAngularVelocity() const {
 	return glm::vec3(0.0f);
 }
 
+// moving a body wakes it and updates the broad phase, so unchanged values are not pushed
 void PhysicsBodyBase::SetPosition(const glm::vec3& position) {
-	if (body) {
+	if (body and body->GetPosition() != JPH::RVec3(position.x, position.y, position.z)) {
 		GetBodyInterface().SetPosition(body->GetID(), {position.x, position.y, position.z}, JPH::EActivation::Activate);
 	}
 }
 
 void PhysicsBodyBase::SetRotation(const glm::quat& rotation) {
-	if (body) {
+	if (body and body->GetRotation() != JPH::Quat(rotation.x, rotation.y, rotation.z, rotation.w)) {
 		GetBodyInterface().SetRotation(body->GetID(), {rotation.x, rotation.y, rotation.z, rotation.w}, JPH::EActivation::Activate);
 	}
 }
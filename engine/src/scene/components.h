@@ -19,6 +19,7 @@ namespace Enik {
 
 class ScriptableEntity;
 class Entity;
+struct ScriptClass;
 
 namespace Component {
 
@@ -105,11 +106,22 @@ struct NativeScript {
 	std::function<void(NativeScript*)> DestroyScript;
 
 	std::string ScriptName;
+	ScriptClassID ClassID = INVALID_SCRIPT_CLASS;
 
-	std::map<std::string, NativeScriptField> NativeScriptFields;
+	// callbacks the script class overrides, scene only dispatches these
+	ScriptCallbackFlags Callbacks = SCRIPT_CALLBACKS_ALL;
+
+	// shared by every entity with this script
+	Ref<const ScriptFieldSchema> FieldSchema;
+	// saved values, the instance holds the current ones once it exists
+	ScriptFieldValues FieldValues;
+	// current value, points into the instance when there is one
+	void* GetFieldValue(const ScriptFieldInfo& field);
 	void ApplyNativeScriptFieldsToInstance();
 
-	void Bind(const std::string& script_name, const std::function<ScriptableEntity*()>& inst);
+	void Bind(const ScriptClass& script_class);
+	// binds the same script as other without a temporary instance, field values are copied
+	void BindCopy(const NativeScript& other);
 };
 
 
@@ -182,11 +194,13 @@ struct CollisionBody : PhysicsBodyBase {
 };
 
 
+// child entities with a CollisionShape and no body of their own
+// are added to their parent's body as a compound shape
 struct CollisionShape {
 	JPH::Ref<JPH::Shape> shape = nullptr;
 
 	enum class Type {
-		NONE, BOX, CIRCLE
+		NONE, BOX, CIRCLE, POLYGON
 	};
 	Type Shape = Type::BOX;
 
@@ -200,6 +214,9 @@ struct CollisionShape {
 		float CircleRadius;
 	};
 
+	// convex polygon in local space, extruded along z
+	std::vector<glm::vec2> Points;
+
 	CollisionShape() = default;
 	CollisionShape(const CollisionShape&) = default;
 
@@ -207,17 +224,19 @@ struct CollisionShape {
 
 	static std::string TypeToString(Type shape) {
 		switch (shape) {
-			case Type::NONE:   return "NONE";
-			case Type::BOX:    return "Box";
-			case Type::CIRCLE: return "Circle";
+			case Type::NONE:    return "NONE";
+			case Type::BOX:     return "Box";
+			case Type::CIRCLE:  return "Circle";
+			case Type::POLYGON: return "Polygon";
 		}
 		return std::string();
 	}
 
 	static Type TypeFromString(const std::string& str) {
-		if      (str.empty())     { return Type::NONE; }
-		else if (str == "Box")    { return Type::BOX; }
-		else if (str == "Circle") { return Type::CIRCLE; }
+		if      (str.empty())      { return Type::NONE; }
+		else if (str == "Box")     { return Type::BOX; }
+		else if (str == "Circle")  { return Type::CIRCLE; }
+		else if (str == "Polygon") { return Type::POLYGON; }
 		return Type::NONE;
 	}
 };
@@ -282,6 +301,9 @@ struct AnimationPlayer {
 	bool Paused = false;
 
 	std::function<void(const std::string&)> OnEndCallback = nullptr;
+	// NOTE: Update can run on a worker thread, so it only records the ended animation
+	// and CallOnEndCallback calls the callback later on the main thread
+	std::string EndedAnimation = "";
 
 	void Start(const std::string& name);
 	// fast forwards to the end
@@ -290,6 +312,7 @@ struct AnimationPlayer {
 	void Kill();
 
 	void Update(const Timestep& dt);
+	void CallOnEndCallback();
 };
 
 
@@ -310,6 +333,14 @@ struct SceneControl {
 	bool AutoLoaded = false;
 };
 
+// skipped by rendering, physics, animations and scripts
+struct Inactive {};
+
+// root of a pooled prefab instance, destroying it returns it to the pool
+struct Pooled {
+	std::string PoolKey;
+};
+
 }
 
 }
@@ -108,6 +108,14 @@ public:
 		return m_Scene->InstantiatePrefab(path);
 	}
 
+	Entity SpawnFromPool(const std::filesystem::path& path) {
+		return m_Scene->SpawnFromPool(path);
+	}
+
+	void WarmPrefabPool(const std::filesystem::path& path, uint32_t count) {
+		m_Scene->WarmPrefabPool(path, count);
+	}
+
 	Entity FindEntityByUUID(UUID uuid) {
 		return m_Scene->FindEntityByUUID(uuid);
 	}
@@ -124,6 +132,11 @@ public:
 		m_Scene->ChangeScene(path);
 	}
 
+	void PreloadScene(const std::string& path) { m_Scene->PreloadScene(path); }
+	float GetPreloadProgress() const { return m_Scene->GetPreloadProgress(); }
+	bool IsPreloadReady() const { return m_Scene->IsPreloadReady(); }
+	void ActivatePreloaded() { m_Scene->ActivatePreloaded(); }
+
 private:
 	entt::entity m_Handle{entt::null};
 	Scene* m_Scene = nullptr;
@@ -0,0 +1,122 @@
+#include "entity_copy.h"
+
+namespace Enik {
+
+template <typename T>
+static T* CopyComponent(Entity from, Entity to) {
+	if (not from.Has<T>()) {
+		return nullptr;
+	}
+	T& component = to.GetOrAdd<T>();
+	component = from.Get<T>();
+	return &component;
+}
+
+static void CopyComponents(Entity from, Entity to, const UUIDMap& uuid_map) {
+	CopyComponent<Component::Transform>(from, to);
+
+	if (auto* sprite = CopyComponent<Component::SpriteRenderer>(from, to)) {
+		// scripts change tile indices per instance
+		if (sprite->SubTexture) {
+			sprite->SubTexture = CreateRef<SubTexture2D>(*sprite->SubTexture);
+		}
+	}
+
+	CopyComponent<Component::Camera>(from, to);
+
+	if (auto* body = CopyComponent<Component::RigidBody>(from, to)) {
+		body->body = nullptr;
+	}
+	if (auto* body = CopyComponent<Component::CollisionBody>(from, to)) {
+		body->body = nullptr;
+	}
+	if (auto* cs = CopyComponent<Component::CollisionShape>(from, to)) {
+		cs->shape = nullptr;
+	}
+
+	CopyComponent<Component::AudioSources>(from, to);
+
+	if (auto* ap = CopyComponent<Component::AnimationPlayer>(from, to)) {
+		ap->BoundEntity = nullptr;
+		ap->OnEndCallback = nullptr;
+		ap->EndedAnimation.clear();
+	}
+
+	CopyComponent<Component::Text>(from, to);
+	CopyComponent<Component::Prefab>(from, to);
+	CopyComponent<Component::SceneControl>(from, to);
+
+	if (from.Has<Component::NativeScript>()) {
+		auto& ns = to.GetOrAdd<Component::NativeScript>();
+		ns.BindCopy(from.Get<Component::NativeScript>());
+
+		if (not ns.FieldSchema) {
+			return;
+		}
+		for (const ScriptFieldInfo& field : ns.FieldSchema->Fields) {
+			if (field.Type != FieldType::ENTITY) {
+				continue;
+			}
+			uint64_t* value = static_cast<uint64_t*>(ns.FieldValues.Get(field));
+			auto it = uuid_map.find(*value);
+			if (it != uuid_map.end()) {
+				*value = it->second;
+			}
+		}
+	}
+}
+
+std::vector<Entity> CopyEntities(const std::vector<Entity>& entities, Scene* target, UUIDMap& uuid_map) {
+	EN_PROFILE_SCOPE;
+
+	// every uuid is mapped before copying, so entity fields can point to any copy
+	for (const Entity& entity : entities) {
+		uint64_t uuid = entity.GetID();
+		if (uuid_map.find(uuid) == uuid_map.end()) {
+			uuid_map[uuid] = UUID();
+		}
+	}
+
+	std::unordered_map<entt::entity, Entity> copies;
+	copies.reserve(entities.size());
+
+	std::vector<Entity> result;
+	result.reserve(entities.size());
+	for (const Entity& entity : entities) {
+		Entity copy = target->CreateEntityWithUUID(uuid_map[entity.GetID()], entity.GetTag());
+		CopyComponents(entity, copy, uuid_map);
+		copies[entity] = copy;
+		result.push_back(copy);
+	}
+
+	// keep the order of children
+	for (const Entity& entity : entities) {
+		if (not entity.Has<Component::Family>()) {
+			continue;
+		}
+		Entity parent_copy = copies[entity];
+		for (Entity& child : entity.Get<Component::Family>().Children) {
+			auto it = copies.find(child);
+			if (it != copies.end()) {
+				it->second.Reparent(parent_copy);
+			}
+		}
+	}
+
+	return result;
+}
+
+std::vector<Entity> CollectHierarchy(Entity root) {
+	std::vector<Entity> entities = { root };
+	for (size_t i = 0; i < entities.size(); i++) {
+		Entity current = entities[i];
+		if (current.Has<Component::Family>()) {
+			for (Entity& child : current.Get<Component::Family>().Children) {
+				entities.push_back(child);
+			}
+		}
+	}
+	return entities;
+}
+
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <base.h>
+#include "scene/entity.h"
+
+namespace Enik {
+
+// uuid of the source entity -> uuid of its copy
+using UUIDMap = std::unordered_map<uint64_t, uint64_t>;
+
+// copies the entities with their components into target, without going through yaml.
+// copies get their uuid from uuid_map, missing ones get a new uuid and are added to it.
+// family links and entity script fields pointing inside the copied set are remapped,
+// physics bodies, shapes and script instances are created later as usual.
+// returns the copies in the same order as entities
+std::vector<Entity> CopyEntities(const std::vector<Entity>& entities, Scene* target, UUIDMap& uuid_map);
+
+// root and all of its children, parents come before their children
+std::vector<Entity> CollectHierarchy(Entity root);
+
+}
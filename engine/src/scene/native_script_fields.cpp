@@ -0,0 +1,178 @@
+#include "native_script_fields.h"
+
+#include <algorithm>
+#include <cstring>
+#include <glm/glm.hpp>
+
+#include "scene/scriptable_entity.h"
+
+namespace Enik {
+
+static size_t GetFieldSize(FieldType type) {
+	switch (type) {
+		case FieldType::NONE:   return 0;
+		case FieldType::BOOL:   return sizeof(bool);
+		case FieldType::INT:    return sizeof(int);
+		case FieldType::FLOAT:  return sizeof(float);
+		case FieldType::DOUBLE: return sizeof(double);
+		case FieldType::VEC2:   return sizeof(glm::vec2);
+		case FieldType::VEC3:   return sizeof(glm::vec3);
+		case FieldType::VEC4:   return sizeof(glm::vec4);
+		case FieldType::PREFAB:
+		case FieldType::STRING: return 0;
+		case FieldType::ENTITY: return sizeof(uint64_t);
+	}
+	return 0;
+}
+
+static size_t GetFieldAlignment(FieldType type) {
+	switch (type) {
+		case FieldType::BOOL:   return alignof(bool);
+		case FieldType::INT:    return alignof(int);
+		case FieldType::FLOAT:
+		case FieldType::VEC2:
+		case FieldType::VEC3:
+		case FieldType::VEC4:   return alignof(float);
+		case FieldType::DOUBLE: return alignof(double);
+		case FieldType::ENTITY: return alignof(uint64_t);
+		default:                return 1;
+	}
+}
+
+
+void* ScriptFieldValues::Get(const ScriptFieldInfo& field) {
+	if (field.IsString()) {
+		return &Strings[field.ValueOffset];
+	}
+	return Data.data() + field.ValueOffset;
+}
+
+const void* ScriptFieldValues::Get(const ScriptFieldInfo& field) const {
+	if (field.IsString()) {
+		return &Strings[field.ValueOffset];
+	}
+	return Data.data() + field.ValueOffset;
+}
+
+void ScriptFieldValues::Set(const ScriptFieldInfo& field, const void* value) {
+	if (field.IsString()) {
+		Strings[field.ValueOffset] = *static_cast<const std::string*>(value);
+	}
+	else {
+		std::memcpy(Data.data() + field.ValueOffset, value, field.Size);
+	}
+}
+
+
+const ScriptFieldInfo* ScriptFieldSchema::Find(const std::string& name) const {
+	auto it = std::lower_bound(Fields.begin(), Fields.end(), name, [](const ScriptFieldInfo& field, const std::string& name) {
+		return field.Name < name;
+	});
+	if (it == Fields.end() or it->Name != name) {
+		return nullptr;
+	}
+	return &(*it);
+}
+
+void ScriptFieldSchema::CopyMatchingFields(const ScriptFieldSchema& from, const ScriptFieldValues& from_values, ScriptFieldValues& values) const {
+	if (HasSameLayout(from)) {
+		values = from_values;
+		return;
+	}
+	for (const ScriptFieldInfo& field : Fields) {
+		const ScriptFieldInfo* from_field = from.Find(field.Name);
+		if (from_field and from_field->Type == field.Type) {
+			values.Set(field, from_values.Get(*from_field));
+		}
+	}
+}
+
+bool ScriptFieldSchema::HasSameLayout(const ScriptFieldSchema& other) const {
+	if (this == &other) {
+		return true;
+	}
+	if (Fields.size() != other.Fields.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < Fields.size(); i++) {
+		if (Fields[i].Name != other.Fields[i].Name or Fields[i].Type != other.Fields[i].Type or
+			Fields[i].ValueOffset != other.Fields[i].ValueOffset) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void ScriptFieldSchema::ApplyToInstance(const ScriptFieldValues& values, ScriptableEntity* instance) const {
+	uint8_t* base = reinterpret_cast<uint8_t*>(instance);
+	for (const ScriptFieldInfo& field : Fields) {
+		uint8_t* member = base + field.InstanceOffset;
+		if (field.IsString()) {
+			*reinterpret_cast<std::string*>(member) = values.Strings[field.ValueOffset];
+		}
+		else {
+			std::memcpy(member, values.Data.data() + field.ValueOffset, field.Size);
+		}
+	}
+}
+
+void ScriptFieldSchema::CaptureFromInstance(ScriptFieldValues& values, const ScriptableEntity* instance) const {
+	const uint8_t* base = reinterpret_cast<const uint8_t*>(instance);
+	for (const ScriptFieldInfo& field : Fields) {
+		const uint8_t* member = base + field.InstanceOffset;
+		if (field.IsString()) {
+			values.Strings[field.ValueOffset] = *reinterpret_cast<const std::string*>(member);
+		}
+		else {
+			std::memcpy(values.Data.data() + field.ValueOffset, member, field.Size);
+		}
+	}
+}
+
+Ref<ScriptFieldSchema> ScriptFieldSchema::Create(ScriptableEntity* instance) {
+	Ref<ScriptFieldSchema> schema = CreateRef<ScriptFieldSchema>();
+
+	const uint8_t* base = reinterpret_cast<const uint8_t*>(instance);
+	for (const NativeScriptField& field : instance->OnEditorGetFields()) {
+		const uint8_t* member = static_cast<const uint8_t*>(field.Value);
+		if (field.Type == FieldType::NONE or member == nullptr or member < base) {
+			EN_CORE_ERROR("Script field '{}' is not a member of the script, ignored", field.Name);
+			continue;
+		}
+		if (schema->Find(field.Name)) {
+			continue;
+		}
+
+		ScriptFieldInfo info;
+		info.Name = field.Name;
+		info.Type = field.Type;
+		info.InstanceOffset = (size_t)(member - base);
+		info.Size = GetFieldSize(field.Type);
+
+		auto it = std::lower_bound(schema->Fields.begin(), schema->Fields.end(), info.Name, [](const ScriptFieldInfo& field, const std::string& name) {
+			return field.Name < name;
+		});
+		schema->Fields.insert(it, info);
+	}
+
+	// values are packed after sorting, so the layout only depends on the names
+	size_t data_size = 0;
+	size_t string_count = 0;
+	for (ScriptFieldInfo& field : schema->Fields) {
+		if (field.IsString()) {
+			field.ValueOffset = string_count++;
+			continue;
+		}
+		const size_t alignment = GetFieldAlignment(field.Type);
+		data_size = (data_size + alignment - 1) / alignment * alignment;
+		field.ValueOffset = data_size;
+		data_size += field.Size;
+	}
+
+	schema->Defaults.Data.resize(data_size);
+	schema->Defaults.Strings.resize(string_count);
+	schema->CaptureFromInstance(schema->Defaults, instance);
+	return schema;
+}
+
+}
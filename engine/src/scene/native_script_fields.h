@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <vector>
 #include <base.h>
 
 
@@ -25,7 +26,11 @@ struct NativeScriptField {
 
 
 	const std::string TypeName() {
-		switch (Type) {
+		return TypeName(Type);
+	}
+
+	static const std::string TypeName(FieldType type) {
+		switch (type) {
 			case FieldType::NONE:   return std::string();
 			case FieldType::BOOL:   return "bool";
 			case FieldType::INT:    return "int";
@@ -57,4 +62,76 @@ struct NativeScriptField {
 		EN_CORE_ERROR("Native Script Field Name is invalid! {}", name);
 		return FieldType::NONE;
 	}
-};
\ No newline at end of file
+};
+
+namespace Enik {
+
+class ScriptableEntity;
+
+struct ScriptFieldInfo {
+	std::string Name;
+	FieldType Type = FieldType::NONE;
+	// member offset in the script object
+	size_t InstanceOffset = 0;
+	// byte offset in ScriptFieldValues::Data, index in ScriptFieldValues::Strings for strings
+	size_t ValueOffset = 0;
+	// 0 for strings
+	size_t Size = 0;
+
+	bool IsString() const { return Type == FieldType::STRING or Type == FieldType::PREFAB; }
+};
+
+// per entity field values, laid out by a ScriptFieldSchema
+struct ScriptFieldValues {
+	std::vector<uint8_t> Data;
+	std::vector<std::string> Strings;
+
+	void* Get(const ScriptFieldInfo& field);
+	const void* Get(const ScriptFieldInfo& field) const;
+	void Set(const ScriptFieldInfo& field, const void* value);
+};
+
+// fields of a script class, built once per class from a temporary instance
+struct ScriptFieldSchema {
+	// sorted by name
+	std::vector<ScriptFieldInfo> Fields;
+	// values of a newly constructed instance
+	ScriptFieldValues Defaults;
+
+	const ScriptFieldInfo* Find(const std::string& name) const;
+
+	// values of fields with the same name and type are copied, others keep what they had
+	void CopyMatchingFields(const ScriptFieldSchema& from, const ScriptFieldValues& from_values, ScriptFieldValues& values) const;
+	bool HasSameLayout(const ScriptFieldSchema& other) const;
+
+	void ApplyToInstance(const ScriptFieldValues& values, ScriptableEntity* instance) const;
+	void CaptureFromInstance(ScriptFieldValues& values, const ScriptableEntity* instance) const;
+
+	static Ref<ScriptFieldSchema> Create(ScriptableEntity* instance);
+};
+
+}
+
+// callbacks that are broadcast to scripts,
+// a script only gets the ones its class overrides
+enum class ScriptCallback : uint8_t {
+	Update = 0,
+	FixedUpdate,
+	KeyPressed,
+	KeyReleased,
+	MouseButtonPressed,
+	MouseButtonReleased,
+	MouseScrolled,
+	Count
+};
+
+// interned script class name, see ScriptRegistry::InternName
+using ScriptClassID = uint32_t;
+constexpr ScriptClassID INVALID_SCRIPT_CLASS = 0xFFFFFFFF;
+
+using ScriptCallbackFlags = uint32_t;
+constexpr ScriptCallbackFlags SCRIPT_CALLBACKS_ALL = 0xFFFFFFFF;
+
+constexpr ScriptCallbackFlags ScriptCallbackFlag(ScriptCallback callback) {
+	return 1u << (uint32_t)callback;
+}
@@ -0,0 +1,189 @@
+#include "prefab_cache.h"
+
+#include <chrono>
+
+#include "project/project.h"
+#include "scene/entity_copy.h"
+#include "scene/scene_serializer.h"
+#include "script_system/script_system.h"
+
+namespace Enik {
+
+// how often a cached template checks if its file changed
+static constexpr auto WRITE_TIME_CHECK_INTERVAL = std::chrono::seconds(1);
+
+struct PrefabTemplate {
+	Ref<Scene> Staging;
+	// root first, parents before their children
+	std::vector<Entity> Entities;
+
+	std::filesystem::file_time_type WriteTime;
+	std::chrono::steady_clock::time_point LastWriteTimeCheck;
+};
+
+struct PrefabCacheData {
+	std::unordered_map<std::string, Scope<PrefabTemplate>> Templates;
+	std::unordered_map<std::string, std::string> CanonicalPaths;
+
+	// nested prefabs are instantiated into the staging scene while loading,
+	// they should not create script instances there
+	uint32_t LoadDepth = 0;
+};
+static PrefabCacheData s_Data;
+
+static void DestroyTemplate(PrefabTemplate& prefab) {
+	// NOTE: staged scripts are never instantiated, this only drops the script module functions
+	prefab.Staging->ClearNativeScripts();
+	prefab.Staging.reset();
+	prefab.Entities.clear();
+}
+
+static PrefabTemplate* LoadTemplate(const std::string& canonical_path) {
+	EN_PROFILE_SCOPE;
+
+	auto prefab = CreateScope<PrefabTemplate>();
+
+	// Scene sets itself as the script context
+	Scene* context = ScriptSystem::GetSceneContext();
+	prefab->Staging = CreateRef<Scene>();
+	ScriptSystem::SetSceneContext(context);
+
+	s_Data.LoadDepth++;
+	Entity root = SceneSerializer(prefab->Staging).LoadPrefab(canonical_path, 0, true);
+	s_Data.LoadDepth--;
+
+	if (not root) {
+		DestroyTemplate(*prefab);
+		return nullptr;
+	}
+
+	std::error_code error;
+	prefab->Entities = CollectHierarchy(root);
+	prefab->WriteTime = std::filesystem::last_write_time(canonical_path, error);
+	prefab->LastWriteTimeCheck = std::chrono::steady_clock::now();
+
+	auto& slot = s_Data.Templates[canonical_path];
+	slot = std::move(prefab);
+	return slot.get();
+}
+
+static PrefabTemplate* GetTemplate(const std::string& canonical_path) {
+	auto it = s_Data.Templates.find(canonical_path);
+	if (it == s_Data.Templates.end()) {
+		return LoadTemplate(canonical_path);
+	}
+
+	PrefabTemplate& prefab = *it->second;
+	auto now = std::chrono::steady_clock::now();
+	if (now - prefab.LastWriteTimeCheck > WRITE_TIME_CHECK_INTERVAL) {
+		prefab.LastWriteTimeCheck = now;
+
+		std::error_code error;
+		auto write_time = std::filesystem::last_write_time(canonical_path, error);
+		if (error or write_time != prefab.WriteTime) {
+			DestroyTemplate(prefab);
+			s_Data.Templates.erase(it);
+			return error ? nullptr : LoadTemplate(canonical_path);
+		}
+	}
+	return &prefab;
+}
+
+Entity PrefabCache::Instantiate(Scene* scene, const std::filesystem::path& path, UUID instance_uuid) {
+	EN_PROFILE_SCOPE;
+
+	const std::string& canonical_path = GetCanonicalPath(path);
+	if (canonical_path.empty()) {
+		EN_CORE_ERROR("InstantiatePrefab invalid path! {} {}", instance_uuid, path.string());
+		return {};
+	}
+
+	PrefabTemplate* prefab = GetTemplate(canonical_path);
+	if (prefab == nullptr) {
+		return {};
+	}
+
+	// root keeps its uuid from the file when there is no instance uuid
+	UUIDMap uuid_map;
+	UUID root_uuid = prefab->Entities[0].GetID();
+	uuid_map[root_uuid] = instance_uuid ? instance_uuid : root_uuid;
+
+	// children are derived from the instance, so a scene loads with the same uuids every
+	// time, whatever else used the generator. deterministic runs hash them
+	if (instance_uuid) {
+		for (size_t i = 1; i < prefab->Entities.size(); i++) {
+			const UUID uuid = prefab->Entities[i].GetID();
+			uuid_map[uuid] = UUID::Derive(instance_uuid, uuid);
+		}
+	}
+
+	std::vector<Entity> copies = CopyEntities(prefab->Entities, scene, uuid_map);
+	Entity root_entity = copies[0];
+
+	// NOTE: reason: we need to be able to get script instance
+	// right after doing InstantiateScript
+	if (s_Data.LoadDepth == 0) {
+		for (Entity entity : copies) {
+			if (not entity.Has<Component::NativeScript>()) {
+				continue;
+			}
+			auto& ns = entity.Get<Component::NativeScript>();
+			if (not ns.Instance and ns.InstantiateScript) {
+				ns.Instance = ns.InstantiateScript();
+				if (ns.Instance) {
+					ns.Instance->m_Entity = entity;
+					ns.ApplyNativeScriptFieldsToInstance();
+				}
+			}
+		}
+	}
+
+	if (root_entity.HasFamily()) {
+		Component::Transform& transform = root_entity.Get<Component::Transform>();
+		Component::Family&    family    = root_entity.Get<Component::Family>   ();
+		family.SetChildrenGlobalTransformRecursive(transform);
+	}
+
+	return root_entity;
+}
+
+bool PrefabCache::Preload(const std::filesystem::path& path) {
+	const std::string& canonical_path = GetCanonicalPath(path);
+	if (canonical_path.empty()) {
+		return false;
+	}
+	return GetTemplate(canonical_path) != nullptr;
+}
+
+const std::string& PrefabCache::GetCanonicalPath(const std::filesystem::path& path) {
+	const std::string key = path.string();
+	auto it = s_Data.CanonicalPaths.find(key);
+	if (it != s_Data.CanonicalPaths.end()) {
+		return it->second;
+	}
+
+	std::filesystem::path absolute_path = Project::GetAbsolutePath(path);
+	if (absolute_path.empty()) {
+		static const std::string s_Empty;
+		return s_Empty;
+	}
+	return s_Data.CanonicalPaths[key] = absolute_path.string();
+}
+
+void PrefabCache::Invalidate(const std::filesystem::path& path) {
+	auto it = s_Data.Templates.find(Project::GetAbsolutePath(path).string());
+	if (it != s_Data.Templates.end()) {
+		DestroyTemplate(*it->second);
+		s_Data.Templates.erase(it);
+	}
+}
+
+void PrefabCache::Clear() {
+	for (auto& [path, prefab] : s_Data.Templates) {
+		DestroyTemplate(*prefab);
+	}
+	s_Data.Templates.clear();
+	s_Data.CanonicalPaths.clear();
+}
+
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <base.h>
+#include "scene/entity.h"
+
+namespace Enik {
+
+// prefab files are loaded once into a staging scene,
+// instantiating copies the staged entities instead of parsing the yaml again
+class PrefabCache {
+public:
+	// path can be relative to the project, reloads the template if the file changed
+	static Entity Instantiate(Scene* scene, const std::filesystem::path& path, UUID instance_uuid);
+	// loads the template without instantiating it
+	static bool Preload(const std::filesystem::path& path);
+
+	// absolute path of a project path, cached, empty if the file does not exist
+	static const std::string& GetCanonicalPath(const std::filesystem::path& path);
+
+	static void Invalidate(const std::filesystem::path& path);
+	// templates hold script bindings, so this is called before the script module is unloaded
+	static void Clear();
+};
+
+}
@@ -6,14 +6,53 @@
 #include "scene/components.h"
 #include "scene/entity.h"
 #include "script_system/script_system.h"
+#include "script_system/script_registry.h"
 #include "scene/scene_serializer.h"
 #include "core/application.h"
 #include "scene/tween.h"
+#include "scene/prefab_cache.h"
+#include "scene/entity_copy.h"
+#include "scene/scene_preload.h"
 
 namespace Enik {
 
+// uuids of entities spawned by a deterministic run
+static constexpr uint64_t DETERMINISTIC_UUID_SEED = 0x656e696b;
+
+// FNV-1a over raw bytes, floats are hashed by their bits
+struct StateHasher {
+	uint64_t Hash = 14695981039346656037ull;
+
+	void Add(const void* data, size_t size) {
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; i++) {
+			Hash ^= bytes[i];
+			Hash *= 1099511628211ull;
+		}
+	}
+	template<typename T>
+	void Add(const T& value) {
+		static_assert(std::is_trivially_copyable_v<T>);
+		Add(&value, sizeof(T));
+	}
+};
+
+// the same uuid on every run and platform for the same autoload
+static UUID DeriveAutoLoadUUID(const std::filesystem::path& path) {
+	const std::string name = path.generic_string();
+	StateHasher hasher;
+	hasher.Add(name.data(), name.size());
+	return UUID::Derive(DETERMINISTIC_UUID_SEED, hasher.Hash);
+}
+
+
 Scene::Scene() {
+	m_Deterministic = Project::GetActive() and Project::GetActive()->GetConfig().deterministic;
 	ScriptSystem::SetSceneContext(this);
+	ScriptSystem::RegisterScene(this);
+	m_Registry.on_construct<Component::NativeScript>().connect<&Scene::OnNativeScriptConstruct>(this);
+	m_Registry.on_destroy  <Component::NativeScript>().connect<&Scene::OnNativeScriptDestroy  >(this);
+	RegisterEngineSystems();
 }
 
 // only called from SceneSerializer::Deserialize
@@ -28,14 +67,46 @@ void Scene::InstantiateAutoLoads() {
 			}
 		}
 		if (!already_autoloaded) {
-			Entity e = InstantiatePrefab(al[i]);
+			// the scene is loaded before the run seeds the generator
+			const UUID instance_uuid = m_Deterministic ? DeriveAutoLoadUUID(al[i]) : UUID();
+			Entity e = InstantiatePrefab(al[i], instance_uuid);
 			e.GetOrAdd<Component::SceneControl>().AutoLoaded = true;
 			m_autoloaded.push_back(al[i]);
 		}
 	}
 }
 
+Ref<Scene> Scene::Copy(const Ref<Scene>& other) {
+	EN_PROFILE_SCOPE;
+
+	Ref<Scene> scene = CreateRef<Scene>();
+	scene->m_SceneName = other->m_SceneName;
+	scene->m_autoloaded = other->m_autoloaded;
+
+	std::vector<Entity> entities;
+	UUIDMap uuid_map;
+	auto view = other->m_Registry.view<Component::ID>();
+	entities.reserve(view.size());
+	uuid_map.reserve(view.size());
+	for (auto handle : view) {
+		uint64_t uuid = view.get<Component::ID>(handle).uuid;
+		entities.emplace_back(handle, other.get());
+		uuid_map[uuid] = uuid;
+	}
+
+	// views iterate newest first, keep the creation order
+	std::reverse(entities.begin(), entities.end());
+	CopyEntities(entities, scene.get(), uuid_map);
+
+	return scene;
+}
+
 Scene::~Scene() {
+	// editor entities created after the run must not repeat the run's uuids
+	if (m_Deterministic and m_RunStarted) {
+		UUID::Reseed();
+	}
+	ScriptSystem::UnregisterScene(this);
 	m_Physics.Uninitialize();
 	DestroyScriptableEntities();
 }
@@ -61,6 +132,10 @@ void Scene::DestroyDeferredEntities() {
 	while (m_deferred_destroy.size() > 0) {
 		Entity entity = m_deferred_destroy.back();
 		m_deferred_destroy.pop_back();
+		if (entity and m_Registry.valid(entity) and entity.Has<Component::Pooled>()) {
+			ReleaseToPool(entity);
+			continue;
+		}
 		DestroyEntityImmediatelyInternal(entity);
 	}
 	m_deferred_destroy.clear();
@@ -96,15 +171,160 @@ void Scene::DestroyEntityImmediatelyInternal(Entity entity) {
 	}
 }
 
+void Scene::DestroyEntitiesExcept(const entt::sparse_set& keep) {
+	EN_PROFILE_SCOPE;
+
+	// a kept entity outlives its destroyed parent
+	for (auto entity : keep) {
+		Entity kept = Entity(entity, this);
+		if (kept.HasParent() and not keep.contains(kept.GetParent())) {
+			kept.Reparent({});
+		}
+	}
+
+	std::vector<JPH::BodyID> bodies;
+	for (auto [entity, rb] : m_Registry.view<Component::RigidBody>().each()) {
+		if (rb.body and not keep.contains(entity)) {
+			bodies.push_back(rb.body->GetID());
+			rb.body = nullptr;
+		}
+	}
+	for (auto [entity, cb] : m_Registry.view<Component::CollisionBody>(entt::exclude<Component::RigidBody>).each()) {
+		if (cb.body and not keep.contains(entity)) {
+			bodies.push_back(cb.body->GetID());
+			cb.body = nullptr;
+		}
+	}
+	m_Physics.RemovePhysicsBodies(bodies);
+
+	if (keep.empty()) {
+		m_Registry.clear();
+		return;
+	}
+
+	std::vector<entt::entity> entities;
+	m_Registry.each([&](entt::entity entity) {
+		if (not keep.contains(entity)) {
+			entities.push_back(entity);
+		}
+	});
+	m_Registry.destroy(entities.begin(), entities.end());
+}
+
 Entity Scene::InstantiatePrefab(const std::filesystem::path& path, UUID instance_uuid) {
-	std::filesystem::path canonical_path = Project::GetAbsolutePath(path);
-	if (canonical_path.empty()) {
-		EN_CORE_ERROR("InstantiatePrefab invalid path! {} {}", instance_uuid, path.string());
+	return PrefabCache::Instantiate(this, path, instance_uuid);
+}
+
+void Scene::WarmPrefabPool(const std::filesystem::path& path, uint32_t count) {
+	EN_PROFILE_SCOPE;
+
+	const std::string& key = PrefabCache::GetCanonicalPath(path);
+	if (key.empty()) {
+		EN_CORE_ERROR("WarmPrefabPool invalid path! {}", path.string());
+		return;
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		Entity entity = InstantiatePrefab(path);
+		if (not entity) {
+			return;
+		}
+		entity.Add<Component::Pooled>().PoolKey = key;
+		SetActiveRecursive(entity, false);
+		m_PrefabPools[key].push_back(entity);
+	}
+}
+
+Entity Scene::SpawnFromPool(const std::filesystem::path& path) {
+	EN_PROFILE_SCOPE;
+
+	const std::string& key = PrefabCache::GetCanonicalPath(path);
+	if (key.empty()) {
+		EN_CORE_ERROR("SpawnFromPool invalid path! {}", path.string());
 		return {};
 	}
-	SceneSerializer serializer = SceneSerializer(this);
-	Entity e = serializer.InstantiatePrefab(canonical_path.string(), instance_uuid);
-	return e;
+
+	auto& pool = m_PrefabPools[key];
+	while (not pool.empty()) {
+		Entity entity = Entity(pool.back(), this);
+		pool.pop_back();
+		// NOTE: a pooled entity can still be destroyed with its parent
+		if (not m_Registry.valid(entity)) {
+			continue;
+		}
+
+		SetActiveRecursive(entity, true);
+		auto* ns = m_Registry.try_get<Component::NativeScript>(entity);
+		if (ns and ns->Instance) {
+			ns->Instance->OnPoolSpawn();
+		}
+		return entity;
+	}
+
+	Entity entity = InstantiatePrefab(path);
+	if (entity) {
+		entity.Add<Component::Pooled>().PoolKey = key;
+	}
+	return entity;
+}
+
+void Scene::ClearPrefabPools() {
+	m_PrefabPools.clear();
+}
+
+void Scene::ReleaseToPool(Entity entity) {
+	// destroyed twice in the same frame
+	if (entity.Has<Component::Inactive>()) {
+		return;
+	}
+
+	auto* ns = m_Registry.try_get<Component::NativeScript>(entity);
+	if (ns and ns->Instance) {
+		ns->Instance->OnPoolRelease();
+	}
+
+	SetActiveRecursive(entity, false);
+	m_PrefabPools[entity.Get<Component::Pooled>().PoolKey].push_back(entity);
+}
+
+void Scene::SetActiveRecursive(Entity entity, bool active) {
+	std::vector<Entity> entities = { entity };
+	while (not entities.empty()) {
+		Entity current = entities.back();
+		entities.pop_back();
+
+		Component::PhysicsBodyBase* body = nullptr;
+		if (auto* rb = m_Registry.try_get<Component::RigidBody>(current)) {
+			body = rb;
+		} else if (auto* cb = m_Registry.try_get<Component::CollisionBody>(current)) {
+			body = cb;
+		}
+
+		if (active) {
+			m_Registry.remove<Component::Inactive>(current);
+			if (body) {
+				m_Physics.ActivatePhysicsBody(current);
+			}
+			// callbacks are added back by ProcessPendingScripts, OnCreate is not called again
+			if (m_Registry.all_of<Component::NativeScript>(current)) {
+				m_PendingScripts.push_back(current);
+			}
+		} else {
+			m_Registry.emplace_or_replace<Component::Inactive>(current);
+			if (body) {
+				m_Physics.DeactivatePhysicsBody(body->body);
+			}
+			for (auto& storage : m_ScriptCallbacks) {
+				storage.remove(current);
+			}
+		}
+
+		if (current.HasFamily()) {
+			for (Entity& child : current.GetChildren()) {
+				entities.push_back(child);
+			}
+		}
+	}
 }
 
 void Scene::OnUpdateEditor(Timestep ts, OrthographicCameraController& camera) {
@@ -117,7 +337,7 @@ void Scene::OnUpdateEditor(Timestep ts, OrthographicCameraController& camera) {
 	/* Get Sprites */ {
 		EN_PROFILE_SECTION("Get Sprites");
 
-		auto group = m_Registry.group<Component::SpriteRenderer>(entt::get<Component::Transform>);
+		auto group = m_Registry.group<Component::SpriteRenderer>(entt::get<Component::Transform>, entt::exclude<Component::Inactive>);
 		for (auto entity : group) {
 			Component::Transform& transform   = group.get<Component::Transform>     (entity);
 			Component::SpriteRenderer& sprite = group.get<Component::SpriteRenderer>(entity);
@@ -128,7 +348,7 @@ void Scene::OnUpdateEditor(Timestep ts, OrthographicCameraController& camera) {
 
 	{
 		EN_PROFILE_SECTION("Render Text");
-		auto group = m_Registry.group<Component::Text>(entt::get<Component::Transform>);
+		auto group = m_Registry.group<Component::Text>(entt::get<Component::Transform>, entt::exclude<Component::Inactive>);
 		for (auto entity : group) {
 			Component::Transform& transform = group.get<Component::Transform>(entity);
 			Component::Text& text = group.get<Component::Text>(entity);
@@ -144,47 +364,41 @@ void Scene::OnUpdateEditor(Timestep ts, OrthographicCameraController& camera) {
 	DestroyDeferredEntities();
 }
 
+void Scene::BeginRun() {
+	if (m_RunStarted) {
+		return;
+	}
+	m_RunStarted = true;
+	if (m_Deterministic) {
+		UUID::Seed(DETERMINISTIC_UUID_SEED);
+	}
+}
+
 void Scene::OnUpdateRuntime(Timestep ts) {
 	EN_PROFILE_SECTION("Scene::OnUpdateRuntime");
+	BeginRun();
 
-	/* Update Scripts */
-	if (not m_IsPaused or m_StepFrames-- > 0) {
-		m_Registry.view<Component::NativeScript>().each([=](auto entity, Component::NativeScript& ns) {
-			if (not ns.Instance or ns.Instance == nullptr) {
-				if (ns.InstantiateScript and ns.InstantiateScript != nullptr) {
-					ns.Instance = ns.InstantiateScript();
-					ns.Instance->m_Entity = Entity(entity, this);
-					ns.ApplyNativeScriptFieldsToInstance();
-					ns.Called_OnCreate = true;
-					ns.Instance->OnCreate();
-				}
-			// NOTE: reason: we need to be able to get script instance
-			// right after doing InstantiateScript
-			} else if (!ns.Called_OnCreate) {
-				EN_ASSERT(ns.Instance);
-				ns.Called_OnCreate = true;
-				ns.Instance->OnCreate();
-			} else {
-				ns.Instance->OnUpdate(ts);
-			}
-		});
+	// scripts see the stepped transforms, not the ones drawn last frame
+	m_Physics.RestoreTransforms();
 
+	if (not m_IsPaused or m_StepFrames-- > 0) {
+		m_Scheduler.Run(SystemPhase::Update, *this, ts);
+	}
 
-		Tween::StepAll(ts);
-
-		// Update animations
-		m_Registry.view<Component::AnimationPlayer>().each([=](auto entity, Component::AnimationPlayer& ap) {
-			if (ap.BoundEntity == nullptr) {
-				ap.BoundEntity = CreateRef<Entity>(entity, this);
-			}
-			ap.Update(ts);
-		});
+	m_Scheduler.Run(SystemPhase::PreRender, *this, ts);
 
+	if (not Application::Get().IsHeadless()) {
+		RenderRuntime();
 	}
 
+	if (m_deferred_scene_change) {
+		ChangeToDeferredScene();
+	}
+	DestroyDeferredEntities();
+}
 
-
-	// Rendering
+void Scene::RenderRuntime() {
+	EN_PROFILE_SCOPE;
 
 	auto primary_camera = GetPrimaryCameraEntity();
 	if (not primary_camera) {
@@ -199,8 +413,8 @@ void Scene::OnUpdateRuntime(Timestep ts) {
 	/* Get Sprites */ {
 		EN_PROFILE_SECTION("Get Sprites");
 
-		auto group = m_Registry.group<Component::SpriteRenderer>(entt::get<Component::Transform>);
-		for (auto entity : group) {
+		auto group = m_Registry.group<Component::SpriteRenderer>(entt::get<Component::Transform>, entt::exclude<Component::Inactive>);
+		for (auto entity : m_VisibleSprites) {
 			Component::Transform& transform   = group.get<Component::Transform>     (entity);
 			Component::SpriteRenderer& sprite = group.get<Component::SpriteRenderer>(entity);
 
@@ -210,7 +424,7 @@ void Scene::OnUpdateRuntime(Timestep ts) {
 
 	{
 		EN_PROFILE_SECTION("Render Text");
-		auto group = m_Registry.group<Component::Text>(entt::get<Component::Transform>);
+		auto group = m_Registry.group<Component::Text>(entt::get<Component::Transform>, entt::exclude<Component::Inactive>);
 		for (auto entity : group) {
 			Component::Transform& transform = group.get<Component::Transform>(entity);
 			Component::Text& text = group.get<Component::Text>(entity);
@@ -219,92 +433,428 @@ void Scene::OnUpdateRuntime(Timestep ts) {
 	}
 
 	Renderer2D::EndScene();
-
-	if (m_deferred_scene_change) {
-		ChangeToDeferredScene();
-	}
-	DestroyDeferredEntities();
 }
 
 void Scene::OnFixedUpdate() {
+	BeginRun();
+	m_Physics.RestoreTransforms();
 	SetGlobalTransforms();
 	if (not m_IsPaused or m_StepFrames > 0) {
-		{ EN_PROFILE_SECTION("Scene::OnFixedUpdate NativeScript calls");
-		m_Registry.view<Component::NativeScript>().each([=](auto entity, auto& ns) {
-			if (not ns.Instance or ns.Instance == nullptr) {
-				if (ns.InstantiateScript and ns.InstantiateScript != nullptr) {
-					ns.Instance = ns.InstantiateScript();
-					ns.Instance->m_Entity = Entity(entity, this);
-					ns.ApplyNativeScriptFieldsToInstance();
-					ns.Called_OnCreate = true;
-					ns.Instance->OnCreate();
+		m_Scheduler.Run(SystemPhase::FixedUpdate, *this, PHYSICS_UPDATE_RATE);
+
+		if (m_Deterministic) {
+			m_FixedStep++;
+			m_StateHash = ComputeStateHash();
+		}
+	}
+}
+
+uint64_t Scene::ComputeStateHash() {
+	EN_PROFILE_SECTION("Scene::ComputeStateHash");
+
+	// registry order depends on history, uuids do not
+	std::vector<std::pair<uint64_t, entt::entity>> entities;
+	entities.reserve(m_Registry.storage<Component::ID>().size());
+	for (auto [entity, id] : m_Registry.view<Component::ID>().each()) {
+		entities.emplace_back((uint64_t)id.uuid, entity);
+	}
+	std::sort(entities.begin(), entities.end());
+
+	StateHasher hasher;
+	for (const auto& [uuid, entity] : entities) {
+		hasher.Add(uuid);
+		hasher.Add(m_Registry.all_of<Component::Inactive>(entity));
+
+		if (auto* tr = m_Registry.try_get<Component::Transform>(entity)) {
+			hasher.Add(tr->LocalPosition);
+			hasher.Add(tr->LocalRotation);
+			hasher.Add(tr->LocalScale);
+		}
+
+		Component::PhysicsBodyBase* body = m_Registry.try_get<Component::RigidBody>(entity);
+		if (body == nullptr) {
+			body = m_Registry.try_get<Component::CollisionBody>(entity);
+		}
+		if (body and body->body and not body->body->IsStatic()) {
+			const JPH::Vec3 linear  = body->body->GetLinearVelocity();
+			const JPH::Vec3 angular = body->body->GetAngularVelocity();
+			const float velocities[6] = {
+				linear.GetX(),  linear.GetY(),  linear.GetZ(),
+				angular.GetX(), angular.GetY(), angular.GetZ(),
+			};
+			hasher.Add(velocities);
+		}
+
+		auto* ns = m_Registry.try_get<Component::NativeScript>(entity);
+		if (ns and ns->Instance and ns->FieldSchema) {
+			const uint8_t* base = reinterpret_cast<const uint8_t*>(ns->Instance);
+			for (const ScriptFieldInfo& field : ns->FieldSchema->Fields) {
+				const uint8_t* member = base + field.InstanceOffset;
+				if (field.IsString()) {
+					const std::string& string = *reinterpret_cast<const std::string*>(member);
+					hasher.Add(string.data(), string.size());
+				} else {
+					hasher.Add(member, field.Size);
 				}
-			} else if (!ns.Called_OnCreate) {
-				EN_ASSERT(ns.Instance);
-				ns.Called_OnCreate = true;
-				ns.Instance->OnCreate();
-			} else {
-				ns.Instance->OnFixedUpdate();
 			}
-		});
 		}
+	}
+	return hasher.Hash;
+}
 
-		if (!m_Physics.m_is_initialized) {
-			m_Physics.Initialize(m_Registry, this);
-			m_Physics.CreatePhysicsWorld();
+
+// NOTE: engine systems form one chain per phase, every one of them is exclusive or
+// goes through Transform, so each sits in a stage of its own and the scheduler only orders them.
+// animation and culling run their work with ParallelFor instead,
+// stages are only shared with user systems that touch other components
+void Scene::RegisterEngineSystems() {
+	SystemDescription scripts;
+	scripts.Name = "Scripts";
+	scripts.Phase = SystemPhase::Update;
+	scripts.Exclusive = true;
+	scripts.Function = [](Scene& scene, Timestep ts) { scene.UpdateScripts(ts); };
+	AddSystem(scripts);
+
+	// tweens write through raw pointers and call callbacks
+	// frame times differ between runs, deterministic tweens advance with the fixed step
+	SystemDescription tweens;
+	tweens.Name = "Tweens";
+	tweens.Phase = m_Deterministic ? SystemPhase::FixedUpdate : SystemPhase::Update;
+	tweens.Exclusive = true;
+	tweens.Function = [](Scene& scene, Timestep ts) { Tween::StepAll(ts); };
+	AddSystem(tweens);
+
+	SystemDescription animation;
+	animation.Name = "Animation";
+	animation.Phase = SystemPhase::Update;
+	animation.Function = [](Scene& scene, Timestep ts) { scene.UpdateAnimations(ts); };
+	animation.Read<Component::Inactive>();
+	animation.Write<Component::AnimationPlayer, Component::Transform, Component::SpriteRenderer, Component::Camera>();
+	AddSystem(animation);
+
+	SystemDescription animation_callbacks;
+	animation_callbacks.Name = "Animation Callbacks";
+	animation_callbacks.Phase = SystemPhase::Update;
+	animation_callbacks.Exclusive = true;
+	animation_callbacks.Function = [](Scene& scene, Timestep ts) { scene.CallAnimationCallbacks(); };
+	AddSystem(animation_callbacks);
+
+
+	SystemDescription fixed_scripts;
+	fixed_scripts.Name = "Scripts";
+	fixed_scripts.Phase = SystemPhase::FixedUpdate;
+	fixed_scripts.Exclusive = true;
+	fixed_scripts.Function = [](Scene& scene, Timestep ts) { scene.FixedUpdateScripts(); };
+	AddSystem(fixed_scripts);
+
+	SystemDescription physics;
+	physics.Name = "Physics";
+	physics.Phase = SystemPhase::FixedUpdate;
+	physics.Exclusive = true;
+	physics.Function = [](Scene& scene, Timestep ts) {
+		if (!scene.m_Physics.m_is_initialized) {
+			scene.m_Physics.Initialize(scene.m_Registry, &scene);
+			scene.m_Physics.CreatePhysicsWorld();
+		}
+		scene.m_Physics.UpdatePhysics();
+	};
+	AddSystem(physics);
+
+
+	SystemDescription transforms;
+	transforms.Name = "Transforms";
+	transforms.Phase = SystemPhase::PreRender;
+	transforms.Function = [](Scene& scene, Timestep ts) { scene.SetGlobalTransforms(); };
+	transforms.Read<Component::Family>().Write<Component::Transform>();
+	AddSystem(transforms);
+
+	SystemDescription interpolation;
+	interpolation.Name = "Physics Interpolation";
+	interpolation.Phase = SystemPhase::PreRender;
+	interpolation.Exclusive = true;
+	interpolation.Function = [](Scene& scene, Timestep ts) {
+		// after the global transforms are set, it only moves the globals the renderer reads.
+		// a paused scene does not step, so it shows the last step. headless draws nothing
+		if (scene.m_IsPaused or Application::Get().IsHeadless()) {
+			scene.m_Physics.RestoreTransforms();
+		} else {
+			scene.m_Physics.InterpolateTransforms(Application::Get().GetFixedUpdateAlpha());
+		}
+	};
+	AddSystem(interpolation);
+
+	SystemDescription culling;
+	culling.Name = "Culling";
+	culling.Phase = SystemPhase::PreRender;
+	culling.Function = [](Scene& scene, Timestep ts) { scene.CullSprites(); };
+	culling.Read<Component::Transform, Component::SpriteRenderer, Component::Camera, Component::Inactive>();
+	AddSystem(culling);
+
+	// loads prefabs and assets, runs while paused so loading screens can pause the game
+	SystemDescription preload;
+	preload.Name = "Scene Preload";
+	preload.Phase = SystemPhase::PreRender;
+	preload.Exclusive = true;
+	preload.Function = [](Scene& scene, Timestep ts) {
+		if (scene.m_Preload) {
+			scene.m_Preload->Update();
+		}
+	};
+	AddSystem(preload);
+}
+
+void Scene::OnNativeScriptConstruct(entt::registry& registry, entt::entity entity) {
+	m_PendingScripts.push_back(entity);
+}
+
+void Scene::OnNativeScriptDestroy(entt::registry& registry, entt::entity entity) {
+	for (auto& storage : m_ScriptCallbacks) {
+		storage.remove(entity);
+	}
+	if (m_KeyFilteredScripts.remove(entity)) {
+		for (auto& [key, listeners] : m_KeyListeners) {
+			listeners.remove(entity);
+		}
+	}
+
+	// pooled instances go back to their pool, DestroyScriptableEntities does not free them
+	Component::NativeScript& ns = registry.get<Component::NativeScript>(entity);
+	if (ns.Instance and ns.DestroyScript) {
+		ns.DestroyScript(&ns);
+	}
+}
+
+void Scene::SubscribeToKey(entt::entity entity, ScriptableEntity* script, KeyCode key) {
+	if (not m_KeyFilteredScripts.contains(entity)) {
+		m_KeyFilteredScripts.emplace(entity);
+		m_ScriptCallbacks[(size_t)ScriptCallback::KeyPressed ].remove(entity);
+		m_ScriptCallbacks[(size_t)ScriptCallback::KeyReleased].remove(entity);
+	}
+
+	auto& listeners = m_KeyListeners[key];
+	if (not listeners.contains(entity)) {
+		listeners.emplace(entity, script);
+	}
+}
+
+void Scene::UnsubscribeFromKey(entt::entity entity, KeyCode key) {
+	auto it = m_KeyListeners.find(key);
+	if (it != m_KeyListeners.end()) {
+		it->second.remove(entity);
+	}
+}
+
+void Scene::ProcessPendingScripts() {
+	EN_PROFILE_SECTION("Scene::ProcessPendingScripts");
+
+	// NOTE: OnCreate can add new scripts, they are created in the next batch
+	std::vector<entt::entity> batch;
+	bool added = false;
+	while (not m_PendingScripts.empty()) {
+		batch.clear();
+		batch.swap(m_PendingScripts);
+
+		// every instance exists before any OnCreate, so scripts can get each other
+		for (entt::entity entity : batch) {
+			auto* ns = m_Registry.try_get<Component::NativeScript>(entity);
+			if (ns and ns->Instance == nullptr and ns->InstantiateScript) {
+				ns->Instance = ns->InstantiateScript();
+				if (ns->Instance) {
+					ns->Instance->m_Entity = Entity(entity, this);
+					ns->ApplyNativeScriptFieldsToInstance();
+				}
+			}
+		}
+
+		for (entt::entity entity : batch) {
+			auto* ns = m_Registry.try_get<Component::NativeScript>(entity);
+			if (ns == nullptr or ns->Instance == nullptr) {
+				continue;
+			}
+
+			ScriptableEntity* instance = ns->Instance;
+			if (not ns->Called_OnCreate) {
+				ns->Called_OnCreate = true;
+				instance->OnCreate();
+			}
+
+			// OnCreate might have added components, ns can be dangling
+			ns = m_Registry.try_get<Component::NativeScript>(entity);
+			if (ns == nullptr or ns->Instance != instance) {
+				continue;
+			}
+
+			// re-queued when the pooled entity is spawned
+			if (m_Registry.all_of<Component::Inactive>(entity)) {
+				continue;
+			}
+
+			ScriptCallbackFlags callbacks = ns->Callbacks;
+			if (m_KeyFilteredScripts.contains(entity)) {
+				callbacks &= ~(ScriptCallbackFlag(ScriptCallback::KeyPressed) | ScriptCallbackFlag(ScriptCallback::KeyReleased));
+			}
+
+			for (size_t c = 0; c < m_ScriptCallbacks.size(); c++) {
+				if (callbacks & ScriptCallbackFlag((ScriptCallback)c) and not m_ScriptCallbacks[c].contains(entity)) {
+					m_ScriptCallbacks[c].emplace(entity, instance);
+					added = true;
+				}
+			}
+		}
+	}
+
+	// scripts run in entity order instead of the order they were added in,
+	// which changes with script reloads and pooling
+	if (m_Deterministic and added) {
+		for (auto& storage : m_ScriptCallbacks) {
+			storage.sort([](entt::entity a, entt::entity b) { return a < b; });
+		}
+	}
+}
+
+void Scene::UpdateScripts(Timestep ts) {
+	ProcessPendingScripts();
+	for (ScriptableEntity* script : m_ScriptCallbacks[(size_t)ScriptCallback::Update]) {
+		script->OnUpdate(ts);
+	}
+}
+
+void Scene::FixedUpdateScripts() {
+	EN_PROFILE_SECTION("Scene::OnFixedUpdate NativeScript calls");
+	ProcessPendingScripts();
+	for (ScriptableEntity* script : m_ScriptCallbacks[(size_t)ScriptCallback::FixedUpdate]) {
+		script->OnFixedUpdate();
+	}
+}
+
+void Scene::UpdateAnimations(Timestep ts) {
+	// NOTE: an animation player only writes to its own entity
+	auto& storage = m_Registry.storage<Component::AnimationPlayer>();
+	const auto& inactive = m_Registry.storage<Component::Inactive>();
+	Application::Get().GetJobSystem().ParallelFor((uint32_t)storage.size(), 64, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++) {
+			entt::entity entity = storage.data()[i];
+			if (inactive.contains(entity)) {
+				continue;
+			}
+			Component::AnimationPlayer& ap = storage.get(entity);
+			if (ap.BoundEntity == nullptr) {
+				ap.BoundEntity = CreateRef<Entity>(entity, this);
+			}
+			ap.Update(ts);
+		}
+	});
+}
+
+void Scene::CallAnimationCallbacks() {
+	m_Registry.view<Component::AnimationPlayer>().each([](auto entity, Component::AnimationPlayer& ap) {
+		ap.CallOnEndCallback();
+	});
+}
+
+void Scene::CullSprites() {
+	EN_PROFILE_SCOPE;
+
+	m_VisibleSprites.clear();
+	auto group = m_Registry.group<Component::SpriteRenderer>(entt::get<Component::Transform>, entt::exclude<Component::Inactive>);
+
+	Entity camera_entity = GetPrimaryCameraEntity();
+	if (not camera_entity) {
+		return;
+	}
+
+	// half extents of the camera rectangle in world space, as an axis aligned box
+	const Component::Transform& camera_transform = camera_entity.Get<Component::Transform>();
+	SceneCamera& camera = camera_entity.Get<Component::Camera>().Cam;
+	glm::vec2 half = glm::vec2(camera.GetSize() * camera.GetAspectRatio(), camera.GetSize()) * 0.5f;
+	half *= glm::abs(glm::vec2(camera_transform.GlobalScale));
+	const glm::mat3 rotation = glm::mat3_cast(camera_transform.GlobalRotation);
+	const glm::vec2 camera_half_extents = glm::vec2(
+		glm::abs(rotation[0][0]) * half.x + glm::abs(rotation[1][0]) * half.y,
+		glm::abs(rotation[0][1]) * half.x + glm::abs(rotation[1][1]) * half.y
+	);
+	const glm::vec2 camera_center = glm::vec2(camera_transform.GlobalPosition);
+
+	const uint32_t count = (uint32_t)group.size();
+	const auto first = group.begin();
+	m_SpriteVisibility.resize(count);
+
+	Application::Get().GetJobSystem().ParallelFor(count, 1024, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; i++) {
+			const Component::Transform& transform = group.get<Component::Transform>(*(first + i));
+
+			// bounding circle of the quad, works for any rotation
+			float radius = glm::length(glm::vec2(transform.GlobalScale)) * 0.5f;
+			glm::vec2 distance = glm::abs(glm::vec2(transform.GlobalPosition) - camera_center);
+			m_SpriteVisibility[i] = distance.x <= camera_half_extents.x + radius and distance.y <= camera_half_extents.y + radius;
+		}
+	});
+
+	// keep the group order, so draw order does not change
+	m_VisibleSprites.reserve(count);
+	for (uint32_t i = 0; i < count; i++) {
+		if (m_SpriteVisibility[i]) {
+			m_VisibleSprites.push_back(*(first + i));
 		}
-		m_Physics.UpdatePhysics();
 	}
 }
 
 
 void Scene::OnKeyPressed(const KeyPressedEvent& event) {
 	if (not m_IsPaused or m_StepFrames > 0) {
-		m_Registry.view<Component::NativeScript>().each([=](auto entity, auto& ns) {
-			if (ns.Instance and ns.Instance != nullptr) {
-				ns.Instance->OnKeyPressed(event);
+		for (ScriptableEntity* script : m_ScriptCallbacks[(size_t)ScriptCallback::KeyPressed]) {
+			script->OnKeyPressed(event);
+		}
+
+		auto it = m_KeyListeners.find(event.GetKeyCode());
+		if (it != m_KeyListeners.end()) {
+			for (auto [entity, script] : it->second.each()) {
+				if (not m_Registry.all_of<Component::Inactive>(entity)) {
+					script->OnKeyPressed(event);
+				}
 			}
-		});
+		}
 	}
 }
 
 void Scene::OnKeyReleased(const KeyReleasedEvent& event) {
 	if (not m_IsPaused or m_StepFrames > 0) {
-		m_Registry.view<Component::NativeScript>().each([=](auto entity, auto& ns) {
-			if (ns.Instance and ns.Instance != nullptr) {
-				ns.Instance->OnKeyReleased(event);
+		for (ScriptableEntity* script : m_ScriptCallbacks[(size_t)ScriptCallback::KeyReleased]) {
+			script->OnKeyReleased(event);
+		}
+
+		auto it = m_KeyListeners.find(event.GetKeyCode());
+		if (it != m_KeyListeners.end()) {
+			for (auto [entity, script] : it->second.each()) {
+				if (not m_Registry.all_of<Component::Inactive>(entity)) {
+					script->OnKeyReleased(event);
+				}
 			}
-		});
+		}
 	}
 }
 
 void Scene::OnMouseButtonPressed(const MouseButtonPressedEvent& event) {
 	if (not m_IsPaused or m_StepFrames > 0) {
-		m_Registry.view<Component::NativeScript>().each([=](auto entity, auto& ns) {
-			if (ns.Instance and ns.Instance != nullptr) {
-				ns.Instance->OnMouseButtonPressed(event);
-			}
-		});
+		for (ScriptableEntity* script : m_ScriptCallbacks[(size_t)ScriptCallback::MouseButtonPressed]) {
+			script->OnMouseButtonPressed(event);
+		}
 	}
 }
 
 void Scene::OnMouseButtonReleased(const MouseButtonReleasedEvent& event) {
 	if (not m_IsPaused or m_StepFrames > 0) {
-		m_Registry.view<Component::NativeScript>().each([=](auto entity, auto& ns) {
-			if (ns.Instance and ns.Instance != nullptr) {
-				ns.Instance->OnMouseButtonReleased(event);
-			}
-		});
+		for (ScriptableEntity* script : m_ScriptCallbacks[(size_t)ScriptCallback::MouseButtonReleased]) {
+			script->OnMouseButtonReleased(event);
+		}
 	}
 }
 
 void Scene::OnMouseScrolled(const MouseScrolledEvent& event) {
 	if (not m_IsPaused or m_StepFrames > 0) {
-		m_Registry.view<Component::NativeScript>().each([=](auto entity, auto& ns) {
-			if (ns.Instance and ns.Instance != nullptr) {
-				ns.Instance->OnMouseScrolled(event);
-			}
-		});
+		for (ScriptableEntity* script : m_ScriptCallbacks[(size_t)ScriptCallback::MouseScrolled]) {
+			script->OnMouseScrolled(event);
+		}
 	}
 }
 
@@ -347,12 +897,79 @@ void Scene::DestroyScriptableEntities() {
 }
 
 void Scene::ClearNativeScripts() {
+	for (auto& storage : m_ScriptCallbacks) {
+		storage.clear();
+	}
+	m_PendingScripts.clear();
+	m_KeyFilteredScripts.clear();
+	m_KeyListeners.clear();
+
 	m_Registry.view<Component::NativeScript>().each([=](auto entity, auto& ns) {
 		ns.InstantiateScript = nullptr;
 		ns.DestroyScript(&ns);
 	});
 }
 
+void Scene::SuspendScripts() {
+	EN_PROFILE_SCOPE;
+
+	// instance pointers are gone after this, subscriptions are made again in OnCreate
+	for (auto& storage : m_ScriptCallbacks) {
+		storage.clear();
+	}
+	m_KeyFilteredScripts.clear();
+	m_KeyListeners.clear();
+
+	m_Registry.view<Component::NativeScript>().each([&](entt::entity entity, Component::NativeScript& ns) {
+		if (ns.Instance == nullptr) {
+			return;
+		}
+		if (ns.FieldSchema) {
+			ns.FieldSchema->CaptureFromInstance(ns.FieldValues, ns.Instance);
+		}
+		ns.DestroyScript(&ns);
+		m_SuspendedScripts.push_back(entity);
+	});
+}
+
+void Scene::ResumeScripts() {
+	EN_PROFILE_SCOPE;
+
+	m_Registry.view<Component::NativeScript>().each([&](entt::entity entity, Component::NativeScript& ns) {
+		const ScriptClass* script_class = ScriptRegistry::Find(ns.ClassID);
+		if (script_class == nullptr) {
+			// kept so the scene still saves it, it is not instantiated
+			EN_CORE_ERROR("Script '{}' is not in the reloaded script module", ns.ScriptName);
+			ns.InstantiateScript = nullptr;
+			return;
+		}
+
+		Ref<const ScriptFieldSchema> old_schema = std::move(ns.FieldSchema);
+		ScriptFieldValues old_values = std::move(ns.FieldValues);
+		ns.Bind(*script_class);
+		if (old_schema and ns.FieldSchema) {
+			ns.FieldSchema->CopyMatchingFields(*old_schema, old_values, ns.FieldValues);
+		}
+	});
+
+	// every instance is created before any OnCreate, same as a scene load
+	for (entt::entity entity : m_SuspendedScripts) {
+		auto* ns = m_Registry.try_get<Component::NativeScript>(entity);
+		if (ns == nullptr or not ns->InstantiateScript) {
+			continue;
+		}
+		ns->Instance = ns->InstantiateScript();
+		if (ns->Instance == nullptr) {
+			continue;
+		}
+		ns->Instance->m_Entity = Entity(entity, this);
+		ns->ApplyNativeScriptFieldsToInstance();
+		ns->Called_OnCreate = false;
+		m_PendingScripts.push_back(entity);
+	}
+	m_SuspendedScripts.clear();
+}
+
 Entity Scene::GetPrimaryCameraEntity() {
 	EN_PROFILE_SECTION("GetPrimaryCameraEntity");
 
@@ -434,6 +1051,38 @@ void Scene::ChangeScene(const std::string& path) {
 	m_deferred_scene_change = true;
 }
 
+void Scene::PreloadScene(const std::string& path) {
+	const std::filesystem::path absolute = Project::GetAbsolutePath(path);
+	if (!std::filesystem::exists(absolute)) {
+		EN_CORE_ERROR("PreloadScene: scene not found {}", path.c_str());
+		return;
+	}
+	if (m_Preload and m_Preload->GetPath() == absolute.string()) {
+		return;
+	}
+	m_Preload = ScenePreload::Start(absolute.string());
+}
+
+float Scene::GetPreloadProgress() const {
+	return m_Preload ? m_Preload->GetProgress() : 0.0f;
+}
+
+bool Scene::IsPreloadReady() const {
+	return m_Preload and m_Preload->IsReady();
+}
+
+void Scene::ActivatePreloaded() {
+	if (not m_Preload) {
+		EN_CORE_ERROR("ActivatePreloaded: no scene is preloading");
+		return;
+	}
+	if (not m_Preload->IsReady()) {
+		EN_CORE_ERROR("ActivatePreloaded: scene is not ready {}", m_Preload->GetPath().c_str());
+		return;
+	}
+	ChangeScene(m_Preload->GetPath());
+}
+
 
 void Scene::ChangeToDeferredScene() {
 	if (!m_deferred_scene_change || m_deferred_scene_path.empty()) {
@@ -441,34 +1090,40 @@ void Scene::ChangeToDeferredScene() {
 	}
 
 
-	std::unordered_set<entt::entity> entities_to_keep;
-	m_Registry.each([&](entt::entity entity) {
-		if (m_Registry.any_of<Component::SceneControl>(entity)) {
-			const auto& sc = m_Registry.get<Component::SceneControl>(entity);
-			if (sc.Persistent) {
-				std::function<void(entt::entity)> collect_children = [&](entt::entity parent) {
-					entities_to_keep.insert(parent);
-					if (m_Registry.any_of<Component::Family>(parent)) {
-						const auto& family = m_Registry.get<Component::Family>(parent);
-						for (const auto& child : family.Children) {
-							collect_children(child.m_Handle);
-						}
-					}
-				};
-				collect_children(entity);
+	// persistent entities and their children survive the scene change
+	entt::sparse_set entities_to_keep;
+	std::vector<entt::entity> stack;
+	for (auto [entity, sc] : m_Registry.view<Component::SceneControl>().each()) {
+		if (sc.Persistent) {
+			stack.push_back(entity);
+		}
+	}
+	while (not stack.empty()) {
+		entt::entity entity = stack.back();
+		stack.pop_back();
+		if (entities_to_keep.contains(entity)) {
+			continue;
+		}
+		entities_to_keep.emplace(entity);
+		if (auto* family = m_Registry.try_get<Component::Family>(entity)) {
+			for (const auto& child : family->Children) {
+				stack.push_back(child);
 			}
 		}
-	});
+	}
 
-	// destroy every entity except for Persistent ones
-	m_Registry.each([&](entt::entity entity) {
-		if (entities_to_keep.find(entity) == entities_to_keep.end()) {
-			DestroyEntityImmediatelyInternal(Entity(entity, this));
-		}
-	});
+	ClearPrefabPools();
+	DestroyEntitiesExcept(entities_to_keep);
+
+	// preloaded yaml is used only when it is complete, otherwise the file is read again
+	Ref<ScenePreload> preload = std::move(m_Preload);
+	YAML::Node* preloaded = nullptr;
+	if (preload and preload->IsReady() and preload->GetPath() == m_deferred_scene_path) {
+		preloaded = &preload->GetData();
+	}
 
 	SceneSerializer serializer = SceneSerializer(this);
-	if (serializer.Deserialize(m_deferred_scene_path)) {
+	if (serializer.DeserializeAuto(m_deferred_scene_path, preloaded)) {
 		ScriptSystem::SetSceneContext(this);
 		NeedViewportResize = true;
 		//EN_CORE_INFO("Changed Scene to '{}'", m_deferred_scene_path.c_str());
@@ -6,17 +6,24 @@
 #include <entt/entt.hpp>
 #include "events/key_event.h"
 #include "physics/physics.h"
+#include "scene/system_scheduler.h"
+#include "scene/native_script_fields.h"
+#include <array>
 
 namespace Enik {
 
 class Entity;
 class ScriptableEntity;
+class ScenePreload;
 
 class Scene {
 public:
 	Scene();
 	~Scene();
 
+	// copies every entity with the same uuids, used to enter play mode without touching disk
+	static Ref<Scene> Copy(const Ref<Scene>& other);
+
 	Entity CreateEntity(const std::string& name = std::string());
 	Entity CreateEntityWithUUID(UUID uuid, const std::string& name = std::string());
 	// defers the deletion to end of the frame
@@ -25,6 +32,11 @@ public:
 	Entity InstantiatePrefab(const std::filesystem::path& path, UUID instance_uuid = UUID());
 	void InstantiateAutoLoads();
 
+	// pooled instances are deactivated instead of destroyed and reused by SpawnFromPool
+	void WarmPrefabPool(const std::filesystem::path& path, uint32_t count);
+	Entity SpawnFromPool(const std::filesystem::path& path);
+	void ClearPrefabPools();
+
 	entt::registry& Reg() { return m_Registry; }
 
 	void OnUpdateEditor (Timestep ts, OrthographicCameraController& camera);
@@ -50,6 +62,12 @@ public:
 	void DestroyScriptableEntities();
 	void ClearNativeScripts();
 
+	// script module reload, see ScriptSystem::ReloadScriptModule
+	// saves the fields of live scripts and destroys them while the old module is loaded
+	void SuspendScripts();
+	// rebinds to the new module, suspended scripts are created again with their field values
+	void ResumeScripts();
+
 	Entity GetPrimaryCameraEntity();
 
 	Entity FindEntityByUUID(UUID uuid);
@@ -57,15 +75,63 @@ public:
 
 	void SetGlobalTransforms();
 
+	// systems run in registration order, see SystemScheduler
+	void AddSystem(const SystemDescription& system) { m_Scheduler.Add(system); }
+	void RemoveSystem(const std::string& name) { m_Scheduler.Remove(name); }
+	std::vector<SystemTiming> GetSystemTimings() const { return m_Scheduler.GetTimings(); }
+	const PhysicsStats& GetPhysicsStats() const { return m_Physics.GetStats(); }
+
+	// deterministic projects hash the scene after every fixed step,
+	// two runs with the same inputs have the same hash at the same step
+	bool IsDeterministic() const { return m_Deterministic; }
+	uint64_t GetFixedStep() const { return m_FixedStep; }
+	uint64_t GetStateHash() const { return m_StateHash; }
+	// transforms, body velocities and script fields, in uuid order
+	uint64_t ComputeStateHash();
+
 	void CloseApplication();
 
 	void ChangeScene(const std::string& path);
 
+	// loads the scene in the background, ActivatePreloaded changes to it once ready
+	void PreloadScene(const std::string& path);
+	// 0 to 1, 0 when nothing is preloading
+	float GetPreloadProgress() const;
+	bool IsPreloadReady() const;
+	void ActivatePreloaded();
+
 private:
+	void RegisterEngineSystems();
+
+	void OnNativeScriptConstruct(entt::registry& registry, entt::entity entity);
+	void OnNativeScriptDestroy  (entt::registry& registry, entt::entity entity);
+	// instantiates and calls OnCreate for scripts added since the last call
+	void ProcessPendingScripts();
+	// seeds uuids for deterministic runs, called by the first runtime update
+	void BeginRun();
+
+	// a script subscribed to keys only gets key events for those keys
+	void SubscribeToKey    (entt::entity entity, ScriptableEntity* script, KeyCode key);
+	void UnsubscribeFromKey(entt::entity entity, KeyCode key);
+
+	void UpdateScripts(Timestep ts);
+	void FixedUpdateScripts();
+	void UpdateAnimations(Timestep ts);
+	void CallAnimationCallbacks();
+	void CullSprites();
+	// draws the scene from the primary camera, skipped when headless
+	void RenderRuntime();
+
 	void ChangeToDeferredScene();
 
 	void DestroyDeferredEntities();
 	void DestroyEntityImmediatelyInternal(Entity entity);
+	// destroys every entity that is not in keep, physics bodies are removed in one batch
+	void DestroyEntitiesExcept(const entt::sparse_set& keep);
+
+	void ReleaseToPool(Entity entity);
+	// toggles Component::Inactive on the entity and its children
+	void SetActiveRecursive(Entity entity, bool active);
 
 public:
 	bool NeedViewportResize = false;
@@ -73,6 +139,19 @@ public:
 private:
 	entt::registry m_Registry;
 	Physics m_Physics;
+	SystemScheduler m_Scheduler;
+
+	// scripts waiting for OnCreate, live instances only get the callbacks they override
+	std::vector<entt::entity> m_PendingScripts;
+	// had an instance when the script module was unloaded
+	std::vector<entt::entity> m_SuspendedScripts;
+	std::array<entt::storage<ScriptableEntity*>, (size_t)ScriptCallback::Count> m_ScriptCallbacks;
+	entt::sparse_set m_KeyFilteredScripts;
+	std::unordered_map<KeyCode, entt::storage<ScriptableEntity*>> m_KeyListeners;
+
+	// filled by the culling system, in sprite group order
+	std::vector<entt::entity> m_VisibleSprites;
+	std::vector<uint8_t> m_SpriteVisibility;
 
 	uint32_t m_ViewportWidth;
 	uint32_t m_ViewportHeight;
@@ -82,13 +161,22 @@ private:
 	bool m_IsPaused = false;
 	int m_StepFrames = 0;
 
+	bool m_Deterministic = false;
+	bool m_RunStarted = false;
+	uint64_t m_FixedStep = 0;
+	uint64_t m_StateHash = 0;
+
 	bool m_deferred_scene_change = false;
 	std::string m_deferred_scene_path = "";
 
+	Ref<ScenePreload> m_Preload;
+
 	std::vector<class Entity> m_deferred_destroy;
 
 	std::vector<std::filesystem::path> m_autoloaded;
 
+	std::unordered_map<std::string, std::vector<entt::entity>> m_PrefabPools;
+
 	friend class Entity;
 	friend class SceneTreePanel;
 	friend class InspectorPanel;
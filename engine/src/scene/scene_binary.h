@@ -0,0 +1,162 @@
+#pragma once
+#include <base.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// cooked runtime scene (.escnb), written by SceneSerializer::SerializeRuntime
+//
+// Header
+// Section[SectionCount]
+// sections, every section starts 8 byte aligned:
+//     Entities:  uint64_t UUID[EntityCount], uint32_t Name[EntityCount], uint32_t Parent[EntityCount]
+//     component: uint32_t Entity[Count], Record[Count]
+//     arrays:    Record[Count]
+// string table: uint32_t Offsets[StringCount + 1], chars
+//
+// entities are stored parents first, children in order.
+// strings are indexes into the string table.
+
+namespace Enik {
+namespace SceneBinary {
+
+constexpr char     MAGIC[4] = { 'E', 'S', 'C', 'B' };
+constexpr uint32_t VERSION  = 2;
+constexpr uint32_t NONE     = 0xFFFFFFFF;
+
+enum class SectionType : uint32_t {
+	Entities = 0,
+	Transform,
+	SpriteRenderer,
+	Camera,
+	NativeScript,
+	RigidBody,
+	CollisionBody,
+	CollisionShape,
+	Prefab,
+	AudioSources,
+	AnimationPlayer,
+	Text,
+	SceneControl,
+
+	// arrays referenced by component records
+	ScriptFields,
+	NamedHandles,
+	ShapePoints,
+
+	Count
+};
+
+struct Header {
+	char     Magic[4];
+	uint32_t Version;
+	uint32_t SceneName;
+	uint32_t EntityCount;
+	uint32_t SectionCount;
+	uint32_t StringCount;
+	uint64_t StringTableOffset;
+};
+
+struct Section {
+	SectionType Type;
+	uint32_t Count;
+	uint64_t Offset;
+};
+
+struct TransformRecord {
+	glm::vec3 Position;
+	glm::quat Rotation;
+	glm::vec3 Scale;
+};
+
+struct SpriteRendererRecord {
+	glm::vec4 Color;
+	uint64_t  Handle;
+	float     TileScale;
+	uint32_t  HasSubTexture;
+	glm::vec2 TileSize;
+	glm::vec2 TileIndex;
+	glm::vec2 TileSeparation;
+};
+
+struct CameraRecord {
+	float   Size;
+	float   Near;
+	float   Far;
+	uint8_t Primary;
+	uint8_t FixedAspectRatio;
+	uint8_t Padding[2];
+};
+
+struct NativeScriptRecord {
+	uint32_t ScriptName;
+	uint32_t FirstField;
+	uint32_t FieldCount;
+};
+
+// strings are stored as a string index in the first value
+struct ScriptFieldRecord {
+	uint32_t Name;
+	uint32_t Type;
+	uint64_t Value[2];
+};
+
+struct RigidBodyRecord {
+	int32_t Layer;
+	float   GravityFactor;
+	float   Mass;
+};
+
+struct CollisionBodyRecord {
+	int32_t Layer;
+	uint8_t IsStatic;
+	uint8_t IsSensor;
+	uint8_t Padding[2];
+};
+
+// polygon points are FirstPoint..FirstPoint+PointCount in the ShapePoints array, glm::vec2 each
+struct CollisionShapeRecord {
+	uint32_t  Shape;
+	float     Float;
+	glm::vec3 Vector;
+	uint32_t  FirstPoint;
+	uint32_t  PointCount;
+};
+
+// only prefab roots are stored, children come from the prefab file
+struct PrefabRecord {
+	uint32_t Path;
+};
+
+struct NamedHandleRecord {
+	uint32_t Name;
+	uint32_t Padding;
+	uint64_t Handle;
+};
+
+struct AudioSourcesRecord {
+	uint32_t FirstSound;
+	uint32_t SoundCount;
+};
+
+struct AnimationPlayerRecord {
+	uint64_t CurrentAnimation;
+	uint32_t FirstAnimation;
+	uint32_t AnimationCount;
+};
+
+struct TextRecord {
+	glm::vec4 Color;
+	uint64_t  Font;
+	float     Scale;
+	float     Visible;
+	uint32_t  Data;
+	uint32_t  Padding;
+};
+
+struct SceneControlRecord {
+	uint32_t Persistent;
+};
+
+}
+}
@@ -0,0 +1,133 @@
+#include "scene_preload.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "core/application.h"
+#include "project/project.h"
+#include "scene/prefab_cache.h"
+
+namespace Enik {
+
+// main thread time spent warming assets per frame
+static constexpr auto PRELOAD_FRAME_BUDGET = std::chrono::milliseconds(4);
+
+Ref<ScenePreload> ScenePreload::Start(const std::string& path) {
+	Ref<ScenePreload> preload = Ref<ScenePreload>(new ScenePreload(path));
+
+	// NOTE: the job keeps the preload alive if the scene is destroyed first
+	Application::Get().GetJobSystem().Submit([preload]() {
+		preload->Parse();
+	});
+	return preload;
+}
+
+static void AddAsset(std::vector<AssetHandle>& assets, const YAML::Node& node) {
+	if (node) {
+		AssetHandle handle = node.as<uint64_t>();
+		if (handle != 0) {
+			assets.push_back(handle);
+		}
+	}
+}
+
+static void AddAssetMap(std::vector<AssetHandle>& assets, const YAML::Node& node) {
+	if (node and node.IsMap()) {
+		for (auto it = node.begin(); it != node.end(); ++it) {
+			AddAsset(assets, it->second);
+		}
+	}
+}
+
+void ScenePreload::Parse() {
+	EN_PROFILE_SCOPE;
+
+	try {
+		m_Data = YAML::LoadFile(m_Path);
+
+		const YAML::Node entities = m_Data["Entities"];
+		if (entities and entities.IsSequence()) {
+			for (const auto& entity : entities) {
+				if (auto prefab = entity["Component::Prefab"]) {
+					if (prefab["RootPrefab"] and prefab["RootPrefab"].as<bool>() and prefab["PrefabPath"]) {
+						m_Prefabs.push_back(prefab["PrefabPath"].as<std::string>());
+					}
+					continue;
+				}
+				if (auto sprite = entity["Component::SpriteRenderer"]) {
+					AddAsset(m_Assets, sprite["TextureHandle"]);
+				}
+				if (auto text = entity["Component::Text"]) {
+					AddAsset(m_Assets, text["Font"]);
+				}
+				if (auto sources = entity["Component::AudioSources"]) {
+					AddAssetMap(m_Assets, sources["Sounds"]);
+				}
+				if (auto player = entity["Component::AnimationPlayer"]) {
+					AddAssetMap(m_Assets, player["Animations"]);
+				}
+			}
+		}
+	}
+	catch (const YAML::Exception&) {
+		// the scene change will load the file again and report the error
+		m_Data = YAML::Node();
+		m_Assets.clear();
+		m_Prefabs.clear();
+	}
+
+	std::sort(m_Assets.begin(), m_Assets.end(), [](AssetHandle a, AssetHandle b) { return (uint64_t)a < (uint64_t)b; });
+	m_Assets.erase(std::unique(m_Assets.begin(), m_Assets.end(), [](AssetHandle a, AssetHandle b) { return (uint64_t)a == (uint64_t)b; }), m_Assets.end());
+	std::sort(m_Prefabs.begin(), m_Prefabs.end());
+	m_Prefabs.erase(std::unique(m_Prefabs.begin(), m_Prefabs.end()), m_Prefabs.end());
+
+	m_Parsed.store(true, std::memory_order_release);
+}
+
+void ScenePreload::Update() {
+	if (not m_Parsed.load(std::memory_order_acquire) or IsReady()) {
+		return;
+	}
+	EN_PROFILE_SCOPE;
+
+	// NOTE: textures are uploaded to the gpu, so assets are loaded on the main thread
+	const auto start = std::chrono::steady_clock::now();
+	auto over_budget = [&]() {
+		return std::chrono::steady_clock::now() - start > PRELOAD_FRAME_BUDGET;
+	};
+
+	while (m_NextPrefab < m_Prefabs.size()) {
+		PrefabCache::Preload(m_Prefabs[m_NextPrefab++]);
+		if (over_budget()) {
+			return;
+		}
+	}
+
+	auto asset_manager = Project::GetAssetManager();
+	while (m_NextAsset < m_Assets.size()) {
+		AssetHandle handle = m_Assets[m_NextAsset++];
+		if (asset_manager->IsAssetHandleValid(handle) and not asset_manager->IsAssetLoaded(handle)) {
+			asset_manager->GetAsset(handle);
+		}
+		if (over_budget()) {
+			return;
+		}
+	}
+}
+
+bool ScenePreload::IsReady() const {
+	return m_Parsed.load(std::memory_order_acquire)
+		and m_NextPrefab == m_Prefabs.size()
+		and m_NextAsset == m_Assets.size();
+}
+
+float ScenePreload::GetProgress() const {
+	if (not m_Parsed.load(std::memory_order_acquire)) {
+		return 0.0f;
+	}
+	const size_t total = 1 + m_Prefabs.size() + m_Assets.size();
+	const size_t done  = 1 + m_NextPrefab + m_NextAsset;
+	return (float)done / (float)total;
+}
+
+}
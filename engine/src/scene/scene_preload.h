@@ -0,0 +1,46 @@
+#pragma once
+#include <base.h>
+#include <atomic>
+#include <yaml-cpp/yaml.h>
+
+#include "asset/asset.h"
+
+namespace Enik {
+
+// parses a scene file on a worker thread, then loads the prefabs and assets it uses
+// on the main thread over several frames, so the scene change itself is cheap
+class ScenePreload {
+public:
+	// path has to be absolute
+	static Ref<ScenePreload> Start(const std::string& path);
+
+	// main thread, warms assets until the frame budget is used
+	void Update();
+
+	bool IsReady() const;
+	// 0 to 1, parsing counts as one step, every prefab and asset as one step
+	float GetProgress() const;
+
+	const std::string& GetPath() const { return m_Path; }
+	// only valid once ready, empty if the yaml could not be parsed
+	YAML::Node& GetData() { return m_Data; }
+
+private:
+	ScenePreload(const std::string& path) : m_Path(path) {}
+
+	void Parse();
+
+private:
+	std::string m_Path;
+
+	// written by the worker before m_Parsed is set
+	YAML::Node m_Data;
+	std::vector<AssetHandle> m_Assets;
+	std::vector<std::string> m_Prefabs;
+	std::atomic<bool> m_Parsed = false;
+
+	size_t m_NextAsset = 0;
+	size_t m_NextPrefab = 0;
+};
+
+}
@@ -7,6 +7,8 @@
 #include "gtc/type_ptr.hpp"
 #include "project/project.h"
 #include "scene/components.h"
+#include "scene/entity_copy.h"
+#include "scene/prefab_cache.h"
 #include "script_system/script_registry.h"
 
 
@@ -152,38 +154,69 @@ bool IsChildOfPrefab(Entity entity) {
 	return false;
 }
 
+// the emitter writes straight into a buffered temporary file,
+// filepath is only replaced once everything is written
+static bool WriteYamlFile(const std::string& filepath, const std::function<void(YAML::Emitter&)>& write) {
+	const std::string temp_path = filepath + ".tmp";
+	{
+		std::vector<char> buffer(64 * 1024);
+		std::ofstream fout;
+		fout.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+		fout.open(temp_path);
+		if (not fout) {
+			EN_CORE_ERROR("Failed to open '{0}' for writing", temp_path);
+			return false;
+		}
+
+		YAML::Emitter out(fout);
+		write(out);
+		fout.flush();
+
+		if (not out.good() or not fout) {
+			EN_CORE_ERROR("Failed to write '{0}'\n	{1}", filepath, out.GetLastError());
+			fout.close();
+			std::error_code error;
+			std::filesystem::remove(temp_path, error);
+			return false;
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temp_path, filepath, error);
+	if (error) {
+		EN_CORE_ERROR("Failed to replace '{0}'\n	{1}", filepath, error.message());
+		std::filesystem::remove(temp_path, error);
+		return false;
+	}
+	return true;
+}
+
 void SceneSerializer::Serialize(const std::string& filepath) {
 	// EN_CORE_INFO("Serializing scene   '{0}', in '{1}'", m_Scene->GetName(), filepath);
-	YAML::Emitter out;
-	out << YAML::BeginMap;
+	WriteYamlFile(filepath, [&](YAML::Emitter& out) {
+		out << YAML::BeginMap;
 
-	out << YAML::Key << "Scene" << YAML::Value << m_Scene->GetName();
+		out << YAML::Key << "Scene" << YAML::Value << m_Scene->GetName();
 
-	out << YAML::Key << "Entities";
-	out << YAML::Value << YAML::BeginSeq;
+		out << YAML::Key << "Entities";
+		out << YAML::Value << YAML::BeginSeq;
 
-	m_Scene->m_Registry.each([&](auto entityID) {
-		Entity entity = Entity(entityID, m_Scene);
-		if (not entity) {
-			return;
-		}
-		if (entity.Has<Component::Prefab>()) {
-			if (IsChildOfPrefab(entity)) {
+		m_Scene->m_Registry.each([&](auto entityID) {
+			Entity entity = Entity(entityID, m_Scene);
+			if (not entity) {
 				return;
 			}
-		}
-		SerializeEntity(out, entity);
-	});
-
-	out << YAML::EndSeq;
-	out << YAML::EndMap;
-
-	std::ofstream fout(filepath);
-	fout << out.c_str();
-}
+			if (entity.Has<Component::Prefab>()) {
+				if (IsChildOfPrefab(entity)) {
+					return;
+				}
+			}
+			SerializeEntity(out, entity);
+		});
 
-void SceneSerializer::SerializeRuntime(const std::string& filepath) {
-	EN_CORE_ASSERT(false);
+		out << YAML::EndSeq;
+		out << YAML::EndMap;
+	});
 }
 
 bool SceneSerializer::Deserialize(const std::string& filepath) {
@@ -196,6 +229,10 @@ bool SceneSerializer::Deserialize(const std::string& filepath) {
 		return false;
 	}
 
+	return Deserialize(data);
+}
+
+bool SceneSerializer::Deserialize(YAML::Node& data) {
 	if (not data.IsMap() or not data["Scene"]) {
 		return false;
 	}
@@ -227,170 +264,48 @@ bool SceneSerializer::Deserialize(const std::string& filepath) {
 	return true;
 }
 
-bool SceneSerializer::DeserializeRuntime(const std::string& filepath) {
-	EN_CORE_ASSERT(false);
-	return false;
-}
-
-const UUID SceneSerializer::DuplicateEntity(const std::string& filepath, UUID uuid) {
-	YAML::Node data = YAML::LoadFile(filepath);
-	if (not data.IsMap() or not (data["Scene"] or data["Prefab"])) {
+const UUID SceneSerializer::DuplicateEntity(UUID uuid) {
+	Entity root = m_Scene->FindEntityByUUID(uuid);
+	if (not root) {
 		return -1;
 	}
 
-	auto entities = data["Entities"];
-	if (not entities) {
-		return -1;
-	}
+	// copies straight from the registry, only the subtree is touched
+	UUIDMap uuid_map;
+	std::vector<Entity> copies = CopyEntities(CollectHierarchy(root), m_Scene, uuid_map);
 
-	Entity parent_of_root;
-	Entity root_entity = m_Scene->FindEntityByUUID(uuid);
-	if (root_entity.HasParent()) {
-		parent_of_root = root_entity.GetParent();
+	Entity copy_root = copies.front();
+	if (root.HasParent()) {
+		copy_root.Reparent(root.GetParent());
 	}
 
-	// strip unrelated entities from yaml node
-	YAML::Node related_entities;
-	Component::Family& root_family = root_entity.GetOrAddFamily();
-	for (const auto& entity : entities) {
-		uint64_t data_uuid = entity["Entity"].as<uint64_t>();
-		Entity test_entity = m_Scene->FindEntityByUUID(data_uuid);
-		EN_CORE_ASSERT(test_entity);
-
-		if (data_uuid == uuid) {
-			related_entities.push_back(entity);
-		}
-		else if (root_family.HasEntityAsChild(test_entity)) {
-			related_entities.push_back(entity);
-		}
-	}
-	entities = related_entities;
-
-	std::unordered_map<uint64_t, uint64_t> uuid_map;
-	UUID new_root_uuid = UUID();
-	uuid_map[uuid] = new_root_uuid;
-	UpdateUUIDs(entities, uuid_map, new_root_uuid);
-	
-	// iterate reversed to not change entity indexes
-	for (size_t i = entities.size(); i > 0; --i) {
-		auto relative_entity = entities[i - 1];
-		uint64_t relative_uuid = relative_entity["Entity"].as<uint64_t>();
-
-		std::string name;
-		if (auto tag = relative_entity["Component::Tag"]) {
-			name = tag["Text"].as<std::string>();
-		}
-
-		DeserializeEntity(relative_entity, relative_uuid, name);
-	}
-
-	if (Entity root_entity = m_Scene->FindEntityByUUID(new_root_uuid)) {
-		root_entity.Reparent(parent_of_root);
-	}
-
-	return new_root_uuid;
+	return copy_root.GetID();
 }
 
 
-void SceneSerializer::ReloadNativeScriptFields(const std::string& filepath) {
-	YAML::Node data = YAML::LoadFile(filepath);
-	if (not data.IsMap() or not data["Scene"]) {
-		return;
-	}
-
-	auto entities = data["Entities"];
-	if (not entities) {
-		return;
-	}
-
-	for (auto entity_node : entities) {
-		if (not entity_node["Component::NativeScript"]) {
-			continue;
-		}
-
-		uint64_t entity_id = entity_node["Entity"].as<uint64_t>();
-		Entity entity = m_Scene->FindEntityByUUID(entity_id);
-		if (entity and entity.Has<Component::NativeScript>()) {
-
-			// destroy old script
-			auto& script = entity.Get<Component::NativeScript>();
-			script.DestroyScript(&script);
-			entity.Remove<Component::NativeScript>();
-
-			DeserializeNativeScript(entity_node, entity);
-		}
-	}
-}
-
 void SceneSerializer::CreatePrefab(const std::string& filepath, Entity entity_to_prefab) {
-	YAML::Emitter out;
-	out << YAML::BeginMap;
-	out << YAML::Key << "Prefab" << YAML::Value << entity_to_prefab.GetTag();
-	out << YAML::Key << "Root"   << YAML::Value << entity_to_prefab.Get<Component::ID>().uuid;
-
-	out << YAML::Key << "Entities";
-	out << YAML::Value << YAML::BeginSeq;
-
-	SerializeEntity(out, entity_to_prefab);
-
-	Component::Family entity_family = entity_to_prefab.GetOrAddFamily();
-	if (entity_family.Children.size() > 0) {
-		m_Scene->m_Registry.each([&](auto entityID) {
-			Entity entity = Entity(entityID, m_Scene);
-			if (not entity) {
-				return;
-			}
-			if (entity_family.HasEntityAsChild(entity)) {
-				SerializeEntity(out, entity);
-			}
-		});
-	}
+	std::vector<Entity> entities = CollectHierarchy(entity_to_prefab);
 
-	out << YAML::EndSeq;
-	out << YAML::EndMap;
+	bool written = WriteYamlFile(filepath, [&](YAML::Emitter& out) {
+		out << YAML::BeginMap;
+		out << YAML::Key << "Prefab" << YAML::Value << entity_to_prefab.GetTag();
+		out << YAML::Key << "Root"   << YAML::Value << entity_to_prefab.Get<Component::ID>().uuid;
 
-	std::ofstream fout(filepath);
-	fout << out.c_str();
-	fout.close();
+		out << YAML::Key << "Entities";
+		out << YAML::Value << YAML::BeginSeq;
 
-	// remove Component::Prefab and roots parent
-	YAML::Node data;
-	try {
-		data = YAML::LoadFile(filepath);
-	}
-	catch (const YAML::ParserException& e) {
-		EN_CORE_ERROR("Failed to load prefab file '{0}'\n	{1}", filepath, e.what());
-		return;
-	}
-	auto entities = data["Entities"];
-	if (not entities or not entities.IsSequence()) {
-		return;
-	}
-	for (auto entity : entities) {
-		if (entity["Entity"].as<std::uint64_t>() == entity_to_prefab.GetID()) {
-			if (entity["Component::Prefab"]) {
-				entity.remove("Component::Prefab");
-			}
-			if (auto fam = entity["Component::Family"]) {
-				if (fam["Parent"]) {
-					fam.remove("Parent");
-				}
-				if (not fam["Children"]) {
-					entity.remove("Component::Family");
-				}
-			}
-			break;
+		// root is written without Component::Prefab and its parent
+		SerializeEntity(out, entity_to_prefab, true);
+		for (size_t i = 1; i < entities.size(); i++) {
+			SerializeEntity(out, entities[i]);
 		}
-	}
 
-	// save it back
-	try {
-		std::ofstream fout(filepath);
-		fout << data;
-		fout.close();
-	}
-	catch (const std::exception& e) {
-		EN_CORE_ERROR("Failed to save prefab file '{0}'\n    {1}", filepath, e.what());
+		out << YAML::EndSeq;
+		out << YAML::EndMap;
+	});
+
+	if (written) {
+		PrefabCache::Invalidate(filepath);
 	}
 }
 
@@ -474,6 +389,37 @@ void SceneSerializer::UpdateUUIDs(YAML::Node& entities, std::unordered_map<uint6
 }
 
 Entity SceneSerializer::InstantiatePrefab(const std::string& filepath, UUID instance_uuid, bool no_uuid_update) {
+	Entity root_entity = LoadPrefab(filepath, instance_uuid, no_uuid_update);
+	if (not root_entity) {
+		return {};
+	}
+
+	// NOTE: reason: we need to be able to get script instance
+	// right after doing InstantiateScript
+	for (Entity entity : CollectHierarchy(root_entity)) {
+		if (not entity.Has<Component::NativeScript>()) {
+			continue;
+		}
+		auto& ns = entity.Get<Component::NativeScript>();
+		if (not ns.Instance and ns.InstantiateScript) {
+			ns.Instance = ns.InstantiateScript();
+			if (ns.Instance) {
+				ns.Instance->m_Entity = entity;
+				ns.ApplyNativeScriptFieldsToInstance();
+			}
+		}
+	}
+
+	if (root_entity.HasFamily()) {
+		Component::Transform& transform = root_entity.Get<Component::Transform>();
+		Component::Family&    family    = root_entity.Get<Component::Family>   ();
+		family.SetChildrenGlobalTransformRecursive(transform);
+	}
+
+	return root_entity;
+}
+
+Entity SceneSerializer::LoadPrefab(const std::string& filepath, UUID instance_uuid, bool no_uuid_update) {
 	YAML::Node data;
 	try {
 		data = YAML::LoadFile(filepath);
@@ -529,6 +475,9 @@ Entity SceneSerializer::InstantiatePrefab(const std::string& filepath, UUID inst
 	}
 
 	Entity root_entity = m_Scene->FindEntityByUUID(instance_uuid);
+	if (not root_entity) {
+		return {};
+	}
 
 	Component::Prefab& component = root_entity.GetOrAdd<Component::Prefab>();
 	component.RootPrefab = true;
@@ -551,28 +500,14 @@ Entity SceneSerializer::InstantiatePrefab(const std::string& filepath, UUID inst
 	}
 
 
-	// NOTE: reason: we need to be able to get script instance
-	// right after doing InstantiateScript
-	m_Scene->m_Registry.view<Component::NativeScript>().each([=](auto e, auto& ns) {
-		if (not ns.Instance or ns.Instance == nullptr) {
-			if (ns.InstantiateScript and ns.InstantiateScript != nullptr) {
-				ns.Instance = ns.InstantiateScript();
-				ns.Instance->m_Entity = Entity(e, m_Scene);
-				ns.ApplyNativeScriptFieldsToInstance();
-			}
-		}
-	});
-
-	if (root_entity.HasFamily()) {
-		Component::Transform& transform = root_entity.Get<Component::Transform>();
-		Component::Family&    family    = root_entity.Get<Component::Family>   ();
-		family.SetChildrenGlobalTransformRecursive(transform);
-	}
-
 	return root_entity;
 }
 
-void SceneSerializer::SerializeEntity(YAML::Emitter& out, Entity& entity) {
+void SceneSerializer::SerializeEntity(YAML::Emitter& out, Entity& entity, bool prefab_root) {
+	// released pool instances only exist at runtime
+	if (entity.Has<Component::Inactive>()) {
+		return;
+	}
 	if (entity.Has<Component::SceneControl>()) {
 		if(entity.Get<Component::SceneControl>().AutoLoaded) {
 			return;
@@ -690,16 +625,24 @@ void SceneSerializer::SerializeEntity(YAML::Emitter& out, Entity& entity) {
 		out << YAML::Key << "Shape"  << YAML::Value << cs.ToString();
 		out << YAML::Key << "Float"  << YAML::Value << cs.Float;
 		out << YAML::Key << "Vector" << YAML::Value << cs.Vector;
+		if (cs.Shape == Component::CollisionShape::Type::POLYGON) {
+			out << YAML::Key << "Points" << YAML::Value << YAML::BeginSeq;
+			for (const glm::vec2& point : cs.Points) {
+				out << point;
+			}
+			out << YAML::EndSeq;
+		}
 
 		out << YAML::EndMap;
 	}
 
 	if (entity.HasFamily()) {
-		if (entity.HasParent() or entity.GetChildren().size() > 0) {
+		bool write_parent = entity.HasParent() and not prefab_root;
+		if (write_parent or entity.GetChildren().size() > 0) {
 			out << YAML::Key << "Component::Family";
 			out << YAML::BeginMap;
 
-			if (entity.HasParent() and entity.GetParent().Has<Component::ID>()) {
+			if (write_parent and entity.GetParent().Has<Component::ID>()) {
 				out << YAML::Key << "Parent" << YAML::Value << entity.GetParent().Get<Component::ID>();
 			}
 			if (entity.GetChildren().size() > 0) {
@@ -716,7 +659,7 @@ void SceneSerializer::SerializeEntity(YAML::Emitter& out, Entity& entity) {
 		}
 	}
 
-	if (entity.Has<Component::Prefab>()) {
+	if (entity.Has<Component::Prefab>() and not prefab_root) {
 		out << YAML::Key << "Component::Prefab";
 		out << YAML::BeginMap;
 
@@ -927,6 +870,11 @@ void SceneSerializer::DeserializeEntity(YAML::Node& entity, uint64_t uuid, std::
 		cs.Shape  = Component::CollisionShape::TypeFromString(node["Shape"].as<std::string>());
 		cs.Float  = node["Float"].as<float>();
 		cs.Vector = node["Vector"].as<glm::vec3>();
+		if (auto points = node["Points"]) {
+			for (size_t i = 0; i < points.size(); i++) {
+				cs.Points.push_back(points[i].as<glm::vec2>());
+			}
+		}
 	}
 
 
@@ -1016,12 +964,10 @@ void SceneSerializer::DeserializeNativeScript(YAML::Node& node, Entity& entity)
 
 	auto script_name = native_script["ScriptName"].as<std::string>();
 
-	for (auto& pair : ScriptRegistry::GetRegistry()) {
-		if (pair.first == script_name) {
-			entity.Add<Component::NativeScript>().Bind(pair.first, pair.second);
-			DeserializeNativeScriptFields(native_script, entity);
-			return;
-		}
+	if (const ScriptClass* script_class = ScriptRegistry::Find(script_name)) {
+		entity.Add<Component::NativeScript>().Bind(*script_class);
+		DeserializeNativeScriptFields(native_script, entity);
+		return;
 	}
 
 	EN_ERROR("Couldn't find NativeScript '{0}' for entity '{1}'", script_name, entity.GetTag());
@@ -1047,23 +993,21 @@ void WriteFieldValueToFile(YAML::Emitter& out, FieldType field_type, void* field
 }
 
 void SceneSerializer::SerializeNativeScriptFields(YAML::Emitter& out, Component::NativeScript& script) {
-	if (script.NativeScriptFields.size() == 0) {
+	if (not script.FieldSchema or script.FieldSchema->Fields.empty()) {
 		return;
 	}
 
 	out << YAML::Key << "ScriptFields";
 	out << YAML::BeginMap;
 
-	for (auto& pair : script.NativeScriptFields) {
-		auto& field = pair.second;
-
+	for (const ScriptFieldInfo& field : script.FieldSchema->Fields) {
 		out << YAML::Key << field.Name;
 		out << YAML::BeginMap;
 
-		out << YAML::Key << "Type"  << YAML::Value << field.TypeName();
+		out << YAML::Key << "Type"  << YAML::Value << NativeScriptField::TypeName(field.Type);
 		out << YAML::Key << "Value" << YAML::Value;
 
-		WriteFieldValueToFile(out, field.Type, field.Value);
+		WriteFieldValueToFile(out, field.Type, script.GetFieldValue(field));
 
 		out << YAML::EndMap; // field.Name
 	}
@@ -1076,28 +1020,22 @@ void SceneSerializer::SerializeNativeScriptFields(YAML::Emitter& out, Component:
 
 
 
-// TODO we can do better than this...
-// we create new values every hot reload...
-
-
-void* GetFieldValueFromNode(YAML::Node field_value, FieldType field_type) {
+void ReadFieldValueFromNode(YAML::Node field_value, FieldType field_type, void* value) {
 	switch (field_type) {
-		case FieldType::NONE: {
-			EN_CORE_ERROR("GetFieldValueFromNode field_type is NONE !");
-			return nullptr;
-		}
-		case FieldType::BOOL:   return static_cast<void*>(new bool       (field_value.as<bool>()));
-		case FieldType::INT:    return static_cast<void*>(new int        (field_value.as<int>()));
-		case FieldType::FLOAT:  return static_cast<void*>(new float      (field_value.as<float>()));
-		case FieldType::DOUBLE: return static_cast<void*>(new double     (field_value.as<double>()));
-		case FieldType::VEC2:   return static_cast<void*>(new glm::vec2  (field_value.as<glm::vec2>()));
-		case FieldType::VEC3:   return static_cast<void*>(new glm::vec3  (field_value.as<glm::vec3>()));
-		case FieldType::VEC4:   return static_cast<void*>(new glm::vec4  (field_value.as<glm::vec4>()));
+		case FieldType::NONE:
+			EN_CORE_ERROR("ReadFieldValueFromNode field_type is NONE !");
+			break;
+		case FieldType::BOOL:   *static_cast<bool*>       (value) = field_value.as<bool>();        break;
+		case FieldType::INT:    *static_cast<int*>        (value) = field_value.as<int>();         break;
+		case FieldType::FLOAT:  *static_cast<float*>      (value) = field_value.as<float>();       break;
+		case FieldType::DOUBLE: *static_cast<double*>     (value) = field_value.as<double>();      break;
+		case FieldType::VEC2:   *static_cast<glm::vec2*>  (value) = field_value.as<glm::vec2>();   break;
+		case FieldType::VEC3:   *static_cast<glm::vec3*>  (value) = field_value.as<glm::vec3>();   break;
+		case FieldType::VEC4:   *static_cast<glm::vec4*>  (value) = field_value.as<glm::vec4>();   break;
 		case FieldType::PREFAB:
-		case FieldType::STRING: return static_cast<void*>(new std::string(field_value.as<std::string>()));
-		case FieldType::ENTITY: return static_cast<void*>(new uint64_t   (field_value.as<uint64_t>()));
+		case FieldType::STRING: *static_cast<std::string*>(value) = field_value.as<std::string>(); break;
+		case FieldType::ENTITY: *static_cast<uint64_t*>   (value) = field_value.as<uint64_t>();    break;
 	}
-	return nullptr;
 }
 
 
@@ -1115,7 +1053,7 @@ void SceneSerializer::DeserializeNativeScriptFields(YAML::Node& node, Entity& en
 	);
 
 
-	if (not node["ScriptFields"] or not node["ScriptFields"].IsMap()) {
+	if (not script.FieldSchema or not node["ScriptFields"] or not node["ScriptFields"].IsMap()) {
 		return;
 	}
 
@@ -1123,7 +1061,8 @@ void SceneSerializer::DeserializeNativeScriptFields(YAML::Node& node, Entity& en
 		std::string field_name = field.first.as<std::string>();
 
 		// field is removed from native script, do not load
-		if (script.NativeScriptFields.find(field_name) == script.NativeScriptFields.end()) {
+		const ScriptFieldInfo* info = script.FieldSchema->Find(field_name);
+		if (info == nullptr) {
 			continue;
 		}
 
@@ -1133,12 +1072,13 @@ void SceneSerializer::DeserializeNativeScriptFields(YAML::Node& node, Entity& en
 			continue;
 		}
 
+		// type changed, keep the default
 		const std::string& field_type_string = field_node["Type"].as<std::string>();
-		FieldType field_type = NativeScriptField::NameType(field_type_string);
-
-		void* field_value = GetFieldValueFromNode(field_node["Value"], field_type);
+		if (NativeScriptField::NameType(field_type_string) != info->Type) {
+			continue;
+		}
 
-		script.NativeScriptFields[field_name].Value = field_value;
+		ReadFieldValueFromNode(field_node["Value"], info->Type, script.FieldValues.Get(*info));
 	}
 
 }
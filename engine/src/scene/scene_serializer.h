@@ -14,20 +14,29 @@ public:
 	SceneSerializer(const Ref<Scene>& scene) : SceneSerializer(scene.get()) {}
 
 	void Serialize(const std::string& filepath);
+	// cooked binary scene, see scene_binary.h
 	void SerializeRuntime(const std::string& filepath);
 
 	bool Deserialize(const std::string& filepath);
+	// already parsed scene, see ScenePreload
+	bool Deserialize(YAML::Node& data);
 	bool DeserializeRuntime(const std::string& filepath);
+	// loads the cooked scene next to filepath when it is not older than the yaml,
+	// otherwise uses the preloaded yaml if there is one
+	bool DeserializeAuto(const std::string& filepath, YAML::Node* preloaded = nullptr);
 
-	const UUID DuplicateEntity(const std::string& filepath, UUID uuid);
+	static std::string GetRuntimePath(const std::string& filepath);
 
-	void ReloadNativeScriptFields(const std::string& filepath);
+	// copies the entity and its children from the registry
+	const UUID DuplicateEntity(UUID uuid);
 
 	void CreatePrefab(const std::string& filepath, Entity entity_to_prefab);
 	Entity InstantiatePrefab(const std::string& filepath, UUID instance_uuid = UUID(), bool no_uuid_update = false);
+	// only creates the entities, scripts are not instantiated
+	Entity LoadPrefab(const std::string& filepath, UUID instance_uuid = UUID(), bool no_uuid_update = false);
 
 private:
-	void SerializeEntity(YAML::Emitter& out, Entity& entity);
+	void SerializeEntity(YAML::Emitter& out, Entity& entity, bool prefab_root = false);
 	void DeserializeEntity(YAML::Node& data, uint64_t uuid, std::string& name);
 
 	void DeserializeNativeScript(YAML::Node& node, Entity& entity);
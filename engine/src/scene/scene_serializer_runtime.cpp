@@ -0,0 +1,821 @@
+#include "scene_serializer.h"
+
+#include <pch.h>
+#include <array>
+#include <fstream>
+
+#include "core/mapped_file.h"
+#include "scene/scene_binary.h"
+#include "script_system/script_registry.h"
+
+namespace Enik {
+
+using namespace SceneBinary;
+
+static uint64_t AlignOffset(uint64_t offset) {
+	return (offset + 7) & ~uint64_t(7);
+}
+
+// component sections store the entity indexes first, records start aligned after them
+static uint64_t GetRecordsOffset(const Section& section) {
+	return AlignOffset(section.Offset + section.Count * sizeof(uint32_t));
+}
+
+static uint64_t GetRecordSize(SectionType type) {
+	switch (type) {
+		case SectionType::Entities:        return sizeof(uint64_t) + sizeof(uint32_t) * 2;
+		case SectionType::Transform:       return sizeof(TransformRecord);
+		case SectionType::SpriteRenderer:  return sizeof(SpriteRendererRecord);
+		case SectionType::Camera:          return sizeof(CameraRecord);
+		case SectionType::NativeScript:    return sizeof(NativeScriptRecord);
+		case SectionType::RigidBody:       return sizeof(RigidBodyRecord);
+		case SectionType::CollisionBody:   return sizeof(CollisionBodyRecord);
+		case SectionType::CollisionShape:  return sizeof(CollisionShapeRecord);
+		case SectionType::Prefab:          return sizeof(PrefabRecord);
+		case SectionType::AudioSources:    return sizeof(AudioSourcesRecord);
+		case SectionType::AnimationPlayer: return sizeof(AnimationPlayerRecord);
+		case SectionType::Text:            return sizeof(TextRecord);
+		case SectionType::SceneControl:    return sizeof(SceneControlRecord);
+		case SectionType::ScriptFields:    return sizeof(ScriptFieldRecord);
+		case SectionType::NamedHandles:    return sizeof(NamedHandleRecord);
+		case SectionType::ShapePoints:     return sizeof(glm::vec2);
+		case SectionType::Count:           return 0;
+	}
+	return 0;
+}
+
+static bool IsArraySection(SectionType type) {
+	return type == SectionType::Entities or type == SectionType::ScriptFields or
+		type == SectionType::NamedHandles or type == SectionType::ShapePoints;
+}
+
+static uint64_t GetSectionEnd(const Section& section) {
+	uint64_t records = IsArraySection(section.Type) ? section.Offset : GetRecordsOffset(section);
+	return records + section.Count * GetRecordSize(section.Type);
+}
+
+
+
+struct StringTable {
+	std::vector<std::string> Strings;
+	std::unordered_map<std::string, uint32_t> Indexes;
+
+	uint32_t Add(const std::string& str) {
+		auto it = Indexes.find(str);
+		if (it != Indexes.end()) {
+			return it->second;
+		}
+		uint32_t index = (uint32_t)Strings.size();
+		Strings.push_back(str);
+		Indexes.emplace(str, index);
+		return index;
+	}
+};
+
+template <typename Record>
+struct ComponentSection {
+	std::vector<uint32_t> Entities;
+	std::vector<Record> Records;
+
+	void Push(uint32_t entity, const Record& record) {
+		Entities.push_back(entity);
+		Records.push_back(record);
+	}
+};
+
+struct SectionWriter {
+	std::vector<uint8_t> Data;
+	std::vector<Section> Sections;
+
+	void Append(const void* data, uint64_t size) {
+		const uint8_t* bytes = (const uint8_t*)data;
+		Data.insert(Data.end(), bytes, bytes + size);
+	}
+	void Align() {
+		Data.resize(AlignOffset(Data.size()), 0);
+	}
+
+	template <typename T>
+	void AppendArray(const std::vector<T>& array) {
+		Append(array.data(), array.size() * sizeof(T));
+	}
+
+	template <typename Record>
+	void AddArray(SectionType type, const std::vector<Record>& records) {
+		if (records.empty()) {
+			return;
+		}
+		Align();
+		Sections.push_back({ type, (uint32_t)records.size(), Data.size() });
+		AppendArray(records);
+	}
+
+	template <typename Record>
+	void AddComponents(SectionType type, const ComponentSection<Record>& section) {
+		if (section.Entities.empty()) {
+			return;
+		}
+		Align();
+		Sections.push_back({ type, (uint32_t)section.Entities.size(), Data.size() });
+		AppendArray(section.Entities);
+		Align();
+		AppendArray(section.Records);
+	}
+};
+
+// parents first, children in order. released pool instances and autoloads
+// are runtime only, prefab children come from the prefab file
+static void CollectRuntimeEntities(Entity root, std::vector<Entity>& entities) {
+	std::vector<Entity> stack = { root };
+	while (not stack.empty()) {
+		Entity entity = stack.back();
+		stack.pop_back();
+
+		if (entity.Has<Component::Inactive>()) {
+			continue;
+		}
+		if (entity.Has<Component::SceneControl>() and entity.Get<Component::SceneControl>().AutoLoaded) {
+			continue;
+		}
+		if (entity.Has<Component::Prefab>()) {
+			if (entity.Get<Component::Prefab>().RootPrefab) {
+				entities.push_back(entity);
+			}
+			continue;
+		}
+
+		entities.push_back(entity);
+		if (entity.HasFamily()) {
+			auto& children = entity.GetChildren();
+			for (auto it = children.rbegin(); it != children.rend(); ++it) {
+				if (*it) {
+					stack.push_back(*it);
+				}
+			}
+		}
+	}
+}
+
+static void WriteFieldValue(ScriptFieldRecord& record, FieldType type, void* value, StringTable& strings) {
+	switch (type) {
+		case FieldType::NONE:   break;
+		case FieldType::BOOL:   memcpy(record.Value, value, sizeof(bool));      break;
+		case FieldType::INT:    memcpy(record.Value, value, sizeof(int));       break;
+		case FieldType::FLOAT:  memcpy(record.Value, value, sizeof(float));     break;
+		case FieldType::DOUBLE: memcpy(record.Value, value, sizeof(double));    break;
+		case FieldType::VEC2:   memcpy(record.Value, value, sizeof(glm::vec2)); break;
+		case FieldType::VEC3:   memcpy(record.Value, value, sizeof(glm::vec3)); break;
+		case FieldType::VEC4:   memcpy(record.Value, value, sizeof(glm::vec4)); break;
+		case FieldType::PREFAB:
+		case FieldType::STRING: record.Value[0] = strings.Add(*static_cast<std::string*>(value)); break;
+		case FieldType::ENTITY: memcpy(record.Value, value, sizeof(uint64_t));  break;
+	}
+}
+
+void SceneSerializer::SerializeRuntime(const std::string& filepath) {
+	EN_PROFILE_SCOPE;
+
+	std::vector<Entity> entities;
+	auto view = m_Scene->m_Registry.view<Component::ID>();
+	for (auto handle : view) {
+		Entity entity = Entity(handle, m_Scene);
+		if (entity.HasParent()) {
+			continue;
+		}
+		CollectRuntimeEntities(entity, entities);
+	}
+
+	std::unordered_map<entt::entity, uint32_t> indexes;
+	indexes.reserve(entities.size());
+	for (uint32_t i = 0; i < entities.size(); i++) {
+		indexes.emplace(entities[i], i);
+	}
+
+	StringTable strings;
+	std::vector<uint64_t> uuids;
+	std::vector<uint32_t> names;
+	std::vector<uint32_t> parents;
+	uuids.reserve(entities.size());
+	names.reserve(entities.size());
+	parents.reserve(entities.size());
+
+	ComponentSection<TransformRecord>       transforms;
+	ComponentSection<SpriteRendererRecord>  sprites;
+	ComponentSection<CameraRecord>          cameras;
+	ComponentSection<NativeScriptRecord>    scripts;
+	ComponentSection<RigidBodyRecord>       rigid_bodies;
+	ComponentSection<CollisionBodyRecord>   collision_bodies;
+	ComponentSection<CollisionShapeRecord>  collision_shapes;
+	ComponentSection<PrefabRecord>          prefabs;
+	ComponentSection<AudioSourcesRecord>    audio_sources;
+	ComponentSection<AnimationPlayerRecord> animation_players;
+	ComponentSection<TextRecord>            texts;
+	ComponentSection<SceneControlRecord>    scene_controls;
+	std::vector<ScriptFieldRecord> script_fields;
+	std::vector<NamedHandleRecord> named_handles;
+	std::vector<glm::vec2> shape_points;
+
+	for (uint32_t i = 0; i < entities.size(); i++) {
+		Entity entity = entities[i];
+
+		uuids.push_back(entity.GetID());
+		names.push_back(strings.Add(entity.GetTag()));
+
+		uint32_t parent = NONE;
+		if (entity.HasParent()) {
+			auto it = indexes.find(entity.GetParent());
+			if (it != indexes.end()) {
+				parent = it->second;
+			}
+		}
+		parents.push_back(parent);
+
+		auto& transform = entity.Get<Component::Transform>();
+		transforms.Push(i, { transform.LocalPosition, transform.LocalRotation, transform.LocalScale });
+
+		// prefab roots only override the transform and the parent
+		if (entity.Has<Component::Prefab>()) {
+			prefabs.Push(i, { strings.Add(entity.Get<Component::Prefab>().PrefabPath.string()) });
+			continue;
+		}
+
+		if (entity.Has<Component::SpriteRenderer>()) {
+			auto& sprite = entity.Get<Component::SpriteRenderer>();
+			SpriteRendererRecord record = {};
+			record.Color = sprite.Color;
+			record.Handle = sprite.Handle;
+			record.TileScale = sprite.TileScale;
+			if (sprite.SubTexture) {
+				record.HasSubTexture = 1;
+				record.TileSize = sprite.SubTexture->TileSize;
+				record.TileIndex = sprite.SubTexture->TileIndex;
+				record.TileSeparation = sprite.SubTexture->TileSeparation;
+			}
+			sprites.Push(i, record);
+		}
+
+		if (entity.Has<Component::Camera>()) {
+			auto& cam = entity.Get<Component::Camera>();
+			CameraRecord record = {};
+			record.Size = cam.Cam.GetSize();
+			record.Near = cam.Cam.GetNear();
+			record.Far  = cam.Cam.GetFar();
+			record.Primary = cam.Primary;
+			record.FixedAspectRatio = cam.FixedAspectRatio;
+			cameras.Push(i, record);
+		}
+
+		if (entity.Has<Component::NativeScript>()) {
+			auto& script = entity.Get<Component::NativeScript>();
+			NativeScriptRecord record = {};
+			record.ScriptName = strings.Add(script.ScriptName);
+			record.FirstField = (uint32_t)script_fields.size();
+			if (script.FieldSchema) {
+				for (const ScriptFieldInfo& field : script.FieldSchema->Fields) {
+					ScriptFieldRecord field_record = {};
+					field_record.Name = strings.Add(field.Name);
+					field_record.Type = (uint32_t)field.Type;
+					WriteFieldValue(field_record, field.Type, script.GetFieldValue(field), strings);
+					script_fields.push_back(field_record);
+				}
+			}
+			record.FieldCount = (uint32_t)script_fields.size() - record.FirstField;
+			scripts.Push(i, record);
+		}
+
+		if (entity.Has<Component::RigidBody>()) {
+			auto& body = entity.Get<Component::RigidBody>();
+			rigid_bodies.Push(i, { body.Layer, body.GetGravityFactor(), body.GetMass() });
+		}
+
+		if (entity.Has<Component::CollisionBody>()) {
+			auto& body = entity.Get<Component::CollisionBody>();
+			CollisionBodyRecord record = {};
+			record.Layer = body.Layer;
+			record.IsStatic = body.IsStatic();
+			record.IsSensor = body.IsSensor;
+			collision_bodies.Push(i, record);
+		}
+
+		if (entity.Has<Component::CollisionShape>()) {
+			auto& cs = entity.Get<Component::CollisionShape>();
+			CollisionShapeRecord record = { (uint32_t)cs.Shape, cs.Float, cs.Vector };
+			record.FirstPoint = (uint32_t)shape_points.size();
+			record.PointCount = (uint32_t)cs.Points.size();
+			shape_points.insert(shape_points.end(), cs.Points.begin(), cs.Points.end());
+			collision_shapes.Push(i, record);
+		}
+
+		if (entity.Has<Component::AudioSources>()) {
+			auto& sources = entity.Get<Component::AudioSources>();
+			AudioSourcesRecord record = {};
+			record.FirstSound = (uint32_t)named_handles.size();
+			for (auto& [name, handle] : sources.Sounds) {
+				named_handles.push_back({ strings.Add(name), 0, handle });
+			}
+			record.SoundCount = (uint32_t)named_handles.size() - record.FirstSound;
+			audio_sources.Push(i, record);
+		}
+
+		if (entity.Has<Component::AnimationPlayer>()) {
+			auto& player = entity.Get<Component::AnimationPlayer>();
+			AnimationPlayerRecord record = {};
+			record.CurrentAnimation = player.CurrentAnimation;
+			record.FirstAnimation = (uint32_t)named_handles.size();
+			for (auto& [name, handle] : player.Animations) {
+				named_handles.push_back({ strings.Add(name), 0, handle });
+			}
+			record.AnimationCount = (uint32_t)named_handles.size() - record.FirstAnimation;
+			animation_players.Push(i, record);
+		}
+
+		if (entity.Has<Component::Text>()) {
+			auto& text = entity.Get<Component::Text>();
+			TextRecord record = {};
+			record.Color = text.Color;
+			record.Font = text.Font;
+			record.Scale = text.Scale;
+			record.Visible = text.Visible;
+			record.Data = strings.Add(text.Data);
+			texts.Push(i, record);
+		}
+
+		if (entity.Has<Component::SceneControl>()) {
+			scene_controls.Push(i, { entity.Get<Component::SceneControl>().Persistent });
+		}
+	}
+
+	SectionWriter writer;
+	if (not entities.empty()) {
+		writer.Sections.push_back({ SectionType::Entities, (uint32_t)entities.size(), 0 });
+		writer.AppendArray(uuids);
+		writer.AppendArray(names);
+		writer.AppendArray(parents);
+	}
+	writer.AddComponents(SectionType::Transform,       transforms);
+	writer.AddComponents(SectionType::SpriteRenderer,  sprites);
+	writer.AddComponents(SectionType::Camera,          cameras);
+	writer.AddComponents(SectionType::NativeScript,    scripts);
+	writer.AddComponents(SectionType::RigidBody,       rigid_bodies);
+	writer.AddComponents(SectionType::CollisionBody,   collision_bodies);
+	writer.AddComponents(SectionType::CollisionShape,  collision_shapes);
+	writer.AddComponents(SectionType::Prefab,          prefabs);
+	writer.AddComponents(SectionType::AudioSources,    audio_sources);
+	writer.AddComponents(SectionType::AnimationPlayer, animation_players);
+	writer.AddComponents(SectionType::Text,            texts);
+	writer.AddComponents(SectionType::SceneControl,    scene_controls);
+	writer.AddArray(SectionType::ScriptFields, script_fields);
+	writer.AddArray(SectionType::NamedHandles, named_handles);
+	writer.AddArray(SectionType::ShapePoints,  shape_points);
+
+	Header header = {};
+	memcpy(header.Magic, MAGIC, sizeof(MAGIC));
+	header.Version = VERSION;
+	header.SceneName = strings.Add(m_Scene->GetName());
+	header.EntityCount = (uint32_t)entities.size();
+	header.SectionCount = (uint32_t)writer.Sections.size();
+	header.StringCount = (uint32_t)strings.Strings.size();
+
+	// section offsets were relative to the start of the section data
+	const uint64_t base = AlignOffset(sizeof(Header) + writer.Sections.size() * sizeof(Section));
+	for (auto& section : writer.Sections) {
+		section.Offset += base;
+	}
+
+	writer.Align();
+	header.StringTableOffset = base + writer.Data.size();
+	uint32_t string_offset = 0;
+	for (auto& str : strings.Strings) {
+		writer.Append(&string_offset, sizeof(uint32_t));
+		string_offset += (uint32_t)str.size();
+	}
+	writer.Append(&string_offset, sizeof(uint32_t));
+	for (auto& str : strings.Strings) {
+		writer.Append(str.data(), str.size());
+	}
+
+	std::ofstream fout(filepath, std::ios::binary);
+	if (not fout) {
+		EN_CORE_ERROR("Failed to save .escnb file '{0}'", filepath);
+		return;
+	}
+	std::vector<uint8_t> padding(base - sizeof(Header) - writer.Sections.size() * sizeof(Section), 0);
+	fout.write((const char*)&header, sizeof(Header));
+	fout.write((const char*)writer.Sections.data(), writer.Sections.size() * sizeof(Section));
+	fout.write((const char*)padding.data(), padding.size());
+	fout.write((const char*)writer.Data.data(), writer.Data.size());
+}
+
+
+
+enum class LoadState : uint8_t {
+	New, PrefabRoot, Skipped
+};
+
+struct RuntimeLoadContext {
+	const uint8_t* Data = nullptr;
+	std::array<const Section*, (size_t)SectionType::Count> Sections = {};
+
+	const uint32_t* StringOffsets = nullptr;
+	const char* StringData = nullptr;
+	uint32_t StringCount = 0;
+
+	std::vector<entt::entity> Handles;
+	std::vector<LoadState> States;
+
+	std::string GetString(uint32_t index) const {
+		if (index >= StringCount) {
+			return std::string();
+		}
+		return std::string(StringData + StringOffsets[index], StringOffsets[index + 1] - StringOffsets[index]);
+	}
+
+	template <typename Record>
+	const Record* GetArray(SectionType type, uint32_t& count) const {
+		const Section* section = Sections[(size_t)type];
+		count = section ? section->Count : 0;
+		return section ? (const Record*)(Data + section->Offset) : nullptr;
+	}
+
+	// function is called for every record of an entity that was created by this load
+	template <typename Record, typename Function>
+	void Each(SectionType type, bool include_prefab_roots, Function function) const {
+		const Section* section = Sections[(size_t)type];
+		if (not section) {
+			return;
+		}
+		const uint32_t* entities = (const uint32_t*)(Data + section->Offset);
+		const Record* records = (const Record*)(Data + GetRecordsOffset(*section));
+		for (uint32_t i = 0; i < section->Count; i++) {
+			uint32_t index = entities[i];
+			if (index >= Handles.size()) {
+				continue;
+			}
+			LoadState state = States[index];
+			if (state == LoadState::New or (include_prefab_roots and state == LoadState::PrefabRoot)) {
+				function(Handles[index], records[i]);
+			}
+		}
+	}
+
+	template <typename Component, typename Record, typename Function>
+	void Insert(entt::registry& registry, SectionType type, Function make_component) const {
+		std::vector<entt::entity> targets;
+		std::vector<Component> components;
+		Each<Record>(type, false, [&](entt::entity entity, const Record& record) {
+			targets.push_back(entity);
+			components.push_back(make_component(record));
+		});
+		registry.insert<Component>(targets.begin(), targets.end(), components.begin());
+	}
+};
+
+static void ReadFieldValue(const RuntimeLoadContext& context, const ScriptFieldRecord& record, void* value) {
+	switch ((FieldType)record.Type) {
+		case FieldType::NONE:   break;
+		case FieldType::BOOL:   memcpy(value, record.Value, sizeof(bool));      break;
+		case FieldType::INT:    memcpy(value, record.Value, sizeof(int));       break;
+		case FieldType::FLOAT:  memcpy(value, record.Value, sizeof(float));     break;
+		case FieldType::DOUBLE: memcpy(value, record.Value, sizeof(double));    break;
+		case FieldType::VEC2:   memcpy(value, record.Value, sizeof(glm::vec2)); break;
+		case FieldType::VEC3:   memcpy(value, record.Value, sizeof(glm::vec3)); break;
+		case FieldType::VEC4:   memcpy(value, record.Value, sizeof(glm::vec4)); break;
+		case FieldType::PREFAB:
+		case FieldType::STRING: *static_cast<std::string*>(value) = context.GetString((uint32_t)record.Value[0]); break;
+		case FieldType::ENTITY: memcpy(value, record.Value, sizeof(uint64_t));  break;
+	}
+}
+
+static bool ValidateRuntimeScene(const MappedFile& file, RuntimeLoadContext& context) {
+	const uint64_t size = file.Size();
+	if (size < sizeof(Header)) {
+		return false;
+	}
+
+	const Header& header = *(const Header*)file.Data();
+	if (memcmp(header.Magic, MAGIC, sizeof(MAGIC)) != 0) {
+		return false;
+	}
+	if (header.Version != VERSION) {
+		EN_CORE_WARN("Runtime scene version is {}, expected {}", header.Version, VERSION);
+		return false;
+	}
+
+	const uint64_t sections_end = sizeof(Header) + (uint64_t)header.SectionCount * sizeof(Section);
+	if (sections_end > size) {
+		return false;
+	}
+
+	const Section* sections = (const Section*)(file.Data() + sizeof(Header));
+	for (uint32_t i = 0; i < header.SectionCount; i++) {
+		const Section& section = sections[i];
+		// NOTE: sections from a newer writer are skipped
+		if ((uint32_t)section.Type >= (uint32_t)SectionType::Count) {
+			continue;
+		}
+		if (section.Offset % 8 != 0 or section.Offset < sections_end or GetSectionEnd(section) > size) {
+			return false;
+		}
+		context.Sections[(size_t)section.Type] = &section;
+	}
+
+	const Section* entities = context.Sections[(size_t)SectionType::Entities];
+	if ((entities ? entities->Count : 0) != header.EntityCount) {
+		return false;
+	}
+
+	const uint64_t strings_begin = header.StringTableOffset + ((uint64_t)header.StringCount + 1) * sizeof(uint32_t);
+	if (header.StringTableOffset % 8 != 0 or strings_begin > size) {
+		return false;
+	}
+	context.StringOffsets = (const uint32_t*)(file.Data() + header.StringTableOffset);
+	context.StringData = (const char*)(file.Data() + strings_begin);
+	context.StringCount = header.StringCount;
+	for (uint32_t i = 0; i < header.StringCount; i++) {
+		if (context.StringOffsets[i] > context.StringOffsets[i + 1]) {
+			return false;
+		}
+	}
+	if (strings_begin + context.StringOffsets[header.StringCount] > size) {
+		return false;
+	}
+
+	context.Data = file.Data();
+	return true;
+}
+
+bool SceneSerializer::DeserializeRuntime(const std::string& filepath) {
+	EN_PROFILE_SCOPE;
+
+	MappedFile file = MappedFile(filepath);
+	RuntimeLoadContext context;
+	if (not file or not ValidateRuntimeScene(file, context)) {
+		EN_CORE_ERROR("Failed to load .escnb file '{0}'", filepath);
+		return false;
+	}
+
+	const Header& header = *(const Header*)file.Data();
+	entt::registry& registry = m_Scene->m_Registry;
+
+	m_Scene->SetName(context.GetString(header.SceneName));
+	m_Scene->InstantiateAutoLoads();
+
+	const uint32_t entity_count = header.EntityCount;
+	const uint64_t* uuids = nullptr;
+	const uint32_t* names = nullptr;
+	const uint32_t* parents = nullptr;
+	if (entity_count > 0) {
+		uuids   = (const uint64_t*)(context.Data + context.Sections[(size_t)SectionType::Entities]->Offset);
+		names   = (const uint32_t*)(uuids + entity_count);
+		parents = names + entity_count;
+	}
+
+	context.Handles.assign(entity_count, entt::null);
+	context.States.assign(entity_count, LoadState::New);
+
+	// persistent entities that survived the scene change keep their state
+	std::unordered_map<uint64_t, entt::entity> existing;
+	for (auto [entity, id] : registry.view<Component::ID>().each()) {
+		existing.emplace((uint64_t)id.uuid, entity);
+	}
+	for (uint32_t i = 0; i < entity_count and not existing.empty(); i++) {
+		auto it = existing.find(uuids[i]);
+		if (it != existing.end()) {
+			context.Handles[i] = it->second;
+			context.States[i] = LoadState::Skipped;
+		}
+	}
+
+	std::vector<std::pair<uint32_t, std::string>> prefab_roots;
+	{
+		const Section* section = context.Sections[(size_t)SectionType::Prefab];
+		const uint32_t count = section ? section->Count : 0;
+		const uint32_t* entities = section ? (const uint32_t*)(context.Data + section->Offset) : nullptr;
+		const PrefabRecord* records = section ? (const PrefabRecord*)(context.Data + GetRecordsOffset(*section)) : nullptr;
+		for (uint32_t i = 0; i < count; i++) {
+			if (entities[i] < entity_count and context.States[entities[i]] == LoadState::New) {
+				context.States[entities[i]] = LoadState::PrefabRoot;
+				prefab_roots.emplace_back(entities[i], context.GetString(records[i].Path));
+			}
+		}
+	}
+
+	// create every plain entity at once
+	{
+		std::vector<uint32_t> created_indexes;
+		created_indexes.reserve(entity_count);
+		for (uint32_t i = 0; i < entity_count; i++) {
+			if (context.States[i] == LoadState::New) {
+				created_indexes.push_back(i);
+			}
+		}
+
+		std::vector<entt::entity> created(created_indexes.size());
+		registry.create(created.begin(), created.end());
+
+		std::vector<Component::ID> ids;
+		std::vector<Component::Tag> tags;
+		ids.reserve(created.size());
+		tags.reserve(created.size());
+		for (size_t i = 0; i < created.size(); i++) {
+			uint32_t index = created_indexes[i];
+			context.Handles[index] = created[i];
+			ids.emplace_back(UUID(uuids[index]));
+
+			std::string name = context.GetString(names[index]);
+			tags.emplace_back(name.empty() ? "Empty Entity" : name);
+		}
+		registry.insert<Component::ID>(created.begin(), created.end(), ids.begin());
+		registry.insert<Component::Tag>(created.begin(), created.end(), tags.begin());
+		registry.insert<Component::Transform>(created.begin(), created.end());
+	}
+
+	for (auto& [index, path] : prefab_roots) {
+		Entity root;
+		if (path.empty()) {
+			EN_CORE_ERROR("DeserializeRuntime PrefabPath is empty! {}", uuids[index]);
+		} else {
+			root = m_Scene->InstantiatePrefab(path, uuids[index]);
+		}
+
+		if (root) {
+			context.Handles[index] = root;
+		} else {
+			context.States[index] = LoadState::Skipped;
+		}
+	}
+
+	context.Each<TransformRecord>(SectionType::Transform, true, [&](entt::entity entity, const TransformRecord& record) {
+		auto& transform = registry.get<Component::Transform>(entity);
+		transform.LocalPosition = record.Position;
+		transform.LocalRotation = record.Rotation;
+		transform.LocalScale    = record.Scale;
+	});
+
+	context.Insert<Component::SpriteRenderer, SpriteRendererRecord>(registry, SectionType::SpriteRenderer, [](const SpriteRendererRecord& record) {
+		Component::SpriteRenderer sprite;
+		sprite.Color = record.Color;
+		sprite.Handle = record.Handle;
+		sprite.TileScale = record.TileScale;
+		if (record.HasSubTexture) {
+			sprite.SubTexture = SubTexture2D::CreateFromTileIndex(
+				sprite.Handle, record.TileSize, record.TileIndex, record.TileSeparation);
+		}
+		return sprite;
+	});
+
+	context.Insert<Component::Camera, CameraRecord>(registry, SectionType::Camera, [](const CameraRecord& record) {
+		Component::Camera cam;
+		cam.Cam.SetSize(record.Size);
+		cam.Cam.SetNear(record.Near);
+		cam.Cam.SetFar (record.Far);
+		cam.Primary = record.Primary;
+		cam.FixedAspectRatio = record.FixedAspectRatio;
+		return cam;
+	});
+
+	{
+		uint32_t field_count = 0;
+		const ScriptFieldRecord* fields = context.GetArray<ScriptFieldRecord>(SectionType::ScriptFields, field_count);
+
+		context.Each<NativeScriptRecord>(SectionType::NativeScript, false, [&](entt::entity handle, const NativeScriptRecord& record) {
+			Entity entity = Entity(handle, m_Scene);
+			std::string script_name = context.GetString(record.ScriptName);
+
+			const ScriptClass* script_class = ScriptRegistry::Find(script_name);
+			if (script_class == nullptr) {
+				EN_ERROR("Couldn't find NativeScript '{0}' for entity '{1}'", script_name, entity.GetTag());
+				return;
+			}
+
+			auto& script = entity.Add<Component::NativeScript>();
+			script.Bind(*script_class);
+
+			if (not script.FieldSchema or (uint64_t)record.FirstField + record.FieldCount > field_count) {
+				return;
+			}
+			for (uint32_t i = record.FirstField; i < record.FirstField + record.FieldCount; i++) {
+				// field is removed or its type changed, keep the default
+				const ScriptFieldInfo* field = script.FieldSchema->Find(context.GetString(fields[i].Name));
+				if (field == nullptr or (uint32_t)field->Type != fields[i].Type) {
+					continue;
+				}
+				ReadFieldValue(context, fields[i], script.FieldValues.Get(*field));
+			}
+		});
+	}
+
+	context.Insert<Component::RigidBody, RigidBodyRecord>(registry, SectionType::RigidBody, [](const RigidBodyRecord& record) {
+		Component::RigidBody body;
+		body.Layer = record.Layer;
+		body.MotionType = JPH::EMotionType::Dynamic;
+		body.SetGravityFactor(record.GravityFactor);
+		body.SetMass(record.Mass);
+		return body;
+	});
+
+	context.Insert<Component::CollisionBody, CollisionBodyRecord>(registry, SectionType::CollisionBody, [](const CollisionBodyRecord& record) {
+		Component::CollisionBody body;
+		body.Layer = record.Layer;
+		body.MotionType = record.IsStatic ? JPH::EMotionType::Static : JPH::EMotionType::Kinematic;
+		body.IsSensor = record.IsSensor;
+		return body;
+	});
+
+	{
+		uint32_t point_count = 0;
+		const glm::vec2* points = context.GetArray<glm::vec2>(SectionType::ShapePoints, point_count);
+
+		context.Insert<Component::CollisionShape, CollisionShapeRecord>(registry, SectionType::CollisionShape, [&](const CollisionShapeRecord& record) {
+			Component::CollisionShape cs;
+			cs.Shape  = (Component::CollisionShape::Type)record.Shape;
+			cs.Float  = record.Float;
+			cs.Vector = record.Vector;
+			if ((uint64_t)record.FirstPoint + record.PointCount <= point_count) {
+				cs.Points.assign(points + record.FirstPoint, points + record.FirstPoint + record.PointCount);
+			}
+			return cs;
+		});
+	}
+
+	{
+		uint32_t handle_count = 0;
+		const NamedHandleRecord* handles = context.GetArray<NamedHandleRecord>(SectionType::NamedHandles, handle_count);
+		auto read_handles = [&](uint32_t first, uint32_t count, std::map<std::string, AssetHandle>& out) {
+			if ((uint64_t)first + count > handle_count) {
+				return;
+			}
+			for (uint32_t i = first; i < first + count; i++) {
+				out[context.GetString(handles[i].Name)] = handles[i].Handle;
+			}
+		};
+
+		context.Insert<Component::AudioSources, AudioSourcesRecord>(registry, SectionType::AudioSources, [&](const AudioSourcesRecord& record) {
+			Component::AudioSources sources;
+			read_handles(record.FirstSound, record.SoundCount, sources.Sounds);
+			return sources;
+		});
+
+		context.Insert<Component::AnimationPlayer, AnimationPlayerRecord>(registry, SectionType::AnimationPlayer, [&](const AnimationPlayerRecord& record) {
+			Component::AnimationPlayer anim;
+			anim.CurrentAnimation = record.CurrentAnimation;
+			read_handles(record.FirstAnimation, record.AnimationCount, anim.Animations);
+			return anim;
+		});
+	}
+
+	context.Insert<Component::Text, TextRecord>(registry, SectionType::Text, [&](const TextRecord& record) {
+		Component::Text text;
+		text.Data = context.GetString(record.Data);
+		text.Font = record.Font;
+		text.Color = record.Color;
+		text.Scale = record.Scale;
+		text.Visible = record.Visible;
+		return text;
+	});
+
+	context.Insert<Component::SceneControl, SceneControlRecord>(registry, SectionType::SceneControl, [](const SceneControlRecord& record) {
+		Component::SceneControl sc;
+		sc.Persistent = record.Persistent;
+		return sc;
+	});
+
+	// parents are stored before their children, so children keep their order
+	for (uint32_t i = 0; i < entity_count; i++) {
+		if (context.States[i] == LoadState::Skipped or parents[i] >= entity_count) {
+			continue;
+		}
+		entt::entity parent = context.Handles[parents[i]];
+		if (parent == entt::null) {
+			continue;
+		}
+		Entity(context.Handles[i], m_Scene).Reparent(Entity(parent, m_Scene));
+	}
+
+	return true;
+}
+
+std::string SceneSerializer::GetRuntimePath(const std::string& filepath) {
+	return std::filesystem::path(filepath).replace_extension(".escnb").string();
+}
+
+bool SceneSerializer::DeserializeAuto(const std::string& filepath, YAML::Node* preloaded) {
+	const std::string runtime_path = GetRuntimePath(filepath);
+
+	std::error_code error;
+	auto runtime_time = std::filesystem::last_write_time(runtime_path, error);
+	if (not error) {
+		// the yaml source is not required next to the cooked scene
+		auto source_time = std::filesystem::last_write_time(filepath, error);
+		if ((error or runtime_time >= source_time) and DeserializeRuntime(runtime_path)) {
+			return true;
+		}
+	}
+
+	if (preloaded and preloaded->IsMap()) {
+		return Deserialize(*preloaded);
+	}
+	return Deserialize(filepath);
+}
+
+}
@@ -6,4 +6,20 @@ namespace Enik {
 RaycastResult ScriptableEntity::CastRay(Raycast ray) {
 	return m_Entity.m_Scene->m_Physics.CastRay(ray);
 }
+
+void ScriptableEntity::RunQueries(PhysicsQueryBatch& batch) {
+	m_Entity.m_Scene->m_Physics.RunQueries(batch);
+}
+
+const CollisionContact& ScriptableEntity::GetCollisionContact() const {
+	return m_Entity.m_Scene->m_Physics.GetCurrentContact();
+}
+
+void ScriptableEntity::SubscribeToKey(KeyCode key) {
+	m_Entity.m_Scene->SubscribeToKey(m_Entity, this, key);
+}
+
+void ScriptableEntity::UnsubscribeFromKey(KeyCode key) {
+	m_Entity.m_Scene->UnsubscribeFromKey(m_Entity, key);
+}
 }
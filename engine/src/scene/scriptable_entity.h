@@ -2,6 +2,7 @@
 
 #include "scene/entity.h"
 #include "scene/native_script_fields.h"
+#include "physics/physics_query.h"
 #include "physics/raycast.h"
 
 namespace Enik {
@@ -38,6 +39,8 @@ public:
 	void DestroyEntity(Entity entity) { m_Entity.DestroyEntity(entity); }
 
 	Entity InstantiatePrefab(const std::filesystem::path& path) { return m_Entity.InstantiatePrefab(path); }
+	Entity SpawnFromPool(const std::filesystem::path& path) { return m_Entity.SpawnFromPool(path); }
+	void WarmPrefabPool(const std::filesystem::path& path, uint32_t count) { m_Entity.WarmPrefabPool(path, count); }
 
 	Entity FindEntityByUUID(UUID uuid) { return m_Entity.FindEntityByUUID(uuid); }
 	Entity FindEntityByName(const std::string& name) { return m_Entity.FindEntityByName(name); }
@@ -46,6 +49,11 @@ public:
 
 
 	void ChangeScene(const std::string& path) { m_Entity.ChangeScene(path); }
+	// loading screens: preload, show GetPreloadProgress, then ActivatePreloaded
+	void PreloadScene(const std::string& path) { m_Entity.PreloadScene(path); }
+	float GetPreloadProgress() const { return m_Entity.GetPreloadProgress(); }
+	bool IsPreloadReady() const { return m_Entity.IsPreloadReady(); }
+	void ActivatePreloaded() { m_Entity.ActivatePreloaded(); }
 
 	Entity m_Entity;
 
@@ -72,7 +80,20 @@ public:
 
 	virtual void OnSceneChanged(const std::filesystem::path& to) {}
 
+	// called when a released pooled instance is spawned again, and when it is released
+	virtual void OnPoolSpawn() {}
+	virtual void OnPoolRelease() {}
+
 	RaycastResult CastRay(Raycast ray);
+	// runs many rays, shape casts and overlaps at once, see PhysicsQueryBatch
+	void RunQueries(PhysicsQueryBatch& batch);
+
+	// only valid inside OnCollisionEnter and OnSensorEnter
+	const CollisionContact& GetCollisionContact() const;
+
+	// after subscribing, key events are only received for subscribed keys
+	void SubscribeToKey    (KeyCode key);
+	void UnsubscribeFromKey(KeyCode key);
 
 private:
 	friend class Scene;
@@ -0,0 +1,148 @@
+#include "system_scheduler.h"
+#include "core/application.h"
+#include "scene/scene.h"
+#include <chrono>
+
+namespace Enik {
+
+void SystemScheduler::Add(const SystemDescription& description) {
+	if (not description.Function) {
+		EN_CORE_ERROR("SystemScheduler: system '{}' has no function!", description.Name);
+		return;
+	}
+	m_PendingAdd.push_back(description);
+}
+
+void SystemScheduler::Remove(const std::string& name) {
+	m_PendingRemove.push_back(name);
+}
+
+bool SystemScheduler::Conflicts(const SystemDescription& a, const SystemDescription& b) {
+	if (a.Exclusive or b.Exclusive) {
+		return true;
+	}
+
+	auto contains = [](const std::vector<entt::id_type>& list, entt::id_type id) {
+		return std::find(list.begin(), list.end(), id) != list.end();
+	};
+
+	for (entt::id_type id : a.Writes) {
+		if (contains(b.Writes, id) or contains(b.Reads, id)) {
+			return true;
+		}
+	}
+	for (entt::id_type id : b.Writes) {
+		if (contains(a.Reads, id)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void SystemScheduler::ApplyPending(entt::registry& registry) {
+	for (const std::string& name : m_PendingRemove) {
+		m_Systems.erase(std::remove_if(m_Systems.begin(), m_Systems.end(), [&](const System& system) {
+			return system.Description.Name == name;
+		}), m_Systems.end());
+	}
+	m_PendingRemove.clear();
+
+	for (SystemDescription& description : m_PendingAdd) {
+		for (auto create_storage : description.Storages) {
+			create_storage(registry);
+		}
+		System system;
+		system.Description = std::move(description);
+		m_Systems.push_back(std::move(system));
+	}
+	m_PendingAdd.clear();
+
+	for (auto& stages : m_Stages) {
+		stages.clear();
+	}
+
+	// NOTE: only depends on registration order, so the schedule is deterministic
+	for (size_t i = 0; i < m_Systems.size(); i++) {
+		System& system = m_Systems[i];
+		system.Stage = 0;
+		for (size_t j = 0; j < i; j++) {
+			const System& earlier = m_Systems[j];
+			if (earlier.Description.Phase != system.Description.Phase) {
+				continue;
+			}
+			if (Conflicts(earlier.Description, system.Description)) {
+				system.Stage = std::max(system.Stage, earlier.Stage + 1);
+			}
+		}
+
+		auto& stages = m_Stages[(size_t)system.Description.Phase];
+		if (stages.size() <= system.Stage) {
+			stages.resize(system.Stage + 1);
+		}
+		stages[system.Stage].push_back(i);
+	}
+}
+
+void SystemScheduler::RunSystem(System& system, Scene& scene, Timestep ts) {
+	auto start = std::chrono::high_resolution_clock::now();
+
+	system.Description.Function(scene, ts);
+
+	auto end = std::chrono::high_resolution_clock::now();
+	system.LastMs = std::chrono::duration<float, std::milli>(end - start).count();
+	system.AverageMs = system.AverageMs * 0.95f + system.LastMs * 0.05f;
+}
+
+void SystemScheduler::Run(SystemPhase phase, Scene& scene, Timestep ts) {
+	EN_PROFILE_SCOPE;
+
+	if (not m_PendingAdd.empty() or not m_PendingRemove.empty()) {
+		ApplyPending(scene.Reg());
+	}
+
+	JobSystem& job_system = Application::Get().GetJobSystem();
+
+	for (const std::vector<size_t>& stage : m_Stages[(size_t)phase]) {
+		if (stage.size() == 1) {
+			RunSystem(m_Systems[stage[0]], scene, ts);
+			continue;
+		}
+
+		JobCounter counter;
+		for (size_t i = 1; i < stage.size(); i++) {
+			System* system = &m_Systems[stage[i]];
+			job_system.Submit([system, &scene, ts]() {
+				RunSystem(*system, scene, ts);
+			}, &counter);
+		}
+		RunSystem(m_Systems[stage[0]], scene, ts);
+		job_system.Wait(counter);
+	}
+}
+
+std::vector<SystemTiming> SystemScheduler::GetTimings() const {
+	std::vector<SystemTiming> timings;
+	timings.reserve(m_Systems.size());
+	for (const System& system : m_Systems) {
+		timings.push_back({
+			system.Description.Name,
+			system.Description.Phase,
+			system.Stage,
+			system.LastMs,
+			system.AverageMs
+		});
+	}
+	return timings;
+}
+
+const char* SystemScheduler::PhaseToString(SystemPhase phase) {
+	switch (phase) {
+		case SystemPhase::Update:      return "Update";
+		case SystemPhase::FixedUpdate: return "FixedUpdate";
+		case SystemPhase::PreRender:   return "PreRender";
+		case SystemPhase::Count:       break;
+	}
+	return "Unknown";
+}
+
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <base.h>
+#include <entt/entt.hpp>
+#include "core/timestep.h"
+
+namespace Enik {
+
+class Scene;
+
+enum class SystemPhase : uint8_t {
+	Update = 0,
+	FixedUpdate,
+	// runs even when the scene is paused, right before rendering
+	PreRender,
+	Count
+};
+
+struct SystemDescription {
+	std::string Name;
+	SystemPhase Phase = SystemPhase::Update;
+
+	// exclusive systems run alone on the main thread.
+	// anything that calls into scripts, creates or destroys entities,
+	// or touches the renderer has to be exclusive
+	bool Exclusive = false;
+
+	std::function<void(Scene&, Timestep)> Function;
+
+	template <typename... T>
+	SystemDescription& Read() {
+		(Reads.push_back(entt::type_hash<T>::value()), ...);
+		(Storages.push_back([](entt::registry& reg) { reg.storage<T>(); }), ...);
+		return *this;
+	}
+
+	template <typename... T>
+	SystemDescription& Write() {
+		(Writes.push_back(entt::type_hash<T>::value()), ...);
+		(Storages.push_back([](entt::registry& reg) { reg.storage<T>(); }), ...);
+		return *this;
+	}
+
+	std::vector<entt::id_type> Reads;
+	std::vector<entt::id_type> Writes;
+	// NOTE: pools are created up front, creating them inside a job would race
+	std::vector<void(*)(entt::registry&)> Storages;
+};
+
+struct SystemTiming {
+	std::string Name;
+	SystemPhase Phase;
+	uint32_t Stage;
+	float LastMs;
+	float AverageMs;
+};
+
+// systems of a phase are split into stages,
+// a system is placed one stage after the last earlier registered system it conflicts with.
+// systems in the same stage run in parallel, stages run in order.
+// so the result is always the same as running them serially in registration order.
+class SystemScheduler {
+public:
+	void Add(const SystemDescription& description);
+	void Remove(const std::string& name);
+
+	void Run(SystemPhase phase, Scene& scene, Timestep ts);
+
+	std::vector<SystemTiming> GetTimings() const;
+
+	static const char* PhaseToString(SystemPhase phase);
+
+private:
+	struct System {
+		SystemDescription Description;
+		uint32_t Stage = 0;
+		float LastMs = 0.0f;
+		float AverageMs = 0.0f;
+	};
+
+	void ApplyPending(entt::registry& registry);
+	static bool Conflicts(const SystemDescription& a, const SystemDescription& b);
+	static void RunSystem(System& system, Scene& scene, Timestep ts);
+
+private:
+	std::vector<System> m_Systems;
+	// indices into m_Systems, per phase per stage
+	std::array<std::vector<std::vector<size_t>>, (size_t)SystemPhase::Count> m_Stages;
+
+	// NOTE: systems can be added from inside a running system (scripts),
+	// so changes are applied at the start of the next run
+	std::vector<SystemDescription> m_PendingAdd;
+	std::vector<std::string> m_PendingRemove;
+};
+
+}
@@ -11,20 +11,21 @@ namespace Enik {
 
 
 struct tween {
-	tween(float* value, float start_value, float end_value, float duration, float creation_time, const std::function<void()>* call_on_end = nullptr)
+	tween(float* value, float start_value, float end_value, float duration, double creation_time, const std::function<void()>* call_on_end = nullptr)
 		: Value(value), StartValue(start_value), EndValue(end_value), Duration(duration), CreationTime(creation_time), CallOnEnd(call_on_end) {
 	}
 	float* Value;
 	float StartValue;
 	float EndValue;
 	float Duration;
-	float CreationTime;
+	double CreationTime;
 	const std::function<void()>* CallOnEnd;
 };
 
 
+// double, a float clock loses precision after a few hours
 struct TweenData {
-	float ElapsedTime = 0.0f;
+	double ElapsedTime = 0.0;
 	std::vector<tween> Tweens;
 };
 
@@ -73,11 +74,11 @@ inline float lerp(float a, float b, float t) {
 
 void Tween::StepAll(Timestep ts) {
 	if (s_Data.Tweens.empty()) {
-		s_Data.ElapsedTime = 0.0f;
+		s_Data.ElapsedTime = 0.0;
 		return;
 	}
 
-	s_Data.ElapsedTime += ts;
+	s_Data.ElapsedTime += (double)ts.GetSeconds();
 
 	auto it = s_Data.Tweens.begin();
 	while (it != s_Data.Tweens.end()) {
@@ -88,7 +89,7 @@ void Tween::StepAll(Timestep ts) {
 			continue;
 		}
 
-		float elapsed_time_since_creation = (s_Data.ElapsedTime - tw.CreationTime);
+		float elapsed_time_since_creation = (float)(s_Data.ElapsedTime - tw.CreationTime);
 
 		float t = std::min(elapsed_time_since_creation / tw.Duration, 1.0f);
 		*(tw.Value) = lerp(tw.StartValue, tw.EndValue, t);
@@ -108,7 +109,7 @@ void Tween::StepAll(Timestep ts) {
 
 void Tween::ResetData() {
 	s_Data.Tweens.clear();
-	s_Data.ElapsedTime = 0.0f;
+	s_Data.ElapsedTime = 0.0;
 }
 
 
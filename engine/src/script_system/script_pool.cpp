@@ -0,0 +1,65 @@
+#include "script_pool.h"
+
+#include <algorithm>
+#include <new>
+
+namespace Enik {
+
+// slabs are about this big, small classes get more slots
+static constexpr size_t SCRIPT_POOL_SLAB_BYTES = 16 * 1024;
+static constexpr uint32_t SCRIPT_POOL_MIN_SLOTS = 8;
+
+static size_t AlignUp(size_t value, size_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+ScriptPool::ScriptPool(size_t size, size_t alignment)
+	: m_Size(size), m_Alignment(std::max(alignment, alignof(void*))) {
+	m_ObjectOffset = AlignUp(sizeof(ScriptPool*), m_Alignment);
+	m_SlotSize = AlignUp(m_ObjectOffset + std::max(size, sizeof(void*)), m_Alignment);
+	m_SlotsPerSlab = (uint32_t)std::max<size_t>(SCRIPT_POOL_MIN_SLOTS, SCRIPT_POOL_SLAB_BYTES / m_SlotSize);
+}
+
+ScriptPool::~ScriptPool() {
+	if (m_LiveCount != 0) {
+		EN_CORE_ERROR("ScriptPool destroyed with {} live instances", m_LiveCount);
+	}
+	for (uint8_t* slab : m_Slabs) {
+		::operator delete(slab, std::align_val_t(m_Alignment));
+	}
+}
+
+void ScriptPool::AddSlab() {
+	uint8_t* slab = static_cast<uint8_t*>(::operator new(m_SlotSize * m_SlotsPerSlab, std::align_val_t(m_Alignment)));
+	m_Slabs.push_back(slab);
+
+	// pushed in reverse so slots are handed out in address order
+	for (uint32_t i = m_SlotsPerSlab; i > 0; --i) {
+		uint8_t* slot = slab + (size_t)(i - 1) * m_SlotSize;
+		*reinterpret_cast<ScriptPool**>(slot + m_ObjectOffset - sizeof(ScriptPool*)) = this;
+
+		void* object = slot + m_ObjectOffset;
+		*static_cast<void**>(object) = m_FreeList;
+		m_FreeList = object;
+	}
+}
+
+void* ScriptPool::Allocate() {
+	if (m_FreeList == nullptr) {
+		AddSlab();
+	}
+	void* object = m_FreeList;
+	m_FreeList = *static_cast<void**>(object);
+	m_LiveCount++;
+	return object;
+}
+
+ScriptPool* ScriptPool::Free(void* memory) {
+	ScriptPool* pool = *reinterpret_cast<ScriptPool**>(static_cast<uint8_t*>(memory) - sizeof(ScriptPool*));
+	*static_cast<void**>(memory) = pool->m_FreeList;
+	pool->m_FreeList = memory;
+	pool->m_LiveCount--;
+	return pool;
+}
+
+}
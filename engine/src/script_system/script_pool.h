@@ -0,0 +1,45 @@
+#pragma once
+#include <base.h>
+
+namespace Enik {
+
+// fixed size slots for one script class, allocated in slabs
+// every slot stores its pool right before the object, so Free does not need the class
+class ScriptPool {
+public:
+	ScriptPool(size_t size, size_t alignment);
+	~ScriptPool();
+
+	ScriptPool(const ScriptPool&) = delete;
+	ScriptPool& operator=(const ScriptPool&) = delete;
+
+	void* Allocate();
+	// returns the pool the memory belonged to
+	static ScriptPool* Free(void* memory);
+
+	bool Matches(size_t size, size_t alignment) const { return m_Size == size and m_Alignment == alignment; }
+
+	uint32_t GetLiveCount() const { return m_LiveCount; }
+	uint32_t GetCapacity()  const { return (uint32_t)m_Slabs.size() * m_SlotsPerSlab; }
+
+	// the class was registered again with a different layout, delete once empty
+	bool Retired = false;
+
+private:
+	void AddSlab();
+
+private:
+	size_t m_Size;
+	size_t m_Alignment;
+	// owner pointer + padding, the object starts here in the slot
+	size_t m_ObjectOffset;
+	size_t m_SlotSize;
+	uint32_t m_SlotsPerSlab;
+
+	std::vector<uint8_t*> m_Slabs;
+	// intrusive list through the object storage of free slots
+	void* m_FreeList = nullptr;
+	uint32_t m_LiveCount = 0;
+};
+
+}
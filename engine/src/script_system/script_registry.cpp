@@ -1,18 +1,185 @@
 #include "script_registry.h"
+#include "script_system/script_pool.h"
 
 namespace Enik {
 
-static std::unordered_map<std::string, ScriptableEntity* (*)()> s_ScriptRegistry;
+static std::vector<ScriptClass> s_Classes;
+// interned names, only used to turn a name into an id
+static std::unordered_map<std::string, ScriptClassID> s_ClassIDs;
+static std::vector<Scope<ScriptPool>> s_Pools;
+
+static void DeletePool(ScriptPool* pool) {
+	for (auto it = s_Pools.begin(); it != s_Pools.end(); ++it) {
+		if (it->get() == pool) {
+			s_Pools.erase(it);
+			return;
+		}
+	}
+}
+
+static ScriptClass& PrepareClass(const std::string& class_name, ScriptCallbackFlags callbacks) {
+	ScriptClass& script_class = s_Classes[ScriptRegistry::InternName(class_name)];
+	script_class.Create = nullptr;
+	script_class.Construct = nullptr;
+	script_class.Size = 0;
+	script_class.Alignment = 0;
+	script_class.Callbacks = callbacks;
+	script_class.Fields.reset();
+	return script_class;
+}
 
 void ScriptRegistry::RegisterScriptClass(const std::string& class_name, ScriptableEntity* (*create_function)()) {
-	s_ScriptRegistry[class_name] = create_function;
+	RegisterScriptClassWithCallbacks(class_name, create_function, SCRIPT_CALLBACKS_ALL);
 }
 
-std::unordered_map<std::string, ScriptableEntity* (*)()>& ScriptRegistry::GetRegistry() {
-	return s_ScriptRegistry;
+void ScriptRegistry::RegisterScriptClassWithCallbacks(const std::string& class_name, ScriptableEntity* (*create_function)(), ScriptCallbackFlags callbacks) {
+	PrepareClass(class_name, callbacks).Create = create_function;
+}
+
+void ScriptRegistry::RegisterPooledScriptClass(const std::string& class_name, ScriptableEntity* (*construct_function)(void* memory), size_t size, size_t alignment, ScriptCallbackFlags callbacks) {
+	ScriptClass& script_class = PrepareClass(class_name, callbacks);
+	script_class.Construct = construct_function;
+	script_class.Size = size;
+	script_class.Alignment = alignment;
+
+	// the layout changed after a reload, old instances still go back to the old pool
+	if (script_class.Pool and not script_class.Pool->Matches(size, alignment)) {
+		if (script_class.Pool->GetLiveCount() == 0) {
+			DeletePool(script_class.Pool);
+		}
+		else {
+			script_class.Pool->Retired = true;
+		}
+		script_class.Pool = nullptr;
+	}
+	if (script_class.Pool == nullptr) {
+		s_Pools.push_back(CreateScope<ScriptPool>(size, alignment));
+		script_class.Pool = s_Pools.back().get();
+	}
+}
+
+ScriptClassID ScriptRegistry::InternName(const std::string& class_name) {
+	auto it = s_ClassIDs.find(class_name);
+	if (it != s_ClassIDs.end()) {
+		return it->second;
+	}
+
+	ScriptClassID id = (ScriptClassID)s_Classes.size();
+	ScriptClass& script_class = s_Classes.emplace_back();
+	script_class.Name = class_name;
+	script_class.ID = id;
+	s_ClassIDs.emplace(class_name, id);
+	return id;
+}
+
+const ScriptClass* ScriptRegistry::Find(const std::string& class_name) {
+	auto it = s_ClassIDs.find(class_name);
+	if (it == s_ClassIDs.end()) {
+		return nullptr;
+	}
+	return Find(it->second);
+}
+
+const ScriptClass* ScriptRegistry::Find(ScriptClassID id) {
+	if (id >= s_Classes.size() or not s_Classes[id].IsRegistered()) {
+		return nullptr;
+	}
+	return &s_Classes[id];
+}
+
+const std::vector<ScriptClass>& ScriptRegistry::GetClasses() {
+	return s_Classes;
 }
 
 void ScriptRegistry::ClearRegistry() {
-	s_ScriptRegistry.clear();
+	// ids and pools are kept, instances of the unloaded module may still be alive
+	for (ScriptClass& script_class : s_Classes) {
+		script_class.Create = nullptr;
+		script_class.Construct = nullptr;
+		script_class.Fields.reset();
+	}
+}
+
+ScriptableEntity* ScriptRegistry::CreateInstance(ScriptClassID id, bool pooled) {
+	const ScriptClass* found = Find(id);
+	if (found == nullptr) {
+		return nullptr;
+	}
+	ScriptClass& script_class = s_Classes[id];
+
+	ScriptableEntity* instance = nullptr;
+	if (pooled and script_class.Construct) {
+		instance = script_class.Construct(script_class.Pool->Allocate());
+	}
+	else if (not pooled and script_class.Create) {
+		instance = script_class.Create();
+	}
+	else {
+		EN_CORE_ERROR("Script '{}' was registered again with a different allocation, rebind it", script_class.Name);
+		return nullptr;
+	}
+
+	script_class.LiveInstances++;
+	script_class.PeakInstances = std::max(script_class.PeakInstances, script_class.LiveInstances);
+	return instance;
+}
+
+void ScriptRegistry::DestroyInstance(ScriptClassID id, ScriptableEntity* instance, bool pooled) {
+	if (instance == nullptr) {
+		return;
+	}
+	if (id < s_Classes.size()) {
+		s_Classes[id].LiveInstances--;
+	}
+
+	if (not pooled) {
+		delete instance;
+		return;
+	}
+
+	// the most derived object is where the pool slot starts
+	void* memory = dynamic_cast<void*>(instance);
+	instance->~ScriptableEntity();
+
+	ScriptPool* pool = ScriptPool::Free(memory);
+	if (pool->Retired and pool->GetLiveCount() == 0) {
+		DeletePool(pool);
+	}
+}
+
+Ref<const ScriptFieldSchema> ScriptRegistry::GetFieldSchema(ScriptClassID id) {
+	const ScriptClass* found = Find(id);
+	if (found == nullptr) {
+		return nullptr;
+	}
+	ScriptClass& script_class = s_Classes[id];
+	if (script_class.Fields) {
+		return script_class.Fields;
+	}
+
+	const bool pooled = script_class.Construct != nullptr;
+	ScriptableEntity* temp_instance = CreateInstance(id, pooled);
+	if (temp_instance == nullptr) {
+		return nullptr;
+	}
+	script_class.Fields = ScriptFieldSchema::Create(temp_instance);
+	DestroyInstance(id, temp_instance, pooled);
+
+	return script_class.Fields;
+}
+
+std::vector<ScriptClassStats> ScriptRegistry::GetStats() {
+	std::vector<ScriptClassStats> stats;
+	stats.reserve(s_Classes.size());
+	for (const ScriptClass& script_class : s_Classes) {
+		ScriptClassStats& class_stats = stats.emplace_back();
+		class_stats.Name = script_class.Name;
+		class_stats.InstanceSize = script_class.Size;
+		class_stats.LiveInstances = script_class.LiveInstances;
+		class_stats.PeakInstances = script_class.PeakInstances;
+		class_stats.Capacity = script_class.Pool ? script_class.Pool->GetCapacity() : 0;
+	}
+	return stats;
+}
+
 }
-}
\ No newline at end of file
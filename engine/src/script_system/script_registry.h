@@ -3,10 +3,103 @@
 
 namespace Enik {
 
+class ScriptPool;
+
+struct ScriptClassStats {
+	std::string Name;
+	size_t InstanceSize = 0;
+	uint32_t LiveInstances = 0;
+	uint32_t PeakInstances = 0;
+	// pooled slots, 0 for classes that are not pooled
+	uint32_t Capacity = 0;
+};
+
+struct ScriptClass {
+	std::string Name;
+	ScriptClassID ID = INVALID_SCRIPT_CLASS;
+
+	ScriptableEntity* (*Create)() = nullptr;
+	// constructs in pool memory, set by RegisterScript<T>
+	ScriptableEntity* (*Construct)(void* memory) = nullptr;
+	size_t Size = 0;
+	size_t Alignment = 0;
+	ScriptCallbackFlags Callbacks = SCRIPT_CALLBACKS_ALL;
+
+	// built on first use from a temporary instance
+	Ref<const ScriptFieldSchema> Fields;
+
+	// outlives module reloads, instances from the old module are still freed into it
+	ScriptPool* Pool = nullptr;
+	uint32_t LiveInstances = 0;
+	uint32_t PeakInstances = 0;
+
+	bool IsRegistered() const { return Create != nullptr or Construct != nullptr; }
+};
+
 namespace ScriptRegistry {
+	// registers with every callback enabled
 	extern "C" void RegisterScriptClass(const std::string& class_name, ScriptableEntity* (*create_function)());
-	std::unordered_map<std::string, ScriptableEntity* (*)()>& GetRegistry();
+	extern "C" void RegisterScriptClassWithCallbacks(const std::string& class_name, ScriptableEntity* (*create_function)(), ScriptCallbackFlags callbacks);
+	// instances are placed in a per class pool instead of being allocated one by one
+	extern "C" void RegisterPooledScriptClass(const std::string& class_name, ScriptableEntity* (*construct_function)(void* memory), size_t size, size_t alignment, ScriptCallbackFlags callbacks);
+
+	// ids are stable for the whole run, also across script module reloads
+	ScriptClassID InternName(const std::string& class_name);
+	// null if the class is not registered
+	const ScriptClass* Find(const std::string& class_name);
+	const ScriptClass* Find(ScriptClassID id);
+	// indexed by id, includes classes that are no longer registered
+	const std::vector<ScriptClass>& GetClasses();
 	void ClearRegistry();
+
+	// pooled has to match the registration, it is captured when a script is bound
+	// so instances made before a module reload are freed the way they were allocated
+	ScriptableEntity* CreateInstance(ScriptClassID id, bool pooled);
+	void DestroyInstance(ScriptClassID id, ScriptableEntity* instance, bool pooled);
+
+	// null if the class is not registered
+	Ref<const ScriptFieldSchema> GetFieldSchema(ScriptClassID id);
+
+	std::vector<ScriptClassStats> GetStats();
+
+
+	// NOTE: callbacks are public in ScriptableEntity, so if &T::OnX can not be named
+	// (overridden as private or protected) substitution fails and it counts as overridden
+#define EN_SCRIPT_USES_BASE_CALLBACK(callback) \
+	template <typename T, typename = void> \
+	struct uses_base_##callback : std::false_type {}; \
+	template <typename T> \
+	struct uses_base_##callback<T, std::enable_if_t< \
+		std::is_same_v<decltype(&T::callback), decltype(&ScriptableEntity::callback)>>> : std::true_type {};
+
+	EN_SCRIPT_USES_BASE_CALLBACK(OnUpdate)
+	EN_SCRIPT_USES_BASE_CALLBACK(OnFixedUpdate)
+	EN_SCRIPT_USES_BASE_CALLBACK(OnKeyPressed)
+	EN_SCRIPT_USES_BASE_CALLBACK(OnKeyReleased)
+	EN_SCRIPT_USES_BASE_CALLBACK(OnMouseButtonPressed)
+	EN_SCRIPT_USES_BASE_CALLBACK(OnMouseButtonReleased)
+	EN_SCRIPT_USES_BASE_CALLBACK(OnMouseScrolled)
+#undef EN_SCRIPT_USES_BASE_CALLBACK
+
+	template <typename T>
+	constexpr ScriptCallbackFlags GetOverriddenCallbacks() {
+		ScriptCallbackFlags flags = 0;
+		if (not uses_base_OnUpdate<T>::value)              { flags |= ScriptCallbackFlag(ScriptCallback::Update);              }
+		if (not uses_base_OnFixedUpdate<T>::value)         { flags |= ScriptCallbackFlag(ScriptCallback::FixedUpdate);         }
+		if (not uses_base_OnKeyPressed<T>::value)          { flags |= ScriptCallbackFlag(ScriptCallback::KeyPressed);          }
+		if (not uses_base_OnKeyReleased<T>::value)         { flags |= ScriptCallbackFlag(ScriptCallback::KeyReleased);         }
+		if (not uses_base_OnMouseButtonPressed<T>::value)  { flags |= ScriptCallbackFlag(ScriptCallback::MouseButtonPressed);  }
+		if (not uses_base_OnMouseButtonReleased<T>::value) { flags |= ScriptCallbackFlag(ScriptCallback::MouseButtonReleased); }
+		if (not uses_base_OnMouseScrolled<T>::value)       { flags |= ScriptCallbackFlag(ScriptCallback::MouseScrolled);       }
+		return flags;
+	}
+
+	template <typename T>
+	void RegisterScript(const std::string& class_name) {
+		RegisterPooledScriptClass(class_name,
+			[](void* memory) -> ScriptableEntity* { return new (memory) T(); },
+			sizeof(T), alignof(T), GetOverriddenCallbacks<T>());
+	}
 }
 
-}
\ No newline at end of file
+}
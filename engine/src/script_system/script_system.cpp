@@ -2,6 +2,9 @@
 #include "core/application.h"
 #include "script_system/script_registry.h"
 #include "project/project.h"
+#include "scene/prefab_cache.h"
+
+#include <chrono>
 
 #if EN_STATIC_SCRIPT_MODULE
 extern "C" void RegisterAllScripts();
@@ -48,23 +51,59 @@ void ScriptSystem::LoadScriptModuleFirstTime() {
 }
 
 void ScriptSystem::ReloadScriptModule() {
-	if (s_Data.reload_pending) {
-		auto new_script_module_path = CopyScriptModule();
-		if (not new_script_module_path.empty()) {
-			UnloadScriptModule();
-			ScriptRegistry::ClearRegistry();
+	if (not s_Data.reload_pending) {
+		return;
+	}
 
-			LoadScriptModule(new_script_module_path);
+	auto new_script_module_path = CopyScriptModule();
+	if (new_script_module_path.empty()) {
+		s_Data.reload_pending = false;
+		return;
+	}
 
-			for (auto& function : s_Data.OnScriptModuleReloadEvents) {
-				function();
-			}
+	using Clock = std::chrono::steady_clock;
+	const auto start = Clock::now();
 
-			s_Data.reload_pending = false;
-		}
+	PrefabCache::Clear();
+	// instances are destroyed while their module is still loaded, field values are kept
+	for (Scene* scene : s_Data.scenes) {
+		scene->SuspendScripts();
 	}
+	const auto suspended = Clock::now();
+
+	UnloadScriptModule();
+	ScriptRegistry::ClearRegistry();
+	LoadScriptModule(new_script_module_path);
+	const auto loaded = Clock::now();
+
+	for (Scene* scene : s_Data.scenes) {
+		scene->ResumeScripts();
+	}
+
+	for (auto& function : s_Data.OnScriptModuleReloadEvents) {
+		function();
+	}
+
+	s_Data.reload_pending = false;
+
+	auto ms = [](Clock::duration duration) {
+		return std::chrono::duration<double, std::milli>(duration).count();
+	};
+	const auto end = Clock::now();
+	EN_CORE_INFO("Reloaded script module in {:.2f}ms (suspend {:.2f}ms, load {:.2f}ms, resume {:.2f}ms)",
+		ms(end - start), ms(suspended - start), ms(loaded - suspended), ms(end - loaded));
 }
 
+void ScriptSystem::RegisterScene(Scene* scene) {
+	s_Data.scenes.push_back(scene);
+}
+
+void ScriptSystem::UnregisterScene(Scene* scene) {
+	auto it = std::find(s_Data.scenes.begin(), s_Data.scenes.end(), scene);
+	if (it != s_Data.scenes.end()) {
+		s_Data.scenes.erase(it);
+	}
+}
 
 
 void ScriptSystem::LoadScriptModule(const std::filesystem::path& script_module_path) {
@@ -158,14 +197,25 @@ Physics& ScriptSystem::GetPhysicsContext() {
 	return GetSceneContext()->m_Physics;
 }
 
+// the linker writes the module in several chunks, reload once it stopped changing
+static constexpr auto RELOAD_DEBOUNCE = std::chrono::milliseconds(250);
+
+static void ReloadWhenModuleIsQuiet() {
+	using Clock = std::chrono::steady_clock;
+	const Clock::time_point last_event = Clock::time_point(Clock::duration(s_Data.last_module_event.load()));
+	if (Clock::now() - last_event < RELOAD_DEBOUNCE) {
+		Application::Get().SubmitToMainThread(ReloadWhenModuleIsQuiet);
+		return;
+	}
+	ScriptSystem::ReloadScriptModule();
+}
+
 void ScriptSystem::OnFileWatcherEvent(const std::string& path, const filewatch::Event change_type) {
 	switch (change_type) {
 		case filewatch::Event::modified:
-			if (not s_Data.reload_pending) {
-				s_Data.reload_pending = true;
-				Application::Get().SubmitToMainThread([](){
-					ReloadScriptModule();
-				});
+			s_Data.last_module_event = std::chrono::steady_clock::now().time_since_epoch().count();
+			if (not s_Data.reload_pending.exchange(true)) {
+				Application::Get().SubmitToMainThread(ReloadWhenModuleIsQuiet);
 			}
 			break;
 		case filewatch::Event::removed:
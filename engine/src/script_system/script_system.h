@@ -9,6 +9,7 @@
 #include "project/project.h"
 #include "filewatch/FileWatch.hpp"
 #include "scene/scene.h"
+#include <atomic>
 
 namespace Enik {
 
@@ -19,6 +20,10 @@ public:
 	static void ReloadScriptModule();
 	static void UnloadScriptModule();
 
+	// live scenes get their scripts suspended and resumed around a reload
+	static void RegisterScene(Scene* scene);
+	static void UnregisterScene(Scene* scene);
+
 	static void ClearOnScriptModuleReloadEvents();
 	static void CallOnScriptModuleReload(const std::function<void()>& function);
 
@@ -29,9 +34,12 @@ public:
 	struct ScriptSystemData {
 		Scope<filewatch::FileWatch<std::string>> file_watcher;
 		std::filesystem::path current_script_module_path;
-		bool reload_pending = false;
+		std::atomic<bool> reload_pending = false;
+		// steady clock ticks of the last change, the reload waits until it is quiet
+		std::atomic<int64_t> last_module_event = 0;
 
 		Scene* scene_context;
+		std::vector<Scene*> scenes;
 
 		std::vector<std::function<void ()>> OnScriptModuleReloadEvents;
 	};
@@ -7,8 +7,7 @@
 #include "src/digit.h"
 #include "src/number_display.h"
 
-#define REGISTER(name) Enik::ScriptRegistry::RegisterScriptClass(#name, \
-	[]() -> Enik::ScriptableEntity* { return new Enik::name(); });
+#define REGISTER(name) Enik::ScriptRegistry::RegisterScript<Enik::name>(#name);
 
 
 
@@ -11,7 +11,7 @@
 #include "src/gui.h"
 #include "src/dead_score.cpp"
 
-#define REGISTER(name) Enik::ScriptRegistry::RegisterScriptClass(#name, []() -> Enik::ScriptableEntity* { return new Enik::name(); });
+#define REGISTER(name) Enik::ScriptRegistry::RegisterScript<Enik::name>(#name);
 
 
 
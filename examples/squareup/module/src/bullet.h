@@ -12,6 +12,11 @@ public:
 
 	virtual void OnCollisionEnter(Entity& other) override final;
 
+	virtual void OnPoolSpawn() override final {
+		m_Timer = 0.0f;
+		m_pcounter = 0;
+	}
+
 	virtual std::vector<NativeScriptField> OnEditorGetFields() override final {
 		return std::vector<NativeScriptField>{
 			{ "Hit Damage", FieldType::FLOAT, &HitDamage },
@@ -8,6 +8,7 @@ float RandomFloat(float min, float max) {
 }
 
 void Enemy::OnCreate() {
+	m_SpawnHealth = m_Health;
 	FindWeaponScript();
 	m_PlayerUUID = GetGlobals()->Player;
 
@@ -34,6 +35,14 @@ void Enemy::OnCreate() {
 	}
 }
 
+void Enemy::OnPoolSpawn() {
+	m_Health = m_SpawnHealth;
+	m_CooldownTimer = 0.0f;
+	m_StateEnemy = CHASE;
+	m_IsGrounded = false;
+	m_JumpCount = 0;
+}
+
 void Enemy::OnUpdate(Timestep ts) {
 	if (Get<Component::Transform>().GlobalPosition.y < -25.0f) {
 		DestroyEntity(m_Entity);
@@ -10,6 +10,7 @@ protected:
 	virtual void OnCreate() override;
 	virtual void OnUpdate(Timestep ts) override;
 	virtual void OnFixedUpdate() override;
+	virtual void OnPoolSpawn() override;
 
 	virtual std::vector<NativeScriptField> OnEditorGetFields() override {
 		auto fields = Character::OnEditorGetFields();
@@ -39,6 +40,8 @@ public:
 	StateEnemy m_StateEnemy = CHASE;
 
 	uint8_t Type = 1;
+
+	float m_SpawnHealth = 100.0f;
 };
 
 }
\ No newline at end of file
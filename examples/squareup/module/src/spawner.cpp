@@ -15,6 +15,9 @@ public:
 			m_SpawnRect.z = trans.GlobalPosition.x + trans.GlobalScale.x * 0.5f;
 			m_SpawnRect.w = trans.GlobalPosition.y + trans.GlobalScale.y * 0.5f;
 		}
+		if (!m_EnemyPrefabPath.empty()) {
+			WarmPrefabPool(m_EnemyPrefabPath, 8);
+		}
 	}
 
 	virtual void OnUpdate(Timestep t) override {
@@ -31,7 +34,7 @@ public:
 	}
 
 	void SpawnEnemy() {
-		Entity enemy = InstantiatePrefab(m_EnemyPrefabPath);
+		Entity enemy = SpawnFromPool(m_EnemyPrefabPath);
 		if (!enemy) {
 			return;
 		}
@@ -16,7 +16,7 @@ Entity Weapon::InstantiateBullet() {
 		return entity;
 	}
 
-	Entity bullet = InstantiatePrefab(m_BulletPrefabPath);
+	Entity bullet = SpawnFromPool(m_BulletPrefabPath);
 	if (!bullet) {
 		return entity;
 	}
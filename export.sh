@@ -90,7 +90,8 @@ export_project() {
 	fi
 
 	print_job "Copying project assets for $platform"
-	cp -rf "$PROJECT_PATH/assets" "$export_dir/"
+	# keep timestamps, cooked .escnb scenes are only used when not older than their .escn
+	cp -rfp "$PROJECT_PATH/assets" "$export_dir/"
 	cp     "$PROJECT_PATH/project.enik" "$export_dir/"
 	cp -r  "$PROJECT_PATH/asset.registry" "$export_dir/"
 	cp -rf ./editor/assets/icons/. "$export_dir/assets/icons/"       # editor assets, optional
@@ -29,6 +29,7 @@ extern "C" void RegisterAllScripts();
 #include <memory>
 #include <algorithm>
 #include <functional>
+#include <type_traits>
 #include <stdio.h>
 
 #include <iostream>
@@ -455,6 +456,10 @@ public:
 
 	Entity InstantiatePrefab(const std::filesystem::path& path, UUID instance_uuid = UUID());
 
+	// pooled instances are deactivated instead of destroyed and reused by SpawnFromPool
+	void WarmPrefabPool(const std::filesystem::path& path, uint32_t count);
+	Entity SpawnFromPool(const std::filesystem::path& path);
+
 	void OnUpdateRuntime(Timestep ts);
 	void OnViewportResize(uint32_t width, uint32_t height);
 
@@ -469,6 +474,11 @@ public:
 	void CloseApplication();
 	void ChangeScene(const std::string& path);
 
+	void PreloadScene(const std::string& path);
+	float GetPreloadProgress() const;
+	bool IsPreloadReady() const;
+	void ActivatePreloaded();
+
 private:
 	Physics m_Physics;
 
@@ -557,6 +567,24 @@ namespace Enik {
 class ScriptableEntity;
 class Entity;
 
+enum class ScriptCallback : uint8_t {
+	Update = 0,
+	FixedUpdate,
+	KeyPressed,
+	KeyReleased,
+	MouseButtonPressed,
+	MouseButtonReleased,
+	MouseScrolled,
+	Count
+};
+
+using ScriptCallbackFlags = uint32_t;
+constexpr ScriptCallbackFlags SCRIPT_CALLBACKS_ALL = 0xFFFFFFFF;
+
+constexpr ScriptCallbackFlags ScriptCallbackFlag(ScriptCallback callback) {
+	return 1u << (uint32_t)callback;
+}
+
 namespace Component {
 
 struct ID {
@@ -645,7 +673,9 @@ struct NativeScript {
 
 	std::string ScriptName;
 
-	void Bind(const std::string& script_name, const std::function<ScriptableEntity*()>& inst);
+	ScriptCallbackFlags Callbacks = SCRIPT_CALLBACKS_ALL;
+
+	void Bind(const std::string& script_name, const std::function<ScriptableEntity*()>& inst, ScriptCallbackFlags callbacks = SCRIPT_CALLBACKS_ALL);
 };
 
 
@@ -730,11 +760,13 @@ struct CollisionBody : PhysicsBodyBase {
 };
 
 
+// child entities with a CollisionShape and no body of their own
+// are added to their parent's body as a compound shape
 struct CollisionShape {
 	void* shape = nullptr;
 
 	enum class Type {
-		NONE, BOX, CIRCLE
+		NONE, BOX, CIRCLE, POLYGON
 	};
 	Type Shape = Type::BOX;
 
@@ -748,6 +780,9 @@ struct CollisionShape {
 		float CircleRadius;
 	};
 
+	// convex polygon in local space, extruded along z
+	std::vector<glm::vec2> Points;
+
 	CollisionShape() = default;
 	CollisionShape(const CollisionShape&) = default;
 
@@ -755,17 +790,19 @@ struct CollisionShape {
 
 	static std::string TypeToString(Type shape) {
 		switch (shape) {
-			case Type::NONE:   return "NONE";
-			case Type::BOX:    return "Box";
-			case Type::CIRCLE: return "Circle";
+			case Type::NONE:    return "NONE";
+			case Type::BOX:     return "Box";
+			case Type::CIRCLE:  return "Circle";
+			case Type::POLYGON: return "Polygon";
 		}
 		return std::string();
 	}
 
 	static Type TypeFromString(const std::string& str) {
-		if      (str.empty())     { return Type::NONE; }
-		else if (str == "Box")    { return Type::BOX; }
-		else if (str == "Circle") { return Type::CIRCLE; }
+		if      (str.empty())      { return Type::NONE; }
+		else if (str == "Box")     { return Type::BOX; }
+		else if (str == "Circle")  { return Type::CIRCLE; }
+		else if (str == "Polygon") { return Type::POLYGON; }
 		return Type::NONE;
 	}
 };
@@ -830,6 +867,9 @@ struct AnimationPlayer {
 	bool Paused = false;
 
 	std::function<void(const std::string&)> OnEndCallback = nullptr;
+	// NOTE: Update can run on a worker thread, so it only records the ended animation
+	// and CallOnEndCallback calls the callback later on the main thread
+	std::string EndedAnimation = "";
 
 	void Start(const std::string& name);
 	// fast forwards to the end
@@ -838,6 +878,7 @@ struct AnimationPlayer {
 	void Kill();
 
 	void Update(const Timestep& dt);
+	void CallOnEndCallback();
 };
 
 
@@ -853,6 +894,14 @@ struct SceneControl {
 	bool Persistent = true;
 };
 
+// skipped by rendering, physics, animations and scripts
+struct Inactive {};
+
+// root of a pooled prefab instance, destroying it returns it to the pool
+struct Pooled {
+	std::string PoolKey;
+};
+
 }
 
 
@@ -983,6 +1032,14 @@ public:
 		return m_Scene->InstantiatePrefab(path);
 	}
 
+	Entity SpawnFromPool(const std::filesystem::path& path) {
+		return m_Scene->SpawnFromPool(path);
+	}
+
+	void WarmPrefabPool(const std::filesystem::path& path, uint32_t count) {
+		m_Scene->WarmPrefabPool(path, count);
+	}
+
 	void CloseApplication() {
 		m_Scene->CloseApplication();
 	}
@@ -991,6 +1048,11 @@ public:
 		m_Scene->ChangeScene(path);
 	}
 
+	void PreloadScene(const std::string& path) { m_Scene->PreloadScene(path); }
+	float GetPreloadProgress() const { return m_Scene->GetPreloadProgress(); }
+	bool IsPreloadReady() const { return m_Scene->IsPreloadReady(); }
+	void ActivatePreloaded() { m_Scene->ActivatePreloaded(); }
+
 	uint64_t m_Handle{};
 	Scene* m_Scene = nullptr;
 private:
@@ -1011,6 +1073,150 @@ struct RaycastResult {
 	glm::vec3 point;
 };
 
+// normal points from the other entity towards the one receiving the callback
+struct CollisionContact {
+	glm::vec3 point;
+	glm::vec3 normal;
+};
+
+enum class PhysicsQueryType : uint8_t {
+	RAY,
+	SHAPE_CAST,
+	OVERLAP,
+};
+
+enum class PhysicsQueryShape : uint8_t {
+	NONE,
+	CIRCLE,
+	BOX,
+};
+
+struct PhysicsQuery {
+	PhysicsQueryType  type  = PhysicsQueryType::RAY;
+	PhysicsQueryShape shape = PhysicsQueryShape::NONE;
+	// every hit sorted by fraction instead of only the closest, overlaps always return every hit
+	bool all_hits = false;
+	bool include_sensors = false;
+	// bit i set hits bodies on physics layer i
+	uint16_t layer_mask = 0xFFFF;
+
+	glm::vec3 origin = glm::vec3(0.0f);
+	// direction and length of rays and shape casts
+	glm::vec3 dir = glm::vec3(0.0f);
+	// circle radius in x, box half extent
+	glm::vec3 size = glm::vec3(0.0f);
+	glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+};
+
+struct PhysicsQueryHit {
+	Entity entity;
+	glm::vec3 point;
+	// points out of the surface that was hit
+	glm::vec3 normal;
+	// along dir, 0 for overlaps
+	float fraction;
+};
+
+// queries are collected during the frame and run together with ScriptableEntity::RunQueries,
+// spread over the job system against the world as it is between steps
+class PhysicsQueryBatch {
+public:
+	// every Add returns the index of the query, used to read its hits
+	uint32_t Add(const PhysicsQuery& query) {
+		m_Queries.push_back(query);
+		return (uint32_t)m_Queries.size() - 1;
+	}
+
+	uint32_t AddRay(const glm::vec3& origin, const glm::vec3& dir, uint16_t layer_mask = 0xFFFF, bool all_hits = false) {
+		PhysicsQuery query;
+		query.origin = origin;
+		query.dir = dir;
+		query.layer_mask = layer_mask;
+		query.all_hits = all_hits;
+		return Add(query);
+	}
+
+	uint32_t AddCircleCast(const glm::vec3& origin, float radius, const glm::vec3& dir, uint16_t layer_mask = 0xFFFF, bool all_hits = false) {
+		PhysicsQuery query;
+		query.type = PhysicsQueryType::SHAPE_CAST;
+		query.shape = PhysicsQueryShape::CIRCLE;
+		query.origin = origin;
+		query.dir = dir;
+		query.size = glm::vec3(radius);
+		query.layer_mask = layer_mask;
+		query.all_hits = all_hits;
+		return Add(query);
+	}
+
+	uint32_t AddBoxCast(const glm::vec3& origin, const glm::vec3& half_extent, const glm::quat& rotation, const glm::vec3& dir, uint16_t layer_mask = 0xFFFF, bool all_hits = false) {
+		PhysicsQuery query;
+		query.type = PhysicsQueryType::SHAPE_CAST;
+		query.shape = PhysicsQueryShape::BOX;
+		query.origin = origin;
+		query.dir = dir;
+		query.size = half_extent;
+		query.rotation = rotation;
+		query.layer_mask = layer_mask;
+		query.all_hits = all_hits;
+		return Add(query);
+	}
+
+	uint32_t AddCircleOverlap(const glm::vec3& center, float radius, uint16_t layer_mask = 0xFFFF, bool include_sensors = false) {
+		PhysicsQuery query;
+		query.type = PhysicsQueryType::OVERLAP;
+		query.shape = PhysicsQueryShape::CIRCLE;
+		query.origin = center;
+		query.size = glm::vec3(radius);
+		query.layer_mask = layer_mask;
+		query.include_sensors = include_sensors;
+		return Add(query);
+	}
+
+	uint32_t AddBoxOverlap(const glm::vec3& center, const glm::vec3& half_extent, const glm::quat& rotation, uint16_t layer_mask = 0xFFFF, bool include_sensors = false) {
+		PhysicsQuery query;
+		query.type = PhysicsQueryType::OVERLAP;
+		query.shape = PhysicsQueryShape::BOX;
+		query.origin = center;
+		query.size = half_extent;
+		query.rotation = rotation;
+		query.layer_mask = layer_mask;
+		query.include_sensors = include_sensors;
+		return Add(query);
+	}
+
+	uint32_t GetQueryCount() const { return (uint32_t)m_Queries.size(); }
+
+	// hits of one query, closest first
+	uint32_t GetHitCount(uint32_t query) const { return query < m_Ranges.size() ? m_Ranges[query].count : 0; }
+	const PhysicsQueryHit* GetHits(uint32_t query) const { return m_Hits.data() + m_Ranges[query].first; }
+	bool HasHit(uint32_t query) const { return GetHitCount(query) > 0; }
+	const PhysicsQueryHit& GetClosestHit(uint32_t query) const { return m_Hits[m_Ranges[query].first]; }
+
+	// hits of every query in query order
+	const std::vector<PhysicsQueryHit>& GetAllHits() const { return m_Hits; }
+
+	// keeps the memory for the next frame
+	void Clear() {
+		m_Queries.clear();
+		m_Ranges.clear();
+		m_Hits.clear();
+	}
+
+private:
+	struct HitRange {
+		uint32_t first = 0;
+		uint32_t count = 0;
+	};
+
+	std::vector<PhysicsQuery> m_Queries;
+	std::vector<HitRange> m_Ranges;
+	std::vector<PhysicsQueryHit> m_Hits;
+	// hits per query while the batch runs
+	std::vector<std::vector<PhysicsQueryHit>> m_Scratch;
+
+	friend class Physics;
+};
+
 
 
 }
@@ -1061,7 +1267,8 @@ namespace Enik {
 
 namespace ScriptRegistry {
 	extern "C" void RegisterScriptClass(const std::string& class_name, ScriptableEntity* (*create_function)());
-	std::unordered_map<std::string, ScriptableEntity* (*)()>& GetRegistry();
+	extern "C" void RegisterScriptClassWithCallbacks(const std::string& class_name, ScriptableEntity* (*create_function)(), ScriptCallbackFlags callbacks);
+	extern "C" void RegisterPooledScriptClass(const std::string& class_name, ScriptableEntity* (*construct_function)(void* memory), size_t size, size_t alignment, ScriptCallbackFlags callbacks);
 }
 
 }
@@ -1073,6 +1280,9 @@ namespace Enik {
 class Input {
 public:
 	static bool IsKeyPressed(int keycode);
+	static bool IsKeyJustPressed (int keycode);
+	static bool IsKeyJustReleased(int keycode);
+
 	static bool IsMouseButtonPressed(int button);
 	static std::pair<float, float> GetMousePosition();
 
@@ -1594,7 +1804,7 @@ public:
 		return std::vector<NativeScriptField>{};
 	}
 
-protected:
+public:
 	virtual void OnCreate() {}
 	virtual void OnDestroy() {}
 	virtual void OnUpdate(Timestep ts) {}
@@ -1611,6 +1821,12 @@ protected:
 	virtual void OnMouseButtonReleased(const MouseButtonReleasedEvent& event) { }
 	virtual void OnMouseScrolled(const MouseScrolledEvent& event) { }
 
+	virtual void OnSceneChanged(const std::filesystem::path& to) {}
+
+	// called when a released pooled instance is spawned again, and when it is released
+	virtual void OnPoolSpawn() {}
+	virtual void OnPoolRelease() {}
+
 
 protected:
 	const std::string& GetTag() { return m_Entity.GetTag(); }
@@ -1632,16 +1848,38 @@ protected:
 		return m_Entity.InstantiatePrefab(path);
 	}
 
+	Entity SpawnFromPool(const std::filesystem::path& path) {
+		return m_Entity.SpawnFromPool(path);
+	}
+
+	void WarmPrefabPool(const std::filesystem::path& path, uint32_t count) {
+		m_Entity.WarmPrefabPool(path, count);
+	}
+
 	void CloseApplication() {
 		m_Entity.CloseApplication();
 	}
 
 	void ChangeScene(const std::string& path) { m_Entity.ChangeScene(path); }
+	// loading screens: preload, show GetPreloadProgress, then ActivatePreloaded
+	void PreloadScene(const std::string& path) { m_Entity.PreloadScene(path); }
+	float GetPreloadProgress() const { return m_Entity.GetPreloadProgress(); }
+	bool IsPreloadReady() const { return m_Entity.IsPreloadReady(); }
+	void ActivatePreloaded() { m_Entity.ActivatePreloaded(); }
 
 
 protected:
 	RaycastResult CastRay(Raycast ray);
 // 		{ return m_Entity.m_Scene->m_Physics.CastRay(ray); }
+	// runs many rays, shape casts and overlaps at once, see PhysicsQueryBatch
+	void RunQueries(PhysicsQueryBatch& batch);
+
+	// only valid inside OnCollisionEnter and OnSensorEnter
+	const CollisionContact& GetCollisionContact() const;
+
+	// after subscribing, key events are only received for subscribed keys
+	void SubscribeToKey    (KeyCode key);
+	void UnsubscribeFromKey(KeyCode key);
 
 
 	Entity m_Entity;
@@ -1650,6 +1888,50 @@ protected:
 }
 
 
+namespace Enik {
+
+namespace ScriptRegistry {
+	// NOTE: an override that is not public can not be named here, it counts as overridden
+#define EN_SCRIPT_USES_BASE_CALLBACK(callback) \
+	template <typename T, typename = void> \
+	struct uses_base_##callback : std::false_type {}; \
+	template <typename T> \
+	struct uses_base_##callback<T, std::enable_if_t< \
+		std::is_same_v<decltype(&T::callback), decltype(&ScriptableEntity::callback)>>> : std::true_type {};
+
+	EN_SCRIPT_USES_BASE_CALLBACK(OnUpdate)
+	EN_SCRIPT_USES_BASE_CALLBACK(OnFixedUpdate)
+	EN_SCRIPT_USES_BASE_CALLBACK(OnKeyPressed)
+	EN_SCRIPT_USES_BASE_CALLBACK(OnKeyReleased)
+	EN_SCRIPT_USES_BASE_CALLBACK(OnMouseButtonPressed)
+	EN_SCRIPT_USES_BASE_CALLBACK(OnMouseButtonReleased)
+	EN_SCRIPT_USES_BASE_CALLBACK(OnMouseScrolled)
+#undef EN_SCRIPT_USES_BASE_CALLBACK
+
+	template <typename T>
+	constexpr ScriptCallbackFlags GetOverriddenCallbacks() {
+		ScriptCallbackFlags flags = 0;
+		if (not uses_base_OnUpdate<T>::value)              { flags |= ScriptCallbackFlag(ScriptCallback::Update);              }
+		if (not uses_base_OnFixedUpdate<T>::value)         { flags |= ScriptCallbackFlag(ScriptCallback::FixedUpdate);         }
+		if (not uses_base_OnKeyPressed<T>::value)          { flags |= ScriptCallbackFlag(ScriptCallback::KeyPressed);          }
+		if (not uses_base_OnKeyReleased<T>::value)         { flags |= ScriptCallbackFlag(ScriptCallback::KeyReleased);         }
+		if (not uses_base_OnMouseButtonPressed<T>::value)  { flags |= ScriptCallbackFlag(ScriptCallback::MouseButtonPressed);  }
+		if (not uses_base_OnMouseButtonReleased<T>::value) { flags |= ScriptCallbackFlag(ScriptCallback::MouseButtonReleased); }
+		if (not uses_base_OnMouseScrolled<T>::value)       { flags |= ScriptCallbackFlag(ScriptCallback::MouseScrolled);       }
+		return flags;
+	}
+
+	template <typename T>
+	void RegisterScript(const std::string& class_name) {
+		RegisterPooledScriptClass(class_name,
+			[](void* memory) -> ScriptableEntity* { return new (memory) T(); },
+			sizeof(T), alignof(T), GetOverriddenCallbacks<T>());
+	}
+}
+
+}
+
+
 namespace Enik {
 }
 
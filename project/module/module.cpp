@@ -2,8 +2,7 @@
 
 //#include "src/player.h"
 
-#define REGISTER(name) Enik::ScriptRegistry::RegisterScriptClass(#name, \
-	[]() -> Enik::ScriptableEntity* { return new Enik::name(); });
+#define REGISTER(name) Enik::ScriptRegistry::RegisterScript<Enik::name>(#name);
 
 
 
@@ -0,0 +1,110 @@
+#include "headless.h"
+#include "scene/scene_serializer.h"
+
+#include <cstdio>
+
+
+HeadlessLayer::HeadlessLayer(uint64_t max_steps, uint64_t report_steps)
+	: Layer("HeadlessLayer"), m_MaxSteps(max_steps), m_ReportSteps(report_steps) {
+}
+
+void HeadlessLayer::OnAttach() {
+	EN_PROFILE_SCOPE;
+
+	const std::filesystem::path project = "./project.enik";
+	if (std::filesystem::exists(project)) {
+		LoadProject(project);
+	} else if (std::filesystem::exists(PROJECT_PATH)) {
+		LoadProject(PROJECT_PATH);
+	} else {
+		EN_CORE_ERROR("Project not found! {}", project.string());
+	}
+
+	if (m_ActiveScene == nullptr) {
+		Application::Get().Close();
+		return;
+	}
+
+	m_StartTime = Clock::now();
+	m_NextReportStep = m_ReportSteps;
+}
+
+void HeadlessLayer::OnDetach() {
+	EN_PROFILE_SCOPE;
+
+	// the application is already being destroyed, the step count is our own
+	if (m_ActiveScene != nullptr) {
+		const uint64_t steps = m_Steps;
+		const double elapsed = std::chrono::duration<double>(Clock::now() - m_StartTime).count();
+		std::printf("Finished %llu steps in %.3fs, %.0f steps/s\n",
+			(unsigned long long)steps, elapsed, elapsed > 0.0 ? (double)steps / elapsed : 0.0);
+		if (m_ActiveScene->IsDeterministic()) {
+			std::printf("Final state hash %016llx\n", (unsigned long long)m_ActiveScene->GetStateHash());
+		}
+		std::fflush(stdout);
+	}
+
+	ScriptSystem::UnloadScriptModule();
+}
+
+void HeadlessLayer::OnUpdate(Timestep timestep) {
+	EN_PROFILE_SCOPE;
+
+	if (m_ActiveScene == nullptr) {
+		return;
+	}
+
+	m_ActiveScene->OnUpdateRuntime(timestep);
+
+	// a replay can run more than one step in a frame
+	const uint64_t step = Application::Get().GetStepCount();
+	m_Steps = step;
+
+	if (m_ReportSteps > 0 and step >= m_NextReportStep) {
+		Report(step);
+		m_NextReportStep = (step / m_ReportSteps + 1) * m_ReportSteps;
+	}
+
+	if (m_MaxSteps > 0 and step >= m_MaxSteps) {
+		Application::Get().Close();
+	}
+}
+
+void HeadlessLayer::OnFixedUpdate() {
+	if (m_ActiveScene == nullptr) {
+		return;
+	}
+	m_ActiveScene->OnFixedUpdate();
+}
+
+// logging is compiled out of release builds, reports always go to stdout
+void HeadlessLayer::Report(uint64_t step) {
+	const double steps_per_second = Application::Get().GetStepsPerSecond();
+	const double realtime = steps_per_second * PHYSICS_UPDATE_RATE;
+
+	if (m_ActiveScene->IsDeterministic()) {
+		std::printf("Step %llu | %.0f steps/s (%.1fx realtime) | state hash %016llx\n",
+			(unsigned long long)step, steps_per_second, realtime, (unsigned long long)m_ActiveScene->GetStateHash());
+	} else {
+		std::printf("Step %llu | %.0f steps/s (%.1fx realtime)\n",
+			(unsigned long long)step, steps_per_second, realtime);
+	}
+	std::fflush(stdout);
+}
+
+void HeadlessLayer::LoadProject(const std::filesystem::path& path) {
+	if (Project::Load(path)) {
+		auto start_scene_path = Project::GetAbsolutePath(Project::GetActive()->GetConfig().start_scene);
+		ScriptRegistry::ClearRegistry();
+		ScriptSystem::LoadScriptModuleFirstTime();
+		LoadScene(start_scene_path);
+	}
+}
+
+void HeadlessLayer::LoadScene(const std::filesystem::path& path) {
+	Ref<Scene> new_scene = CreateRef<Scene>();
+	SceneSerializer serializer = SceneSerializer(new_scene);
+	if (serializer.DeserializeAuto(path.string())) {
+		m_ActiveScene = new_scene;
+	}
+}
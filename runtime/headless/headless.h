@@ -0,0 +1,38 @@
+#pragma once
+#include <Enik.h>
+#include <chrono>
+
+
+using namespace Enik;
+
+// runs the project without a window, as fast as the simulation allows
+class HeadlessLayer : public Layer {
+public:
+	HeadlessLayer(uint64_t max_steps, uint64_t report_steps);
+	virtual ~HeadlessLayer() = default;
+
+	virtual void OnAttach() override final;
+	virtual void OnDetach() override final;
+
+	virtual void OnUpdate(Timestep timestep) override final;
+	virtual void OnFixedUpdate() override final;
+
+private:
+	void LoadProject(const std::filesystem::path &path);
+	void LoadScene  (const std::filesystem::path &path);
+
+	void Report(uint64_t step);
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	Ref<Scene> m_ActiveScene;
+
+	// 0 runs until the process is stopped
+	uint64_t m_MaxSteps = 0;
+	uint64_t m_ReportSteps = 0;
+	uint64_t m_NextReportStep = 0;
+	uint64_t m_Steps = 0;
+
+	Clock::time_point m_StartTime;
+};
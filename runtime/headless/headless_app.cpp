@@ -0,0 +1,52 @@
+#include <Enik.h>
+#include "core/entry_point.h"
+
+#include "headless.h"
+
+using namespace Enik;
+
+// one minute of simulated time between reports
+static constexpr uint64_t DEFAULT_REPORT_STEPS = 3600;
+
+class HeadlessApp : public Application {
+public:
+	HeadlessApp(uint64_t max_steps, uint64_t report_steps, const std::string& replay)
+		: Application(PROJECT_TITLE, true) {
+		EN_TRACE("Headless Runtime Created");
+		PushLayer(new HeadlessLayer(max_steps, report_steps));
+
+		// after the scene loaded, so the first replayed frame is its first frame
+		if (not replay.empty() and not StartInputReplay(replay)) {
+			Close();
+		}
+	}
+
+	~HeadlessApp(){
+		EN_TRACE("Headless Runtime Deleted");
+	}
+};
+
+
+// runtime_headless [--steps N] [--report N] [--replay file]
+Enik::Application* Enik::CreateApplication(){
+	const ApplicationCommandLineArgs& args = Application::GetCommandLineArgs();
+
+	uint64_t max_steps = 0;
+	uint64_t report_steps = DEFAULT_REPORT_STEPS;
+	std::string replay;
+	for (int i = 1; i + 1 < args.Count; i += 2) {
+		const std::string option = args[i];
+		const std::string value = args[i + 1];
+		if (option == "--steps") {
+			max_steps = std::strtoull(value.c_str(), nullptr, 10);
+		} else if (option == "--report") {
+			report_steps = std::strtoull(value.c_str(), nullptr, 10);
+		} else if (option == "--replay") {
+			replay = value;
+		} else {
+			EN_CORE_WARN("Unknown option {}", option);
+		}
+	}
+
+	return new HeadlessApp(max_steps, report_steps, replay);
+}
@@ -9,7 +9,7 @@
 namespace Enik {
 
 
-void DebugInfoPanel::ShowDebugInfoPanel(Timestep timestep) {
+void DebugInfoPanel::ShowDebugInfoPanel(Timestep timestep, Scene* scene) {
 	if (not m_ShowDebugInfoPanel) {
 		return;
 	}
@@ -94,11 +94,23 @@ void DebugInfoPanel::ShowDebugInfoPanel(Timestep timestep) {
 		ImGui::Text("	Time: %d minutes %d seconds", minutes, seconds);
 	}
 
+	if (m_ShowDebugInfoPanel > 6 and scene) {
+		ImGui::Spacing();
+		ImGui::Spacing();
+
+		ImGui::TextColored(color, "Systems");
+		for (const SystemTiming& timing : scene->GetSystemTimings()) {
+			ImGui::Text("	%-12s %u %-20s %.3fms (avg %.3fms)",
+				SystemScheduler::PhaseToString(timing.Phase), timing.Stage,
+				timing.Name.c_str(), timing.LastMs, timing.AverageMs);
+		}
+	}
+
 	ImGui::End();
 }
 
 // set this manually
-constexpr int DEBUG_INFO_PANEL_COUNT = 6;
+constexpr int DEBUG_INFO_PANEL_COUNT = 7;
 
 bool DebugInfoPanel::OnKeyReleased(KeyReleasedEvent& event) {
 	if (Input::IsKeyPressed(Key::LeftControl)) {
@@ -3,13 +3,14 @@
 #include <chrono>
 #include "core/timestep.h"
 #include "events/key_event.h"
+#include "scene/scene.h"
 
 
 namespace Enik {
 
 class DebugInfoPanel {
 public:
-	void ShowDebugInfoPanel(Timestep timestep);
+	void ShowDebugInfoPanel(Timestep timestep, Scene* scene);
 
 	bool OnKeyReleased(KeyReleasedEvent& event);
 
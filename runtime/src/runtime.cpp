@@ -134,7 +134,7 @@ void RuntimeLayer::OnImGuiRender() {
 
 
 #if RUNTIME_SHOW_DEBUG_INFO_PANEL
-	m_DebugInfoPanel.ShowDebugInfoPanel(m_Timestep);
+	m_DebugInfoPanel.ShowDebugInfoPanel(m_Timestep, m_ActiveScene.get());
 #endif
 
 	ImGui::PopStyleVar(3);
@@ -208,7 +208,7 @@ void RuntimeLayer::LoadProject(const std::filesystem::path& path) {
 void RuntimeLayer::LoadScene(const std::filesystem::path& path) {
 	Ref<Scene> new_scene = CreateRef<Scene>();
 	SceneSerializer serializer = SceneSerializer(new_scene);
-	if (serializer.Deserialize(path.string())) {
+	if (serializer.DeserializeAuto(path.string())) {
 		m_ActiveScene = new_scene;
 		m_ActiveScene->OnViewportResize(m_ViewportPosition, m_ViewportSize.x, m_ViewportSize.y);
 	}
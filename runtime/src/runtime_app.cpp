@@ -10,6 +10,19 @@ public:
 	RuntimeApp() : Application(PROJECT_TITLE) {
 		EN_TRACE("Runtime Created");
 		PushLayer(new RuntimeLayer());
+
+		// after the scene loaded, so the first recorded frame is its first frame
+		const ApplicationCommandLineArgs& args = GetCommandLineArgs();
+		for (int i = 1; i + 1 < args.Count; i += 2) {
+			const std::string option = args[i];
+			if (option == "--record") {
+				StartInputRecording(args[i + 1]);
+			} else if (option == "--replay") {
+				StartInputReplay(args[i + 1]);
+			} else {
+				EN_CORE_WARN("Unknown option {}", option);
+			}
+		}
 	}
 
 	~RuntimeApp(){
@@ -18,6 +31,7 @@ public:
 };
 
 
+// runtime [--record file] [--replay file]
 Enik::Application* Enik::CreateApplication(){
 	return new RuntimeApp();
 }